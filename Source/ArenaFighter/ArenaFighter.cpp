@@ -3,4 +3,9 @@
 #include "ArenaFighter.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_STAT(STAT_ActorsTicked);
+DEFINE_STAT(STAT_ActorsTickedWithWork);
+
+CSV_DEFINE_CATEGORY_MODULE(ARENAFIGHTER_API, ArenaFighter, true);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ArenaFighter, "ArenaFighter" );
@@ -3,4 +3,40 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "CPP_StressTimers.h"
 
+DECLARE_STATS_GROUP(TEXT("ArenaFighter"), STATGROUP_ArenaFighter, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actors Ticked"), STAT_ActorsTicked, STATGROUP_ArenaFighter, ARENAFIGHTER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Actors Ticked With Work"), STAT_ActorsTickedWithWork, STATGROUP_ArenaFighter, ARENAFIGHTER_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(ARENAFIGHTER_API, ArenaFighter);
+
+/**
+ * Measures the enclosing scope in 'stat ArenaFighter', Unreal Insights and the CSV profiler (category ArenaFighter).
+ * Requires a DECLARE_CYCLE_STAT named STAT_<Name>. Cycle counters already show up in Insights, so the CPU
+ * trace scope is only added when stats are compiled out.
+ */
+#if STATS
+#define CPP_PROFILE_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_##Name); \
+	CSV_SCOPED_TIMING_STAT(ArenaFighter, Name)
+#else
+#define CPP_PROFILE_SCOPE(Name) \
+	TRACE_CPUPROFILER_EVENT_SCOPE(ArenaFighter_##Name); \
+	CSV_SCOPED_TIMING_STAT(ArenaFighter, Name)
+#endif
+
+/**
+ * CPP_PROFILE_SCOPE that also adds the game thread time of the scope to an ECPP_StressBucket,
+ * for the per-system columns of UCPP_ArenaStressSubsystem.
+ */
+#if !UE_BUILD_SHIPPING
+#define CPP_PROFILE_SCOPE_BUCKET(Name, Bucket) \
+	FCPP_StressTimerScope PREPROCESSOR_JOIN(StressTimerScope, __LINE__)(ECPP_StressBucket::Bucket); \
+	CPP_PROFILE_SCOPE(Name)
+#else
+#define CPP_PROFILE_SCOPE_BUCKET(Name, Bucket) CPP_PROFILE_SCOPE(Name)
+#endif
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_AnimNotify_MeleeHit.h"
+
+#include "CPP_CharacterBase.h"
+
+FString UCPP_AnimNotify_MeleeHit::GetNotifyName_Implementation() const
+{
+	return TEXT("Melee Hit");
+}
+
+void UCPP_AnimNotify_MeleeHit::Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
+                                      const FAnimNotifyEventReference& EventReference)
+{
+	Super::Notify(MeshComp, Animation, EventReference);
+
+	ACPP_CharacterBase* Character = MeshComp ? Cast<ACPP_CharacterBase>(MeshComp->GetOwner()) : nullptr;
+	if (!Character) return;
+
+	Character->StartMeleeSwing();
+
+	if (bCallApplyAttackDamageEvent)
+		Character->OnApplyAttackDamage();
+}
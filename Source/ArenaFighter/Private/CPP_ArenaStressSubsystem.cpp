@@ -0,0 +1,299 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_ArenaStressSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_StressTimers.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_CYCLE_STAT(TEXT("ArenaStress Script"), STAT_ArenaStressScript, STATGROUP_ArenaFighter);
+
+namespace CPP_ArenaStress
+{
+	static const TCHAR* BucketColumns[] = { TEXT("Sensing"), TEXT("Selection"), TEXT("Damage"), TEXT("WeaponEquip"), TEXT("StateMachines"), TEXT("Script") };
+	static_assert(UE_ARRAY_COUNT(BucketColumns) == static_cast<int32>(ECPP_StressBucket::Num), "One column per stress bucket");
+}
+
+bool UCPP_ArenaStressSubsystem::StartRun(const TArray<int32>& InEnemyCounts)
+{
+	if (Phase != EPhase::Idle || InEnemyCounts.IsEmpty()) return false;
+
+	LoadedEnemyClass = EnemyClass.LoadSynchronous();
+	if (!LoadedEnemyClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Arena stress: no enemy class, set EnemyClass in DefaultGame.ini or pass -ArenaStressEnemy="));
+		return false;
+	}
+
+	EnemyCounts = InEnemyCounts;
+	StepIndex = 0;
+	bAllStepsPassed = true;
+
+	Csv = TEXT("Enemies,Frames,FrameMs");
+	for (const TCHAR* Column : CPP_ArenaStress::BucketColumns)
+		Csv += FString::Printf(TEXT(",%sMs"), Column);
+	Csv += TEXT(",Result,FailedColumns\n");
+
+	BeginStep();
+	return true;
+}
+
+void UCPP_ArenaStressSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString Counts;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("ArenaStress="), Counts, false)) return;
+
+	TArray<FString> CountStrings;
+	Counts.ParseIntoArray(CountStrings, TEXT(","));
+
+	TArray<int32> ParsedCounts;
+	for (const FString& CountString : CountStrings)
+		ParsedCounts.Add(FMath::Max(FCString::Atoi(*CountString), 0));
+
+	FString EnemyClassPath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ArenaStressEnemy="), EnemyClassPath))
+		EnemyClass = TSoftClassPtr<ACPP_EnemyCharacterBase>(FSoftObjectPath(EnemyClassPath));
+
+	if (!FParse::Value(FCommandLine::Get(), TEXT("ArenaStressCsv="), CsvPath))
+		CsvPath = FPaths::ProjectSavedDir() / TEXT("Stress")
+			/ FString::Printf(TEXT("ArenaStress-%s.csv"), *FDateTime::Now().ToString());
+
+	bExitWhenFinished = true;
+	if (!StartRun(ParsedCounts))
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+}
+
+void UCPP_ArenaStressSubsystem::Deinitialize()
+{
+#if !UE_BUILD_SHIPPING
+	if (Phase == EPhase::Measuring)
+		FCPP_StressTimers::SetEnabled(false);
+#endif
+
+	Phase = EPhase::Idle;
+	Enemies.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_ArenaStressSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Phase == EPhase::Idle) return;
+
+	ACPP_CharacterBase* Player = GetPlayer();
+	if (!Player) return;
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const int32 LiveEnemies = MaintainEnemyCount(Player);
+	{
+		CPP_PROFILE_SCOPE_BUCKET(ArenaStressScript, Script);
+		ScriptPlayer(Player, Now);
+	}
+
+	switch (Phase)
+	{
+	case EPhase::Spawning:
+		if (LiveEnemies >= EnemyCounts[StepIndex])
+		{
+			Phase = EPhase::Warmup;
+			PhaseEndTime = Now + WarmupSeconds;
+		}
+		break;
+	case EPhase::Warmup:
+		if (Now >= PhaseEndTime)
+		{
+			Phase = EPhase::Measuring;
+			PhaseEndTime = Now + MeasureSeconds;
+			MeasuredFrames = 0;
+			FrameSecondsSum = 0.0;
+			LastFrameSeconds = FPlatformTime::Seconds();
+#if !UE_BUILD_SHIPPING
+			FCPP_StressTimers::Reset();
+			FCPP_StressTimers::SetEnabled(true);
+#endif
+		}
+		break;
+	case EPhase::Measuring:
+		{
+			const double FrameSeconds = FPlatformTime::Seconds();
+			FrameSecondsSum += FrameSeconds - LastFrameSeconds;
+			LastFrameSeconds = FrameSeconds;
+			MeasuredFrames++;
+
+			if (Now >= PhaseEndTime)
+				FinishStep();
+			break;
+		}
+	default:
+		break;
+	}
+}
+
+TStatId UCPP_ArenaStressSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_ArenaStressSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_ArenaStressSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCPP_ArenaStressSubsystem::BeginStep()
+{
+	Phase = EPhase::Spawning;
+	SpawnStream.Initialize(StepIndex);
+	UE_LOG(LogTemp, Display, TEXT("Arena stress: step %d, %d enemies"), StepIndex, EnemyCounts[StepIndex]);
+}
+
+void UCPP_ArenaStressSubsystem::FinishStep()
+{
+#if !UE_BUILD_SHIPPING
+	FCPP_StressTimers::SetEnabled(false);
+#endif
+
+	const int32 EnemyCount = FMath::Max(EnemyCounts[StepIndex], 1);
+	const int32 Frames = FMath::Max(MeasuredFrames, 1);
+	const double FrameMs = FrameSecondsSum * 1000.0 / Frames;
+
+	const float BucketBudgets[] = { Budget.Sensing, Budget.Selection, Budget.Damage, Budget.WeaponEquip, Budget.StateMachines };
+
+	TArray<FString> FailedColumns;
+	FString Row = FString::Printf(TEXT("%d,%d,%.3f"), EnemyCounts[StepIndex], MeasuredFrames, FrameMs);
+	double ScriptMs = 0.0;
+	for (int32 Bucket = 0; Bucket < static_cast<int32>(ECPP_StressBucket::Num); ++Bucket)
+	{
+#if !UE_BUILD_SHIPPING
+		const double BucketMs = FCPP_StressTimers::GetSeconds(static_cast<ECPP_StressBucket>(Bucket)) * 1000.0 / Frames;
+#else
+		const double BucketMs = 0.0;
+#endif
+		Row += FString::Printf(TEXT(",%.3f"), BucketMs);
+
+		// The scripted fight is the run's own work, it only comes off the frame time
+		if (static_cast<ECPP_StressBucket>(Bucket) == ECPP_StressBucket::Script)
+			ScriptMs = BucketMs;
+		else if (BucketMs * 1000.0 / EnemyCount > BucketBudgets[Bucket])
+			FailedColumns.Add(CPP_ArenaStress::BucketColumns[Bucket]);
+	}
+
+	if (FrameMs - ScriptMs > Budget.FrameMilliseconds)
+		FailedColumns.Insert(TEXT("Frame"), 0);
+
+	const bool bPassed = FailedColumns.IsEmpty();
+	bAllStepsPassed &= bPassed;
+	Row += FString::Printf(TEXT(",%s,%s\n"), bPassed ? TEXT("Pass") : TEXT("Fail"), *FString::Join(FailedColumns, TEXT(" ")));
+	Csv += Row;
+
+	UE_LOG(LogTemp, Display, TEXT("Arena stress: %s"), *Row.TrimEnd());
+
+	if (++StepIndex < EnemyCounts.Num())
+		BeginStep();
+	else
+		FinishRun();
+}
+
+void UCPP_ArenaStressSubsystem::FinishRun()
+{
+	Phase = EPhase::Idle;
+
+	if (!CsvPath.IsEmpty())
+	{
+		FFileHelper::SaveStringToFile(Csv, *CsvPath);
+		UE_LOG(LogTemp, Display, TEXT("Arena stress results written to %s"), *CsvPath);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Arena stress: %s"), bAllStepsPassed ? TEXT("all steps passed") : TEXT("some steps failed"));
+	if (bExitWhenFinished)
+		FPlatformMisc::RequestExitWithStatus(false, bAllStepsPassed ? 0 : 1);
+}
+
+int32 UCPP_ArenaStressSubsystem::MaintainEnemyCount(const ACPP_CharacterBase* Player)
+{
+	// Dead enemies leave the count right away; the pool takes them back after their death sequence
+	Enemies.RemoveAll([](const TWeakObjectPtr<ACPP_EnemyCharacterBase>& Enemy)
+	{
+		return !Enemy.IsValid() || Enemy->IsDead() || Enemy->IsHidden();
+	});
+
+	const int32 EnemyCount = EnemyCounts[StepIndex];
+	UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+	if (!EnemyPool) return Enemies.Num();
+
+	while (Enemies.Num() > EnemyCount)
+		EnemyPool->ReleaseEnemy(Enemies.Pop().Get());
+
+	for (int32 Spawned = 0; Spawned < SpawnsPerFrame && Enemies.Num() < EnemyCount; ++Spawned)
+	{
+		const float Angle = SpawnStream.FRandRange(0.0f, UE_TWO_PI);
+		const float Distance = SpawnStream.FRandRange(0.3f, 1.0f) * SpawnRadius;
+		const FVector2D Offset = FVector2D(FMath::Cos(Angle), FMath::Sin(Angle)) * Distance;
+		const FVector Location = Player->GetActorLocation() + FVector(Offset, 0.0f);
+		const FRotator Rotation = (Player->GetActorLocation() - Location).Rotation();
+
+		if (ACPP_EnemyCharacterBase* Enemy = EnemyPool->SpawnEnemy(LoadedEnemyClass, FTransform(Rotation, Location)))
+			Enemies.Add(Enemy);
+	}
+
+	return Enemies.Num();
+}
+
+void UCPP_ArenaStressSubsystem::ScriptPlayer(ACPP_CharacterBase* Player, double Now)
+{
+	if (Player->IsDead()) return;
+
+	if (Now >= NextPlayerAttackTime)
+	{
+		NextPlayerAttackTime = Now + PlayerAttackInterval;
+
+		ACPP_EnemyCharacterBase* Nearest = nullptr;
+		double NearestDistanceSquared = TNumericLimits<double>::Max();
+		for (const TWeakObjectPtr<ACPP_EnemyCharacterBase>& Enemy : Enemies)
+		{
+			const double DistanceSquared = FVector::DistSquared(Player->GetActorLocation(), Enemy->GetActorLocation());
+			if (DistanceSquared < NearestDistanceSquared)
+			{
+				Nearest = Enemy.Get();
+				NearestDistanceSquared = DistanceSquared;
+			}
+		}
+
+		if (Nearest)
+		{
+			Player->SetActorRotation((Nearest->GetActorLocation() - Player->GetActorLocation()).Rotation());
+			Nearest->TakeAttack(Player, PlayerDamage);
+		}
+	}
+
+	if (Now >= NextWeaponChangeTime)
+	{
+		NextWeaponChangeTime = Now + WeaponChangeInterval;
+		Player->ChangeWeapon(1.0f);
+	}
+
+	// Enemies in reach renew their token requests every frame, like the attack task does, so the requests
+	// don't time out between two attacks. Keep the player alive so every step fights for its whole duration.
+	const bool bEnemiesAttack = Now >= NextEnemyAttackTime && Player->GetHealth() > Player->GetMaxHealth() * 0.25f;
+	if (bEnemiesAttack)
+		NextEnemyAttackTime = Now + EnemyAttackInterval;
+
+	for (const TWeakObjectPtr<ACPP_EnemyCharacterBase>& Enemy : Enemies)
+		if (FVector::DistSquared(Player->GetActorLocation(), Enemy->GetActorLocation()) <= FMath::Square(Enemy->AttackTargetRadius)
+			&& Enemy->RequestAttackToken(Player) && bEnemiesAttack)
+			Player->TakeAttack(Enemy.Get(), EnemyDamage);
+}
+
+ACPP_CharacterBase* UCPP_ArenaStressSubsystem::GetPlayer() const
+{
+	return Cast<ACPP_CharacterBase>(UGameplayStatics::GetPlayerPawn(GetWorld(), 0));
+}
@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_AttackTokenSubsystem.h"
+
+#include "Algo/Sort.h"
+#include "ArenaFighter.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_RoundsConfig.h"
+#include "CPP_Weapon.h"
+
+DECLARE_CYCLE_STAT(TEXT("Attack Token Ranking"), STAT_AttackTokenRanking, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attack Token Queue Length"), STAT_AttackTokenQueueLength, STATGROUP_ArenaFighter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Attack Token Turnovers"), STAT_AttackTokenTurnovers, STATGROUP_ArenaFighter);
+
+void UCPP_AttackTokenSubsystem::ApplyRoundConfig(const FCPP_RoundsConfig& Config)
+{
+	AttackSlots = FMath::Max(Config.AttackSlots, 1);
+	CirclingUpdateInterval = FMath::Max(Config.CirclingUpdateInterval, 0.0f);
+}
+
+bool UCPP_AttackTokenSubsystem::RequestToken(ACPP_EnemyCharacterBase* Enemy, AActor* Target)
+{
+	if (!Enemy || !Target) return false;
+
+	FTargetTokens* Tokens = Targets.FindByPredicate([Target](const FTargetTokens& Candidate)
+	{
+		return Candidate.Target == Target;
+	});
+	if (!Tokens)
+	{
+		Tokens = &Targets.AddDefaulted_GetRef();
+		Tokens->Target = Target;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	FRequest* Request = Tokens->Requests.FindByPredicate([Enemy](const FRequest& Candidate)
+	{
+		return Candidate.Enemy == Enemy;
+	});
+	if (!Request)
+	{
+		Request = &Tokens->Requests.AddDefaulted_GetRef();
+		Request->Enemy = Enemy;
+
+		if (Tokens->NumHolders < AttackSlots)
+		{
+			Request->bHasToken = true;
+			Request->TokenTime = Now;
+			Tokens->NumHolders++;
+			TokenTurnovers++;
+			INC_DWORD_STAT(STAT_AttackTokenTurnovers);
+		}
+	}
+
+	Request->LastRequestTime = Now;
+	return Request->bHasToken;
+}
+
+void UCPP_AttackTokenSubsystem::ReleaseTokens(const ACPP_EnemyCharacterBase* Enemy)
+{
+	for (FTargetTokens& Tokens : Targets)
+	{
+		const int32 Index = Tokens.Requests.IndexOfByPredicate([Enemy](const FRequest& Request)
+		{
+			return Request.Enemy == Enemy;
+		});
+		if (Index == INDEX_NONE) continue;
+
+		if (Tokens.Requests[Index].bHasToken)
+			Tokens.NumHolders--;
+		Tokens.Requests.RemoveAtSwap(Index);
+	}
+}
+
+void UCPP_AttackTokenSubsystem::Deinitialize()
+{
+	Targets.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_AttackTokenSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now < NextRankTime) return;
+	NextRankTime = Now + RankInterval;
+
+	CPP_PROFILE_SCOPE(AttackTokenRanking);
+
+	Targets.RemoveAll([](const FTargetTokens& Tokens) { return !Tokens.Target.IsValid(); });
+
+	int32 Turnovers = 0;
+	QueueLength = 0;
+	for (FTargetTokens& Tokens : Targets)
+	{
+		Turnovers += RankRequests(Tokens, Now);
+		QueueLength += Tokens.Requests.Num() - Tokens.NumHolders;
+	}
+
+	Targets.RemoveAll([](const FTargetTokens& Tokens) { return Tokens.Requests.IsEmpty(); });
+
+	TokenTurnovers += Turnovers;
+	INC_DWORD_STAT_BY(STAT_AttackTokenTurnovers, Turnovers);
+	SET_DWORD_STAT(STAT_AttackTokenQueueLength, QueueLength);
+	CSV_CUSTOM_STAT(ArenaFighter, AttackTokenQueueLength, QueueLength, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(ArenaFighter, AttackTokenTurnovers, Turnovers, ECsvCustomStatOp::Accumulate);
+}
+
+TStatId UCPP_AttackTokenSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_AttackTokenSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_AttackTokenSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UCPP_AttackTokenSubsystem::RankRequests(FTargetTokens& Tokens, double Now)
+{
+	const FVector TargetLocation = Tokens.Target->GetActorLocation();
+
+	Tokens.Requests.RemoveAll([this, Now](const FRequest& Request)
+	{
+		return !Request.Enemy.IsValid() || Request.Enemy->IsDead() || Now - Request.LastRequestTime > RequestTimeout;
+	});
+
+	for (FRequest& Request : Tokens.Requests)
+	{
+		const ACPP_Weapon* Weapon = Request.Enemy->GetEquippedWeapon();
+		const float Threat = Weapon ? Weapon->GetDamage() * Weapon->GetAttackSpeed() : 0.0f;
+		Request.Score = FVector::Dist(Request.Enemy->GetActorLocation(), TargetLocation) - ThreatDistance * Threat;
+	}
+
+	Algo::SortBy(Tokens.Requests, &FRequest::Score);
+
+	// Recent holders keep their token; the other slots go to the best ranked requests
+	int32 FreeSlots = AttackSlots;
+	for (const FRequest& Request : Tokens.Requests)
+		if (Request.bHasToken && Now - Request.TokenTime < MinTokenHoldSeconds)
+			FreeSlots--;
+
+	int32 Turnovers = 0;
+	Tokens.NumHolders = 0;
+	for (FRequest& Request : Tokens.Requests)
+	{
+		if (!Request.bHasToken || Now - Request.TokenTime >= MinTokenHoldSeconds)
+		{
+			const bool bWasHolding = Request.bHasToken;
+			Request.bHasToken = FreeSlots > 0;
+			if (Request.bHasToken)
+			{
+				FreeSlots--;
+				if (!bWasHolding)
+				{
+					Request.TokenTime = Now;
+					Turnovers++;
+				}
+			}
+		}
+
+		if (Request.bHasToken)
+			Tokens.NumHolders++;
+	}
+
+	return Turnovers;
+}
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTService_EnemyDecisions.h"
+
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "CPP_EnemyDecisionSubsystem.h"
+
+UCPP_BTService_EnemyDecisions::UCPP_BTService_EnemyDecisions()
+{
+	NodeName = TEXT("Enemy Decisions");
+	bNotifyTick = false;
+	bNotifyBecomeRelevant = true;
+	bNotifyCeaseRelevant = true;
+
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UCPP_BTService_EnemyDecisions, TargetKey), AActor::StaticClass());
+	ShouldChaseKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UCPP_BTService_EnemyDecisions, ShouldChaseKey));
+	ShouldChaseKey.AllowNoneAsValue(true);
+}
+
+void UCPP_BTService_EnemyDecisions::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+	{
+		TargetKey.ResolveSelectedKey(*BlackboardAsset);
+		ShouldChaseKey.ResolveSelectedKey(*BlackboardAsset);
+	}
+}
+
+FString UCPP_BTService_EnemyDecisions::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("Target: %s\nShould Chase: %s"), *TargetKey.SelectedKeyName.ToString(),
+	                       *ShouldChaseKey.SelectedKeyName.ToString());
+}
+
+void UCPP_BTService_EnemyDecisions::OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	Super::OnBecomeRelevant(OwnerComp, NodeMemory);
+
+	if (UCPP_EnemyDecisionSubsystem* Decisions = OwnerComp.GetWorld()->GetSubsystem<UCPP_EnemyDecisionSubsystem>())
+		Decisions->Register(OwnerComp, TargetKey.GetSelectedKeyID(), ShouldChaseKey.GetSelectedKeyID());
+}
+
+void UCPP_BTService_EnemyDecisions::OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (UCPP_EnemyDecisionSubsystem* Decisions = OwnerComp.GetWorld()->GetSubsystem<UCPP_EnemyDecisionSubsystem>())
+		Decisions->Unregister(OwnerComp);
+
+	Super::OnCeaseRelevant(OwnerComp, NodeMemory);
+}
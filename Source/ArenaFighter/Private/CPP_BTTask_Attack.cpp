@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_Attack.h"
+
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimMontage.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_Weapon.h"
+
+UCPP_BTTask_Attack::UCPP_BTTask_Attack()
+{
+	NodeName = TEXT("Attack");
+	bNotifyTick = true;
+}
+
+EBTNodeResult::Type UCPP_BTTask_Attack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	UAnimInstance* AnimInstance = GetAnimInstance(OwnerComp);
+	if (!Enemy || !AnimInstance || !AttackMontage || Enemy->IsHidden()) return EBTNodeResult::Failed;
+
+	// Lost the attack token since preparing, e.g. to a closer enemy
+	AActor* Target = GetTarget(OwnerComp, Enemy);
+	if (Target && !Enemy->RequestAttackToken(Target)) return EBTNodeResult::Failed;
+
+	const ACPP_Weapon* Weapon = Enemy->GetEquippedWeapon();
+	const float PlayRate = Weapon && Weapon->GetAttackSpeed() > 0.0f ? Weapon->GetAttackSpeed() : 1.0f;
+
+	return AnimInstance->Montage_Play(AttackMontage, PlayRate) > 0.0f ? EBTNodeResult::InProgress : EBTNodeResult::Failed;
+}
+
+EBTNodeResult::Type UCPP_BTTask_Attack::AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	if (UAnimInstance* AnimInstance = GetAnimInstance(OwnerComp))
+		AnimInstance->Montage_Stop(0.2f, AttackMontage);
+
+	return EBTNodeResult::Aborted;
+}
+
+void UCPP_BTTask_Attack::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	const UAnimInstance* AnimInstance = GetAnimInstance(OwnerComp);
+	if (!AnimInstance || !AnimInstance->Montage_IsPlaying(AttackMontage))
+	{
+		FinishLatentTask(OwnerComp, EBTNodeResult::Succeeded);
+		return;
+	}
+
+	// Swings outlast RequestTimeout, renew the request so the token is not handed on mid-swing
+	ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	if (AActor* Target = GetTarget(OwnerComp, Enemy))
+		Enemy->RequestAttackToken(Target);
+}
+
+UAnimInstance* UCPP_BTTask_Attack::GetAnimInstance(const UBehaviorTreeComponent& OwnerComp) const
+{
+	const ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	const USkeletalMeshComponent* Mesh = Enemy ? Enemy->GetMesh() : nullptr;
+	return Mesh ? Mesh->GetAnimInstance() : nullptr;
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_ClearFocus.h"
+
+#include "AIController.h"
+
+UCPP_BTTask_ClearFocus::UCPP_BTTask_ClearFocus()
+{
+	NodeName = TEXT("Clear Focus");
+}
+
+EBTNodeResult::Type UCPP_BTTask_ClearFocus::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	if (!Controller) return EBTNodeResult::Failed;
+
+	Controller->ClearFocus(EAIFocusPriority::Gameplay);
+	return EBTNodeResult::Succeeded;
+}
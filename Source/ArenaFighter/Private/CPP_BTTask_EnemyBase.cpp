@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_EnemyBase.h"
+
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "CPP_EnemyCharacterBase.h"
+
+UCPP_BTTask_EnemyBase::UCPP_BTTask_EnemyBase()
+{
+	TargetKey.AddObjectFilter(this, GET_MEMBER_NAME_CHECKED(UCPP_BTTask_EnemyBase, TargetKey), AActor::StaticClass());
+	TargetKey.AllowNoneAsValue(true);
+}
+
+void UCPP_BTTask_EnemyBase::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+		TargetKey.ResolveSelectedKey(*BlackboardAsset);
+}
+
+FString UCPP_BTTask_EnemyBase::GetStaticDescription() const
+{
+	return FString::Printf(TEXT("%s: %s"), *Super::GetStaticDescription(),
+	                       TargetKey.IsSet() ? *TargetKey.SelectedKeyName.ToString() : TEXT("Selected Pawn"));
+}
+
+ACPP_EnemyCharacterBase* UCPP_BTTask_EnemyBase::GetEnemy(const UBehaviorTreeComponent& OwnerComp)
+{
+	const AAIController* Controller = OwnerComp.GetAIOwner();
+	return Controller ? Cast<ACPP_EnemyCharacterBase>(Controller->GetPawn()) : nullptr;
+}
+
+AActor* UCPP_BTTask_EnemyBase::GetTarget(const UBehaviorTreeComponent& OwnerComp, const ACPP_EnemyCharacterBase* Enemy) const
+{
+	if (!TargetKey.IsSet())
+		return Enemy ? Enemy->GetSelectedPawn() : nullptr;
+
+	const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+	return Blackboard ? Cast<AActor>(Blackboard->GetValue<UBlackboardKeyType_Object>(TargetKey.GetSelectedKeyID())) : nullptr;
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_MoveToAttackTarget.h"
+
+#include "ArenaFighter.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_FlowFieldSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Move To Attack Target"), STAT_MoveToAttackTarget, STATGROUP_ArenaFighter);
+
+UCPP_BTTask_MoveToAttackTarget::UCPP_BTTask_MoveToAttackTarget()
+{
+	NodeName = TEXT("Move To Attack Target (Flow Field)");
+	bNotifyTick = true;
+}
+
+EBTNodeResult::Type UCPP_BTTask_MoveToAttackTarget::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	return Move(OwnerComp);
+}
+
+void UCPP_BTTask_MoveToAttackTarget::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	const EBTNodeResult::Type Result = Move(OwnerComp);
+	if (Result != EBTNodeResult::InProgress)
+		FinishLatentTask(OwnerComp, Result);
+}
+
+EBTNodeResult::Type UCPP_BTTask_MoveToAttackTarget::Move(const UBehaviorTreeComponent& OwnerComp) const
+{
+	CPP_PROFILE_SCOPE(MoveToAttackTarget);
+
+	ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	const AActor* Target = GetTarget(OwnerComp, Enemy);
+	if (!Enemy || !Target) return EBTNodeResult::Failed;
+
+	const FVector Location = Enemy->GetActorLocation();
+	const float Radius = AcceptanceRadius >= 0.0f ? AcceptanceRadius : Enemy->AttackTargetRadius;
+	if (FVector::DistSquared2D(Location, Target->GetActorLocation()) <= FMath::Square(Radius))
+		return EBTNodeResult::Succeeded;
+
+	FVector Direction;
+	UCPP_FlowFieldSubsystem* FlowField = Enemy->GetWorld()->GetSubsystem<UCPP_FlowFieldSubsystem>();
+	if (!FlowField || !FlowField->SampleDirection(Target, Location, Direction))
+		Direction = (Target->GetActorLocation() - Location).GetSafeNormal2D();
+
+	Enemy->AddMovementInput(Direction);
+	return EBTNodeResult::InProgress;
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_PrepareForAttack.h"
+
+#include "AIController.h"
+#include "CPP_AttackTokenSubsystem.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_Weapon.h"
+#include "Navigation/PathFollowingComponent.h"
+
+UCPP_BTTask_PrepareForAttack::UCPP_BTTask_PrepareForAttack()
+{
+	NodeName = TEXT("Prepare For Attack");
+	bNotifyTick = true;
+	bTickIntervals = true;
+}
+
+EBTNodeResult::Type UCPP_BTTask_PrepareForAttack::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	return Prepare(OwnerComp, NodeMemory);
+}
+
+void UCPP_BTTask_PrepareForAttack::TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds)
+{
+	const EBTNodeResult::Type Result = Prepare(OwnerComp, NodeMemory);
+	if (Result != EBTNodeResult::InProgress)
+		FinishLatentTask(OwnerComp, Result);
+}
+
+EBTNodeResult::Type UCPP_BTTask_PrepareForAttack::Prepare(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const
+{
+	ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	AActor* Target = GetTarget(OwnerComp, Enemy);
+	AAIController* Controller = OwnerComp.GetAIOwner();
+	if (!Enemy || !Target || !Controller) return EBTNodeResult::Failed;
+
+	Controller->SetFocus(Target);
+
+	if (!Enemy->RequestAttackToken(Target))
+	{
+		const UCPP_AttackTokenSubsystem* AttackTokens = Enemy->GetWorld()->GetSubsystem<UCPP_AttackTokenSubsystem>();
+		Circle(*Controller, *Enemy, *Target);
+		SetNextTickTime(NodeMemory, AttackTokens ? AttackTokens->GetCirclingUpdateInterval() : 0.0f);
+		return EBTNodeResult::InProgress;
+	}
+
+	SetNextTickTime(NodeMemory, 0.0f);
+
+	const float DistanceSquared = FVector::DistSquared(Enemy->GetActorLocation(), Target->GetActorLocation());
+	const ACPP_Weapon* Weapon = Enemy->GetEquippedWeapon();
+	const float AttackRange = Weapon ? Weapon->GetAttackRange() : Enemy->AttackTargetRadius;
+	if (DistanceSquared <= FMath::Square(AttackRange))
+	{
+		if (Controller->GetMoveStatus() != EPathFollowingStatus::Idle)
+			Controller->StopMovement();
+		return EBTNodeResult::Succeeded;
+	}
+
+	// The target got away from the circle, chase it again
+	if (DistanceSquared > FMath::Square(Enemy->AttackTargetRadius + 2.0f * CirclingDistance))
+		return EBTNodeResult::Failed;
+
+	// Holding a token: leave the circle and close in to attack range
+	const UPathFollowingComponent* PathFollowing = Controller->GetPathFollowingComponent();
+	if (Controller->GetMoveStatus() != EPathFollowingStatus::Moving || !PathFollowing || PathFollowing->GetMoveGoal() != Target)
+		Controller->MoveToActor(Target, AttackRange * 0.8f, false);
+
+	return EBTNodeResult::InProgress;
+}
+
+void UCPP_BTTask_PrepareForAttack::Circle(AAIController& Controller, const ACPP_EnemyCharacterBase& Enemy, const AActor& Target) const
+{
+	// Enemies circle both ways so waiting enemies spread around the target instead of following each other
+	const float Direction = Enemy.GetUniqueID() % 2 ? 1.0f : -1.0f;
+
+	FVector Offset = Enemy.GetActorLocation() - Target.GetActorLocation();
+	Offset.Z = 0.0f;
+	Offset = Offset.GetSafeNormal().RotateAngleAxis(Direction * CirclingStepDegrees, FVector::UpVector)
+		* (Enemy.AttackTargetRadius + CirclingDistance);
+
+	Controller.MoveToLocation(Target.GetActorLocation() + Offset);
+}
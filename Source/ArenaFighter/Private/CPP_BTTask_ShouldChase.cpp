@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_BTTask_ShouldChase.h"
+
+#include "AIController.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "CPP_EnemyCharacterBase.h"
+
+UCPP_BTTask_ShouldChase::UCPP_BTTask_ShouldChase()
+{
+	NodeName = TEXT("Should Chase");
+
+	ShouldChaseKey.AddBoolFilter(this, GET_MEMBER_NAME_CHECKED(UCPP_BTTask_ShouldChase, ShouldChaseKey));
+	ShouldChaseKey.AllowNoneAsValue(true);
+}
+
+void UCPP_BTTask_ShouldChase::InitializeFromAsset(UBehaviorTree& Asset)
+{
+	Super::InitializeFromAsset(Asset);
+
+	if (const UBlackboardData* BlackboardAsset = GetBlackboardAsset())
+		ShouldChaseKey.ResolveSelectedKey(*BlackboardAsset);
+}
+
+EBTNodeResult::Type UCPP_BTTask_ShouldChase::ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory)
+{
+	ACPP_EnemyCharacterBase* Enemy = GetEnemy(OwnerComp);
+	AActor* Target = GetTarget(OwnerComp, Enemy);
+	if (!Enemy || !Target) return EBTNodeResult::Failed;
+
+	bool bShouldChase;
+	if (ShouldChaseKey.IsSet())
+	{
+		const UBlackboardComponent* Blackboard = OwnerComp.GetBlackboardComponent();
+		bShouldChase = Blackboard && Blackboard->GetValue<UBlackboardKeyType_Bool>(ShouldChaseKey.GetSelectedKeyID());
+	}
+	else
+	{
+		ACPP_CharacterBase* TargetCharacter = Cast<ACPP_CharacterBase>(Target);
+		bShouldChase = !Enemy->IsDead() && !(TargetCharacter && TargetCharacter->IsDead());
+	}
+
+	if (!bShouldChase) return EBTNodeResult::Failed;
+
+	OwnerComp.GetAIOwner()->SetFocus(Target);
+	return EBTNodeResult::Succeeded;
+}
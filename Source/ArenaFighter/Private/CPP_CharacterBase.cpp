@@ -3,12 +3,38 @@
 
 #include "CPP_CharacterBase.h"
 
+#include "ArenaFighter.h"
+#include "CPP_CombatAttributeSubsystem.h"
+#include "CPP_CombatRecorderSubsystem.h"
+#include "CPP_CombatTrace.h"
+#include "CPP_DamageSubsystem.h"
+#include "CPP_LineOfSightSubsystem.h"
+#include "CPP_MeleeHitSubsystem.h"
+#include "CPP_PerceptionSubsystem.h"
+#include "CPP_TargetIndexSubsystem.h"
+#include "CPP_TargetScoringSubsystem.h"
+#include "CPP_WeaponPoolSubsystem.h"
+#include "Engine/AssetManager.h"
 #include "Kismet/GameplayStatics.h"
+#include "Perception/PawnSensingComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("TrySelectPawn"), STAT_TrySelectPawn, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("EquipSelectedWeapon"), STAT_EquipSelectedWeapon, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("HandleAnyDamage"), STAT_HandleAnyDamage, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("AddHealth"), STAT_AddHealth, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("OnLineOfSightLost"), STAT_OnLineOfSightLost, STATGROUP_ArenaFighter);
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("TrySelectPawn Calls"), STAT_TrySelectPawnCalls, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("EquipSelectedWeapon Calls"), STAT_EquipSelectedWeaponCalls, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("HandleAnyDamage Calls"), STAT_HandleAnyDamageCalls, STATGROUP_ArenaFighter);
 
 const FString ACPP_CharacterBase::HandSockedName = TEXT("ik_hand_rSocket");
 
 bool ACPP_CharacterBase::IsDead()
 {
+	if (AttributeStore && AttributeStore->IsRegistered(AttributeHandle))
+		return AttributeStore->IsDead(AttributeHandle);
+
 	if(Health <= 0) return true;
 
 	return false;
@@ -17,8 +43,9 @@ bool ACPP_CharacterBase::IsDead()
 // Sets default values
 ACPP_CharacterBase::ACPP_CharacterBase()
 {
-	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// Tick() is only enabled while there is per-frame work, see SetTickRequested
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
 	SelectedPawn = nullptr;
 }
@@ -28,17 +55,23 @@ void ACPP_CharacterBase::BeginPlay()
 {
 	Super::BeginPlay();
 
-	PawnSensing = FindComponentByClass<UPawnSensingComponent>();
-	if (PawnSensing)
-		PawnSensing->OnSeePawn.AddDynamic(this, &ACPP_CharacterBase::OnSeePawn);
-	else
-		UE_LOG(LogTemp, Error, TEXT("No PawnSensingComponent found!"))
+	SetTickRequested(ECPP_TickRequest::Blueprint,
+	                 GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick)));
 
-	EquipSelectedWeapon();
+	ImportPawnSensingComponent();
+
+	// Blueprints may have changed Weapons since PostLoad, e.g. in their construction script
+	SyncSoftWeapons();
 
-	GetWorldTimerManager().SetTimer(CheckSightTimerHandle, this, &ACPP_CharacterBase::CheckForLostSight, 0.5f, true);
+	if (UCPP_WeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UCPP_WeaponPoolSubsystem>())
+		WeaponPool->Prewarm(SoftWeapons);
+
+	EquipSelectedWeapon();
+	LoadWeaponClasses();
 
 	OnTakeAnyDamage.AddDynamic(this, &ACPP_CharacterBase::HandleAnyDamage);
+
+	RegisterWithWorldSubsystems();
 }
 
 // Called every frame
@@ -46,30 +79,107 @@ void ACPP_CharacterBase::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (SelectedPawn && !IsDead())
+	INC_DWORD_STAT(STAT_ActorsTicked);
+	bool bDidWork = EnumHasAnyFlags(TickRequests, ECPP_TickRequest::Blueprint | ECPP_TickRequest::StateMachine);
+
+	if (bDrawSelectedPawnArrow && SelectedPawn && !IsDead())
+	{
 		DrawDebugDirectionalArrow(GetWorld(), GetActorLocation() + SelectedPawnArrowOffset,
 		                          SelectedPawn->GetActorLocation() + SelectedPawnArrowOffset,
 		                          5, SelectedItemArrowColor, false, 0, 2.0f);
+		bDidWork = true;
+	}
+
+	if (bDidWork)
+		INC_DWORD_STAT(STAT_ActorsTickedWithWork);
+}
+
+void ACPP_CharacterBase::SetTickRequested(ECPP_TickRequest Request, bool bRequested)
+{
+	if (bRequested)
+		EnumAddFlags(TickRequests, Request);
+	else
+		EnumRemoveFlags(TickRequests, Request);
+
+	SetActorTickEnabled(TickRequests != ECPP_TickRequest::None);
+}
+
+void ACPP_CharacterBase::SetStateMachineTickRequested(bool bRequested)
+{
+	SetTickRequested(ECPP_TickRequest::StateMachine, bRequested);
 }
 
 void ACPP_CharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	if(EquippedWeapon->IsValidLowLevel())
+	UnequipWeapon();
+	UnregisterFromWorldSubsystems();
+
+	if (WeaponClassesHandle.IsValid())
 	{
-		EquippedWeapon->Destroy();
-		EquippedWeapon = nullptr;
+		WeaponClassesHandle->CancelHandle();
+		WeaponClassesHandle.Reset();
 	}
+}
+
+void ACPP_CharacterBase::RegisterWithWorldSubsystems()
+{
+	if (UCPP_PerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UCPP_PerceptionSubsystem>())
+		Perception->Register(this);
+
+	if (UCPP_TargetIndexSubsystem* TargetIndex = GetWorld()->GetSubsystem<UCPP_TargetIndexSubsystem>())
+		TargetIndex->Register(this);
+
+	AttributeStore = GetWorld()->GetSubsystem<UCPP_CombatAttributeSubsystem>();
+	if (AttributeStore && !AttributeStore->IsRegistered(AttributeHandle))
+		AttributeHandle = AttributeStore->Register(this);
+}
+
+void ACPP_CharacterBase::UnregisterFromWorldSubsystems()
+{
+	if (UCPP_PerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UCPP_PerceptionSubsystem>())
+		Perception->Unregister(this);
 
-	if (PawnSensing)
-		PawnSensing->OnSeePawn.RemoveDynamic(this, &ACPP_CharacterBase::OnSeePawn);
+	if (UCPP_LineOfSightSubsystem* LineOfSight = GetWorld()->GetSubsystem<UCPP_LineOfSightSubsystem>())
+		LineOfSight->CancelQueries(this);
 
-	GetWorldTimerManager().ClearTimer(CheckSightTimerHandle);
+	if (UCPP_TargetIndexSubsystem* TargetIndex = GetWorld()->GetSubsystem<UCPP_TargetIndexSubsystem>())
+		TargetIndex->Unregister(this);
+
+	if (UCPP_DamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCPP_DamageSubsystem>())
+		DamageSubsystem->DiscardAttacks(this);
+
+	if (AttributeStore)
+		AttributeStore->Unregister(AttributeHandle);
+
+	CancelPendingSelection();
+}
+
+void ACPP_CharacterBase::ResetCharacterState()
+{
+	Health = MaxHealth;
+	if (AttributeStore)
+	{
+		AttributeStore->SetMaxHealth(AttributeHandle, MaxHealth);
+		AttributeStore->SetHealth(AttributeHandle, Health);
+	}
+	DetectedPawns.Empty();
+	SelectedPawn = nullptr;
+	bDetectedPawnsChangedPending = false;
+	SetTickRequested(ECPP_TickRequest::DebugDraw, false);
+
+	OnHealthChanged(Health);
 }
 
 void ACPP_CharacterBase::ChangeWeapon(float actionValue)
 {
+	if (UCPP_CombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCPP_CombatRecorderSubsystem>())
+	{
+		if (!Recorder->AcceptsLiveInput()) return;
+		Recorder->RecordChangeWeapon(this, actionValue);
+	}
+
 	if (actionValue > 0)
 		NextWeapon();
 
@@ -86,7 +196,7 @@ void ACPP_CharacterBase::SetupPlayerInputComponent(UInputComponent* PlayerInputC
 void ACPP_CharacterBase::NextWeapon()
 {
 	CurrentWeaponIndex++;
-	if (CurrentWeaponIndex > Weapons.Num() - 1)
+	if (CurrentWeaponIndex > SoftWeapons.Num() - 1)
 		CurrentWeaponIndex = 0;
 
 	EquipSelectedWeapon();
@@ -96,55 +206,138 @@ void ACPP_CharacterBase::PrevWeapon()
 {
 	CurrentWeaponIndex--;
 	if (CurrentWeaponIndex < 0)
-		CurrentWeaponIndex = Weapons.Num() - 1;
+		CurrentWeaponIndex = SoftWeapons.Num() - 1;
 
 	EquipSelectedWeapon();
 }
 
-void ACPP_CharacterBase::OnSeePawn(APawn* DetectedPawn)
+void ACPP_CharacterBase::PostLoad()
 {
-	if (DetectedPawn)
-	{
-		DetectedPawns.Add(DetectedPawn);
-		UE_LOG(LogTemp, Log, TEXT("Pawn added: %s"), *DetectedPawn->GetName());
-		TrySelectPawn();
-		OnDetectedPawnsChanged();
-	}
+	Super::PostLoad();
+
+	SyncSoftWeapons();
 }
 
-void ACPP_CharacterBase::CheckForLostSight()
+void ACPP_CharacterBase::SyncSoftWeapons()
 {
-	if(IsDead()) return;
-	
-	bool bWasAnyPawnRemoved = false;
+	if (Weapons.IsEmpty()) return;
 
-	for (TSet<APawn*>::TIterator it = DetectedPawns; it; ++it)
-	// for (APawn* Pawn : DetectedPawns)
-	{
-		APawn* Pawn = *it;
-		if (!Pawn || !PawnSensing->CouldSeePawn(Pawn))
+	TArray<TSoftClassPtr<ACPP_Weapon>> WeaponClasses;
+	WeaponClasses.Reserve(Weapons.Num() + SoftWeapons.Num());
+	for (const TSubclassOf<ACPP_Weapon>& Weapon : Weapons)
+		WeaponClasses.Add(TSoftClassPtr<ACPP_Weapon>(Weapon.Get()));
+
+	for (const TSoftClassPtr<ACPP_Weapon>& Weapon : SoftWeapons)
+		if (!WeaponClasses.Contains(Weapon))
+			WeaponClasses.Add(Weapon);
+
+	SoftWeapons = MoveTemp(WeaponClasses);
+}
+
+void ACPP_CharacterBase::LoadWeaponClasses()
+{
+	TArray<FSoftObjectPath> WeaponPaths;
+	for (const TSoftClassPtr<ACPP_Weapon>& Weapon : SoftWeapons)
+		if (!Weapon.IsNull())
+			WeaponPaths.AddUnique(Weapon.ToSoftObjectPath());
+
+	if (WeaponPaths.IsEmpty()) return;
+
+	WeaponClassesHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		WeaponPaths, FStreamableDelegate::CreateWeakLambda(this, [this]()
 		{
-			UE_LOG(LogTemp, Log, TEXT("Stopped seeing Pawn: %s"), *Pawn->GetName());
-			DetectedPawns.Remove(Pawn);
-			bWasAnyPawnRemoved = true;
-		}
+			if (UCPP_WeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UCPP_WeaponPoolSubsystem>())
+				WeaponPool->Prewarm(SoftWeapons);
+
+			if (!EquippedWeapon && !IsHidden())
+				EquipSelectedWeapon();
+		}));
+}
+
+void ACPP_CharacterBase::ImportPawnSensingComponent()
+{
+	UPawnSensingComponent* PawnSensing = FindComponentByClass<UPawnSensingComponent>();
+	if (!PawnSensing) return;
+
+	SightRadius = PawnSensing->SightRadius;
+	PeripheralVisionAngle = PawnSensing->GetPeripheralVisionAngle();
+	bOnlySensePlayers = PawnSensing->bOnlySensePlayers;
+	SensingInterval = PawnSensing->SensingInterval;
+
+	PawnSensing->SetSensingUpdatesEnabled(false);
+	PawnSensing->DestroyComponent();
+}
+
+void ACPP_CharacterBase::ApplyPerception(TConstArrayView<APawn*> Added, TConstArrayView<APawn*> Removed)
+{
+	if (IsDead()) return;
+
+	for (APawn* Pawn : Added)
+	{
+		DetectedPawns.Add(Pawn);
+
+		CPP_COMBAT_TRACE(Detected, this, Pawn, 0.0f);
+		if (FCPP_CombatTrace::IsVerbose())
+			UE_LOG(LogTemp, Log, TEXT("Pawn added: %s"), *GetNameSafe(Pawn));
 	}
 
-	if (bWasAnyPawnRemoved || DetectedPawns.IsEmpty())
+	for (APawn* Pawn : Removed)
 	{
-		TrySelectPawn();
-		OnDetectedPawnsChanged();
+		DetectedPawns.Remove(Pawn);
+
+		CPP_COMBAT_TRACE(LostSight, this, Pawn, 0.0f);
+		if (FCPP_CombatTrace::IsVerbose())
+			UE_LOG(LogTemp, Log, TEXT("Stopped seeing Pawn: %s"), *GetNameSafe(Pawn));
 	}
+
+	CSV_CUSTOM_STAT(ArenaFighter, MaxDetectedPawns, DetectedPawns.Num(), ECsvCustomStatOp::Max);
+
+	bDetectedPawnsChangedPending = true;
+	RequestSelectPawn();
+}
+
+void ACPP_CharacterBase::OnLineOfSightLost(APawn* Target)
+{
+	CPP_PROFILE_SCOPE_BUCKET(OnLineOfSightLost, Sensing);
+
+	if (IsDead() || DetectedPawns.Remove(Target) == 0) return;
+
+	CPP_COMBAT_TRACE(LostSight, this, Target, 0.0f);
+	if (FCPP_CombatTrace::IsVerbose())
+		UE_LOG(LogTemp, Log, TEXT("Stopped seeing Pawn: %s"), *GetNameSafe(Target));
+	bDetectedPawnsChangedPending = true;
+	RequestSelectPawn();
 }
 
 void ACPP_CharacterBase::TakeAttack(ACharacter* attacker, float damage)
 {
-	if(!IsDead())
-		UGameplayStatics::ApplyDamage(this, damage, GetController(), attacker, UDamageType::StaticClass());
+	if (UCPP_CombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCPP_CombatRecorderSubsystem>())
+	{
+		if (!Recorder->AcceptsLiveInput()) return;
+		Recorder->RecordTakeAttack(this, attacker, damage);
+	}
+
+	if(IsDead()) return;
+
+	UCPP_DamageSubsystem* DamageSubsystem = GetWorld()->GetSubsystem<UCPP_DamageSubsystem>();
+	if (DamageSubsystem && DamageSubsystem->QueueAttack(this, attacker, damage)) return;
+
+	UGameplayStatics::ApplyDamage(this, damage, GetController(), attacker, UDamageType::StaticClass());
+}
+
+void ACPP_CharacterBase::StartMeleeSwing()
+{
+	if (IsDead() || !EquippedWeapon) return;
+
+	if (UCPP_MeleeHitSubsystem* MeleeHits = GetWorld()->GetSubsystem<UCPP_MeleeHitSubsystem>())
+		MeleeHits->QueueSwing(this, EquippedWeapon);
 }
 
 void ACPP_CharacterBase::TrySelectPawn()
 {
+	CPP_PROFILE_SCOPE_BUCKET(TrySelectPawn, Selection);
+	INC_DWORD_STAT(STAT_TrySelectPawnCalls);
+
 	APawn* ClosestPawn = nullptr;
 	float ClosestDistance = FLT_MAX;
 	float MaxDotProduct = -FLT_MAX;
@@ -152,40 +345,55 @@ void ACPP_CharacterBase::TrySelectPawn()
 	FVector CharacterLocation = GetActorLocation();
 	FVector CharacterForward = GetActorForwardVector();
 
-	for (APawn* DetectedPawn : DetectedPawns)
-		if (DetectedPawn)
+	TArray<ACPP_CharacterBase*> Candidates;
+	GatherSelectionCandidates(Candidates);
+
+	for (ACPP_CharacterBase* Candidate : Candidates)
+	{
+		// Calculate the vector from the character to the detected pawn
+		FVector DirectionToPawn = Candidate->GetActorLocation() - CharacterLocation;
+
+		// Calculate distance to the pawn
+		float DistanceToPawn = DirectionToPawn.Size();
+		if (DistanceToPawn <= UE_SMALL_NUMBER)
+			continue;
+
+		// Calculate the dot product to determine how "in front" the pawn is
+		float DotProduct = FVector::DotProduct(CharacterForward, DirectionToPawn) / DistanceToPawn;
+
+		// Check if this pawn is closer and more in front than the previous one
+		if (DotProduct > 0.0f // Pawn must be in front
+			&& DotProduct > MaxDotProduct
+			&& DistanceToPawn < ClosestDistance)
 		{
-			ACPP_CharacterBase* CharacterBase = Cast<ACPP_CharacterBase>(DetectedPawn);
-			if(CharacterBase->IsDead())
-				continue;
-
-			// Calculate the vector from the character to the detected pawn
-			FVector DirectionToPawn = DetectedPawn->GetActorLocation() - CharacterLocation;
-
-			// Calculate distance to the pawn
-			float DistanceToPawn = DirectionToPawn.Size();
-
-			// Calculate the dot product to determine how "in front" the pawn is
-			float DotProduct = FVector::DotProduct(CharacterForward, DirectionToPawn.GetSafeNormal());
-
-			// Check if this pawn is closer and more in front than the previous one
-			if (DotProduct > 0.0f // Pawn must be in front
-				&& DotProduct > MaxDotProduct
-				&& DistanceToPawn < ClosestDistance)
-			{
-				MaxDotProduct = DotProduct;
-				ClosestPawn = DetectedPawn;
-				ClosestDistance = DistanceToPawn;
-			}
+			MaxDotProduct = DotProduct;
+			ClosestPawn = Candidate;
+			ClosestDistance = DistanceToPawn;
 		}
+	}
 
 	// Set the SelectedPawn to the closest and most in front pawn
-	if (ClosestPawn->IsValidLowLevel())
+	ApplySelectedPawn(ClosestPawn);
+}
+
+void ACPP_CharacterBase::RequestSelectPawn()
+{
+	UCPP_TargetScoringSubsystem* TargetScoring = GetWorld()->GetSubsystem<UCPP_TargetScoringSubsystem>();
+	if (!TargetScoring || !TargetScoring->RequestSelection(this))
+		TrySelectPawn();
+}
+
+void ACPP_CharacterBase::ApplySelectedPawn(APawn* NewSelectedPawn)
+{
+	if (NewSelectedPawn->IsValidLowLevel())
 	{
-		if (ClosestPawn != SelectedPawn)
+		if (NewSelectedPawn != SelectedPawn)
 		{
-			SelectedPawn = ClosestPawn;
-			UE_LOG(LogTemp, Log, TEXT("Selected Pawn: %s"), *SelectedPawn->GetName());
+			SelectedPawn = NewSelectedPawn;
+			SetTickRequested(ECPP_TickRequest::DebugDraw, bDrawSelectedPawnArrow && !UE_BUILD_SHIPPING);
+			CPP_COMBAT_TRACE(TargetChanged, this, SelectedPawn, 0.0f);
+			if (FCPP_CombatTrace::IsVerbose())
+				UE_LOG(LogTemp, Log, TEXT("Selected Pawn: %s"), *SelectedPawn->GetName());
 			OnSelectedPawnChanged();
 		}
 	}
@@ -194,54 +402,157 @@ void ACPP_CharacterBase::TrySelectPawn()
 		if (SelectedPawn != nullptr)
 		{
 			SelectedPawn = nullptr; // No valid pawn found
+			CPP_COMBAT_TRACE(TargetChanged, this, nullptr, 0.0f);
+			SetTickRequested(ECPP_TickRequest::DebugDraw, false);
 			OnSelectedPawnChanged();
 		}
 	}
+
+	// Raised after the selection so handlers see the SelectedPawn that matches DetectedPawns
+	if (bDetectedPawnsChangedPending)
+	{
+		bDetectedPawnsChangedPending = false;
+		OnDetectedPawnsChanged();
+	}
+}
+
+void ACPP_CharacterBase::CancelPendingSelection()
+{
+	bDetectedPawnsChangedPending = false;
+
+	if (UCPP_TargetScoringSubsystem* TargetScoring = GetWorld()->GetSubsystem<UCPP_TargetScoringSubsystem>())
+		TargetScoring->CancelSelection(this);
+}
+
+void ACPP_CharacterBase::GatherSelectionCandidates(TArray<ACPP_CharacterBase*>& OutCandidates) const
+{
+	OutCandidates.Reset();
+	if (DetectedPawns.IsEmpty()) return;
+
+	const FVector Location = GetActorLocation();
+	const float SightRadiusSquared = FMath::Square(SightRadius);
+
+	// The index is the candidate source: only the cells within SightRadius in front of the character are visited,
+	// since TrySelectPawn skips everything behind it. Only living characters are indexed.
+	const UCPP_TargetIndexSubsystem* TargetIndex = GetWorld()->GetSubsystem<UCPP_TargetIndexSubsystem>();
+	if (TargetIndex)
+	{
+		TargetIndex->QueryInFront(Location, GetActorForwardVector(), SightRadius, this, OutCandidates);
+		OutCandidates.RemoveAllSwap([this, &Location, SightRadiusSquared](const ACPP_CharacterBase* Candidate)
+		{
+			return !DetectedPawns.Contains(Candidate)
+				|| FVector::DistSquared(Candidate->GetActorLocation(), Location) > SightRadiusSquared;
+		}, EAllowShrinking::No);
+		return;
+	}
+
+	for (APawn* DetectedPawn : DetectedPawns)
+	{
+		ACPP_CharacterBase* CharacterBase = Cast<ACPP_CharacterBase>(DetectedPawn);
+		if (CharacterBase && !CharacterBase->IsDead()
+			&& FVector::DistSquared(CharacterBase->GetActorLocation(), Location) <= SightRadiusSquared)
+			OutCandidates.Add(CharacterBase);
+	}
 }
 
 void ACPP_CharacterBase::HandleAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType,
                                          AController* InstigatedBy, AActor* DamageCauser)
 {
+	CPP_PROFILE_SCOPE_BUCKET(HandleAnyDamage, Damage);
+	INC_DWORD_STAT(STAT_HandleAnyDamageCalls);
+
 	AddHealth(-Damage);
-	UE_LOG(LogTemp, Log, TEXT("%s - Applied damage: %f - Caster: %s"),
-	       *DamagedActor->GetName(), Damage, *DamageCauser->GetName());
+
+	CPP_COMBAT_TRACE(Damage, DamagedActor, DamageCauser, Damage);
+	if (FCPP_CombatTrace::IsVerbose())
+		UE_LOG(LogTemp, Log, TEXT("%s - Applied damage: %f - Caster: %s"),
+		       *GetNameSafe(DamagedActor), Damage, *GetNameSafe(DamageCauser));
 
 	if (Health <= 0) Die();
 }
 
+void ACPP_CharacterBase::ApplyBatchedDamage(float Damage, int32 Hits, AActor* LastDamageCauser)
+{
+	if (IsDead()) return;
+
+	if (FCPP_CombatTrace::IsVerbose())
+		UE_LOG(LogTemp, Log, TEXT("%s - Batched damage: %f from %d hits - Last caster: %s"),
+		       *GetName(), Damage, Hits, *GetNameSafe(LastDamageCauser));
+
+	// Same path as an unbatched attack, once per frame: Blueprints see one AnyDamage event with the total
+	// and HandleAnyDamage applies it
+	UGameplayStatics::ApplyDamage(this, Damage, GetController(), LastDamageCauser, UDamageType::StaticClass());
+}
+
 void ACPP_CharacterBase::Die()
 {
-	if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Die"));
+	CPP_COMBAT_TRACE(Death, this, nullptr, 0.0f);
+	if (FCPP_CombatTrace::IsVerbose() && GEngine)
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Die"));
+
+	if (UCPP_TargetIndexSubsystem* TargetIndex = GetWorld()->GetSubsystem<UCPP_TargetIndexSubsystem>())
+		TargetIndex->Unregister(this);
+
+	CancelPendingSelection();
+	SetTickRequested(ECPP_TickRequest::DebugDraw, false);
+
 	OnDie();
 	OnDieDispatcher.Broadcast();
 }
 
+void ACPP_CharacterBase::SetMaxHealth(float NewMaxHealth)
+{
+	MaxHealth = FMath::Max(NewMaxHealth, 0.0f);
+	const float PreviousHealth = Health;
+
+	if (AttributeStore && AttributeStore->IsRegistered(AttributeHandle))
+		Health = AttributeStore->SetMaxHealth(AttributeHandle, MaxHealth);
+	else
+		Health = FMath::Min(Health, MaxHealth);
+
+	if (Health != PreviousHealth)
+		OnHealthChanged(Health);
+}
+
 void ACPP_CharacterBase::AddHealth(float add)
 {
-	Health += add;
-	Health = FMath::Clamp(Health, 0, MaxHealth);
+	CPP_PROFILE_SCOPE(AddHealth);
+
+	if (AttributeStore && AttributeStore->IsRegistered(AttributeHandle))
+		Health = AttributeStore->AddHealth(AttributeHandle, add);
+	else
+	{
+		Health += add;
+		Health = FMath::Clamp(Health, 0, MaxHealth);
+	}
 	OnHealthChanged(Health);
 }
 
 
 void ACPP_CharacterBase::EquipSelectedWeapon()
 {
-	// Destroy previous weapon
-	if (EquippedWeapon && EquippedWeapon->IsValidLowLevel())
-	{
-		EquippedWeapon->Destroy();
-		EquippedWeapon = nullptr;
-	}
+	CPP_PROFILE_SCOPE_BUCKET(EquipSelectedWeapon, WeaponEquip);
+	INC_DWORD_STAT(STAT_EquipSelectedWeaponCalls);
 
-	// Spawn current weapon indicated by CurrentWeaponIndex
-	if (Weapons.Num() > 0 && Weapons[CurrentWeaponIndex])
+	// Return previous weapon
+	UnequipWeapon();
+
+	// Acquire current weapon indicated by CurrentWeaponIndex. A class that is still loading is equipped by LoadWeaponClasses.
+	UClass* WeaponClass = SoftWeapons.IsValidIndex(CurrentWeaponIndex) ? SoftWeapons[CurrentWeaponIndex].Get() : nullptr;
+	if (WeaponClass)
 	{
-		FActorSpawnParameters spawnParameters;
-		spawnParameters.Owner = this;
-		spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		ACPP_Weapon* equippedWeapon = nullptr;
+
+		if (UCPP_WeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UCPP_WeaponPoolSubsystem>())
+			equippedWeapon = WeaponPool->Acquire(WeaponClass, this);
+		else
+		{
+			FActorSpawnParameters spawnParameters;
+			spawnParameters.Owner = this;
+			spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
 
-		ACPP_Weapon* equippedWeapon = GetWorld()->SpawnActor<ACPP_Weapon>(
-			Weapons[CurrentWeaponIndex], spawnParameters);
+			equippedWeapon = GetWorld()->SpawnActor<ACPP_Weapon>(WeaponClass, spawnParameters);
+		}
 
 		if (equippedWeapon)
 		{
@@ -254,4 +565,21 @@ void ACPP_CharacterBase::EquipSelectedWeapon()
 			EquippedWeapon = equippedWeapon;
 		}
 	}
+
+	if (AttributeStore)
+		AttributeStore->SetWeapon(AttributeHandle, CurrentWeaponIndex,
+		                          EquippedWeapon ? EquippedWeapon->GetAttackReach() : 0.0f,
+		                          EquippedWeapon ? EquippedWeapon->GetDamage() : 0.0f);
+}
+
+void ACPP_CharacterBase::UnequipWeapon()
+{
+	if (!EquippedWeapon || !EquippedWeapon->IsValidLowLevel()) return;
+
+	if (UCPP_WeaponPoolSubsystem* WeaponPool = GetWorld()->GetSubsystem<UCPP_WeaponPoolSubsystem>())
+		WeaponPool->Release(EquippedWeapon);
+	else
+		EquippedWeapon->Destroy();
+
+	EquippedWeapon = nullptr;
 }
@@ -0,0 +1,312 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_CombatAttributeSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CharacterBase.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Combat Attribute Entries"), STAT_CombatAttributeEntries, STATGROUP_ArenaFighter);
+
+FCPP_CombatAttributeHandle UCPP_CombatAttributeSubsystem::Register(ACPP_CharacterBase* Character)
+{
+	if (!Character) return FCPP_CombatAttributeHandle();
+
+	const int32 Slot = FreeSlots.IsEmpty() ? Slots.AddDefaulted() : FreeSlots.Pop(EAllowShrinking::No);
+	const int32 DenseIndex = Characters.Add(Character);
+	Slots[Slot].DenseIndex = DenseIndex;
+
+	const ACPP_Weapon* Weapon = Character->GetEquippedWeapon();
+	const FVector Location = Character->GetActorLocation();
+
+	DenseSlots.Add(Slot);
+	Health.Add(Character->GetHealth());
+	MaxHealth.Add(Character->GetMaxHealth());
+	WeaponIndex.Add(Character->GetCurrentWeaponIndex());
+	WeaponReach.Add(Weapon ? Weapon->GetAttackReach() : 0.0f);
+	WeaponDamage.Add(Weapon ? Weapon->GetDamage() : 0.0f);
+	IsEnemy.Add(Character->IsA<ACPP_EnemyCharacterBase>());
+	LocationX.Add(Location.X);
+	LocationY.Add(Location.Y);
+	LocationZ.Add(Location.Z);
+	LocationsFrame = MAX_uint64;
+
+	FCPP_CombatAttributeHandle Handle;
+	Handle.Slot = Slot;
+	Handle.Generation = Slots[Slot].Generation;
+	return Handle;
+}
+
+void UCPP_CombatAttributeSubsystem::Unregister(FCPP_CombatAttributeHandle& Handle)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	Handle.Reset();
+	if (DenseIndex == INDEX_NONE) return;
+
+	FSlot& Slot = Slots[DenseSlots[DenseIndex]];
+	FreeSlots.Add(DenseSlots[DenseIndex]);
+	Slot.DenseIndex = INDEX_NONE;
+	Slot.Generation++;
+
+	Characters.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	DenseSlots.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	Health.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	MaxHealth.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	WeaponIndex.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	WeaponReach.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	WeaponDamage.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	IsEnemy.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LocationX.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LocationY.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	LocationZ.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+
+	// The last entry moved into the freed place
+	if (DenseSlots.IsValidIndex(DenseIndex))
+		Slots[DenseSlots[DenseIndex]].DenseIndex = DenseIndex;
+}
+
+float UCPP_CombatAttributeSubsystem::GetHealth(const FCPP_CombatAttributeHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? Health[DenseIndex] : 0.0f;
+}
+
+float UCPP_CombatAttributeSubsystem::GetMaxHealth(const FCPP_CombatAttributeHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex != INDEX_NONE ? MaxHealth[DenseIndex] : 0.0f;
+}
+
+bool UCPP_CombatAttributeSubsystem::IsDead(const FCPP_CombatAttributeHandle& Handle) const
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	return DenseIndex == INDEX_NONE || Health[DenseIndex] <= 0.0f;
+}
+
+float UCPP_CombatAttributeSubsystem::SetHealth(const FCPP_CombatAttributeHandle& Handle, float NewHealth)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE) return 0.0f;
+
+	Health[DenseIndex] = FMath::Clamp(NewHealth, 0.0f, MaxHealth[DenseIndex]);
+	return Health[DenseIndex];
+}
+
+float UCPP_CombatAttributeSubsystem::SetMaxHealth(const FCPP_CombatAttributeHandle& Handle, float NewMaxHealth)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE) return 0.0f;
+
+	MaxHealth[DenseIndex] = FMath::Max(NewMaxHealth, 0.0f);
+	Health[DenseIndex] = FMath::Min(Health[DenseIndex], MaxHealth[DenseIndex]);
+	return Health[DenseIndex];
+}
+
+float UCPP_CombatAttributeSubsystem::AddHealth(const FCPP_CombatAttributeHandle& Handle, float Delta)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE) return 0.0f;
+
+	Health[DenseIndex] = FMath::Clamp(Health[DenseIndex] + Delta, 0.0f, MaxHealth[DenseIndex]);
+	return Health[DenseIndex];
+}
+
+void UCPP_CombatAttributeSubsystem::SetWeapon(const FCPP_CombatAttributeHandle& Handle, int32 Index, float Reach,
+                                              float Damage)
+{
+	const int32 DenseIndex = GetDenseIndex(Handle);
+	if (DenseIndex == INDEX_NONE) return;
+
+	WeaponIndex[DenseIndex] = Index;
+	WeaponReach[DenseIndex] = Reach;
+	WeaponDamage[DenseIndex] = Damage;
+}
+
+void UCPP_CombatAttributeSubsystem::QueryHealthBelow(float Fraction, bool bEnemiesOnly,
+                                                     TArray<ACPP_CharacterBase*>& OutCharacters) const
+{
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		if (Health[Index] > 0.0f && Health[Index] < MaxHealth[Index] * Fraction && (!bEnemiesOnly || IsEnemy[Index]))
+			OutCharacters.Add(Characters[Index]);
+}
+
+int32 UCPP_CombatAttributeSubsystem::CountAlive(bool bEnemiesOnly, float* OutHealthSum) const
+{
+	int32 Count = 0;
+	float HealthSum = 0.0f;
+
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+		if (Health[Index] > 0.0f && (!bEnemiesOnly || IsEnemy[Index]))
+		{
+			Count++;
+			HealthSum += Health[Index];
+		}
+
+	if (OutHealthSum)
+		*OutHealthSum = HealthSum;
+	return Count;
+}
+
+void UCPP_CombatAttributeSubsystem::QueryInRange(const FVector& Origin, float Radius, bool bEnemiesOnly,
+                                                 TArray<ACPP_CharacterBase*>& OutCharacters) const
+{
+	RefreshLocations();
+
+	const float RadiusSquared = FMath::Square(Radius);
+	const float OriginX = Origin.X, OriginY = Origin.Y, OriginZ = Origin.Z;
+
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+	{
+		const float DeltaX = LocationX[Index] - OriginX;
+		const float DeltaY = LocationY[Index] - OriginY;
+		const float DeltaZ = LocationZ[Index] - OriginZ;
+
+		if (DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ <= RadiusSquared
+			&& Health[Index] > 0.0f && (!bEnemiesOnly || IsEnemy[Index]))
+			OutCharacters.Add(Characters[Index]);
+	}
+}
+
+void UCPP_CombatAttributeSubsystem::Deinitialize()
+{
+	Slots.Empty();
+	FreeSlots.Empty();
+	Characters.Empty();
+	DenseSlots.Empty();
+	Health.Empty();
+	MaxHealth.Empty();
+	WeaponIndex.Empty();
+	WeaponReach.Empty();
+	WeaponDamage.Empty();
+	IsEnemy.Empty();
+	LocationX.Empty();
+	LocationY.Empty();
+	LocationZ.Empty();
+	LocationsFrame = MAX_uint64;
+
+	Super::Deinitialize();
+}
+
+void UCPP_CombatAttributeSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_CombatAttributeEntries, Characters.Num());
+}
+
+TStatId UCPP_CombatAttributeSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_CombatAttributeSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_CombatAttributeSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UCPP_CombatAttributeSubsystem::GetDenseIndex(const FCPP_CombatAttributeHandle& Handle) const
+{
+	if (!Slots.IsValidIndex(Handle.Slot)) return INDEX_NONE;
+
+	const FSlot& Slot = Slots[Handle.Slot];
+	return Slot.Generation == Handle.Generation ? Slot.DenseIndex : INDEX_NONE;
+}
+
+void UCPP_CombatAttributeSubsystem::RefreshLocations() const
+{
+	if (LocationsFrame == GFrameCounter) return;
+	LocationsFrame = GFrameCounter;
+
+	for (int32 Index = 0; Index < Characters.Num(); ++Index)
+	{
+		const FVector Location = Characters[Index]->GetActorLocation();
+		LocationX[Index] = Location.X;
+		LocationY[Index] = Location.Y;
+		LocationZ[Index] = Location.Z;
+	}
+}
+
+/**
+ * Runs the store's batch queries against the same queries done by reading every character actor,
+ * and logs the time of each. Spawn a crowd first, e.g. with -ArenaStress=1000.
+ */
+static FAutoConsoleCommandWithWorldAndArgs CombatAttributeBenchmarkCommand(
+	TEXT("ArenaFighter.Attributes.Benchmark"),
+	TEXT("Times arena-wide queries on the attribute store and on the character actors. Usage: ArenaFighter.Attributes.Benchmark [Iterations]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UCPP_CombatAttributeSubsystem* Store = World ? World->GetSubsystem<UCPP_CombatAttributeSubsystem>() : nullptr;
+		if (!Store) return;
+
+		const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+
+		TArray<ACPP_CharacterBase*> Actors;
+		for (TActorIterator<ACPP_CharacterBase> It(World); It; ++It)
+			Actors.Add(*It);
+
+		const APawn* Player = World->GetFirstPlayerController() ? World->GetFirstPlayerController()->GetPawn() : nullptr;
+		const ACPP_CharacterBase* PlayerCharacter = Cast<ACPP_CharacterBase>(Player);
+		const FVector Origin = Player ? Player->GetActorLocation() : FVector::ZeroVector;
+		const float Reach = PlayerCharacter && PlayerCharacter->GetEquippedWeapon()
+			                    ? PlayerCharacter->GetEquippedWeapon()->GetAttackReach()
+			                    : 200.0f;
+
+		TArray<ACPP_CharacterBase*> Result;
+		Result.Reserve(Actors.Num());
+		int32 Checksum = 0;
+
+		auto Time = [&](auto&& Query)
+		{
+			const double Start = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				Result.Reset();
+				Query();
+				Checksum += Result.Num();
+			}
+			return (FPlatformTime::Seconds() - Start) * 1e6 / Iterations;
+		};
+
+		const double StoreHealthBelow = Time([&] { Store->QueryHealthBelow(0.2f, false, Result); });
+		const double ActorHealthBelow = Time([&]
+		{
+			for (ACPP_CharacterBase* Actor : Actors)
+				if (Actor->GetHealth() > 0.0f && Actor->GetHealth() < Actor->GetMaxHealth() * 0.2f)
+					Result.Add(Actor);
+		});
+
+		const double StoreSumAlive = Time([&]
+		{
+			float HealthSum = 0.0f;
+			Checksum += Store->CountAlive(true, &HealthSum) + FMath::TruncToInt32(HealthSum);
+		});
+		const double ActorSumAlive = Time([&]
+		{
+			float HealthSum = 0.0f;
+			for (ACPP_CharacterBase* Actor : Actors)
+				if (Actor->GetHealth() > 0.0f && Actor->IsA<ACPP_EnemyCharacterBase>())
+				{
+					HealthSum += Actor->GetHealth();
+					Checksum++;
+				}
+			Checksum += FMath::TruncToInt32(HealthSum);
+		});
+
+		const double StoreInRange = Time([&] { Store->QueryInRange(Origin, Reach, true, Result); });
+		const double ActorInRange = Time([&]
+		{
+			for (ACPP_CharacterBase* Actor : Actors)
+				if (Actor->GetHealth() > 0.0f && Actor->IsA<ACPP_EnemyCharacterBase>()
+					&& FVector::DistSquared(Actor->GetActorLocation(), Origin) <= FMath::Square(Reach))
+					Result.Add(Actor);
+		});
+
+		UE_LOG(LogTemp, Display, TEXT("Attribute store benchmark: %d characters (%d in store), %d iterations, checksum %d"),
+		       Actors.Num(), Store->Num(), Iterations, Checksum);
+		UE_LOG(LogTemp, Display, TEXT("  Health below 20%%:   store %8.2f us   actors %8.2f us"), StoreHealthBelow, ActorHealthBelow);
+		UE_LOG(LogTemp, Display, TEXT("  Alive enemy health:  store %8.2f us   actors %8.2f us"), StoreSumAlive, ActorSumAlive);
+		UE_LOG(LogTemp, Display, TEXT("  Enemies in reach:    store %8.2f us   actors %8.2f us"), StoreInRange, ActorInRange);
+	}));
@@ -0,0 +1,406 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_CombatRecorderSubsystem.h"
+
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_RoundStreamingSubsystem.h"
+#include "CPP_RoundsConfigurations.h"
+#include "EngineUtils.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace CPP_CombatRecordingFile
+{
+	static constexpr uint32 Magic = 0x52434641; // "AFCR"
+	static constexpr uint32 Version = 1;
+}
+
+void UCPP_CombatRecorderSubsystem::StartRecording(const FString& FilePath)
+{
+	if (Mode != EMode::Idle) return;
+
+	Mode = EMode::Recording;
+	Frame = 0;
+	RecordPath = FilePath;
+	RecordBuffer.Reset();
+	RecordedActorIds.Reset();
+	NextActorId = 1;
+	RecordWriter = MakeUnique<FMemoryWriter>(RecordBuffer);
+
+	uint32 Magic = CPP_CombatRecordingFile::Magic;
+	uint32 Version = CPP_CombatRecordingFile::Version;
+	FString MapName = UWorld::RemovePIEPrefix(GetWorld()->GetMapName());
+	*RecordWriter << Magic << Version << MapName;
+
+	UE_LOG(LogTemp, Display, TEXT("Combat recording started: %s"), *RecordPath);
+}
+
+void UCPP_CombatRecorderSubsystem::StopRecording()
+{
+	if (Mode != EMode::Recording) return;
+
+	Mode = EMode::Idle;
+	RecordWriter.Reset();
+
+	if (FFileHelper::SaveArrayToFile(RecordBuffer, *RecordPath))
+	{
+		UE_LOG(LogTemp, Display, TEXT("Combat recording of %u frames written to %s (%d bytes)"), Frame, *RecordPath,
+		       RecordBuffer.Num());
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write combat recording to %s"), *RecordPath);
+	}
+
+	RecordBuffer.Empty();
+	RecordedActorIds.Empty();
+}
+
+bool UCPP_CombatRecorderSubsystem::StartReplay(const FString& FilePath)
+{
+	if (Mode != EMode::Idle) return false;
+
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *FilePath)) return false;
+
+	FMemoryReader Reader(Data);
+	uint32 Magic = 0, Version = 0;
+	FString MapName;
+	Reader << Magic << Version << MapName;
+	if (Magic != CPP_CombatRecordingFile::Magic || Version != CPP_CombatRecordingFile::Version) return false;
+
+	if (MapName != UWorld::RemovePIEPrefix(GetWorld()->GetMapName()))
+		UE_LOG(LogTemp, Warning, TEXT("Combat recording %s was made on %s"), *FilePath, *MapName);
+
+	ReplayEvents.Reset();
+	while (!Reader.AtEnd() && !Reader.IsError())
+	{
+		FReplayEvent& Event = ReplayEvents.AddDefaulted_GetRef();
+		uint8 Type = 0;
+		Reader << Event.Frame << Type;
+		Event.Type = static_cast<EEventType>(Type);
+
+		switch (Event.Type)
+		{
+		case EEventType::ActorName:
+			Reader << Event.ActorId << Event.Path;
+			break;
+		case EEventType::ChangeWeapon:
+			Reader << Event.ActorId << Event.Value;
+			break;
+		case EEventType::TakeAttack:
+			Reader << Event.ActorId << Event.OtherActorId << Event.Value;
+			break;
+		case EEventType::RoundStart:
+			Reader << Event.Path << Event.Round;
+			break;
+		case EEventType::Spawn:
+			Reader << Event.ActorId << Event.Path << Event.Transform;
+			break;
+		default:
+			Reader.SetError();
+			break;
+		}
+	}
+	if (Reader.IsError()) return false;
+
+	Mode = EMode::Replaying;
+	Frame = 0;
+	ReplayPath = FilePath;
+	NextReplayEvent = 0;
+	ReplayActors.Reset();
+	RebuildReplayActorsByName();
+	FrameTimes.Reset();
+	LastFrameSeconds = FPlatformTime::Seconds();
+
+	bTimeStepOverridden = true;
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(ReplayDeltaTime);
+
+	UE_LOG(LogTemp, Display, TEXT("Replaying %d combat events from %s"), ReplayEvents.Num(), *ReplayPath);
+	return true;
+}
+
+void UCPP_CombatRecorderSubsystem::RecordChangeWeapon(ACPP_CharacterBase* Character, float ActionValue)
+{
+	if (Mode != EMode::Recording) return;
+
+	uint32 CharacterId = GetRecordedActorId(Character);
+	BeginEvent(EEventType::ChangeWeapon);
+	*RecordWriter << CharacterId << ActionValue;
+}
+
+void UCPP_CombatRecorderSubsystem::RecordTakeAttack(ACPP_CharacterBase* Target, AActor* Attacker, float Damage)
+{
+	if (Mode != EMode::Recording) return;
+
+	uint32 TargetId = GetRecordedActorId(Target);
+	uint32 AttackerId = GetRecordedActorId(Attacker);
+	BeginEvent(EEventType::TakeAttack);
+	*RecordWriter << TargetId << AttackerId << Damage;
+}
+
+void UCPP_CombatRecorderSubsystem::RecordRoundStart(U_CPP_RoundsConfigurations* Configurations, int32 Round)
+{
+	if (Mode != EMode::Recording || !Configurations) return;
+
+	FString ConfigurationsPath = Configurations->GetPathName();
+	BeginEvent(EEventType::RoundStart);
+	*RecordWriter << ConfigurationsPath << Round;
+}
+
+void UCPP_CombatRecorderSubsystem::RecordSpawn(ACPP_EnemyCharacterBase* Enemy, UClass* EnemyClass,
+                                               const FTransform& SpawnTransform)
+{
+	if (Mode != EMode::Recording || !Enemy || !EnemyClass) return;
+
+	// A pooled enemy is a new participant every time it spawns
+	uint32 EnemyId = NextActorId++;
+	RecordedActorIds.Add(Enemy, EnemyId);
+
+	FString ClassPath = EnemyClass->GetPathName();
+	FTransform Transform = SpawnTransform;
+	BeginEvent(EEventType::Spawn);
+	*RecordWriter << EnemyId << ClassPath << Transform;
+}
+
+void UCPP_CombatRecorderSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	FString FilePath;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ArenaReplay="), FilePath))
+	{
+		bExitAfterReplay = true;
+		if (!StartReplay(FilePath))
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to load combat recording %s"), *FilePath);
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+	else if (FParse::Value(FCommandLine::Get(), TEXT("ArenaRecord="), FilePath))
+	{
+		StartRecording(FilePath);
+	}
+}
+
+void UCPP_CombatRecorderSubsystem::Deinitialize()
+{
+	StopRecording();
+	RestoreTimeStep();
+	ReplayEvents.Empty();
+	ReplayActors.Empty();
+	ReplayActorsByName.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_CombatRecorderSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (Mode == EMode::Replaying)
+	{
+		const double Now = FPlatformTime::Seconds();
+		FrameTimes.Add(static_cast<float>((Now - LastFrameSeconds) * 1000.0));
+		LastFrameSeconds = Now;
+
+		bDispatchingReplay = true;
+		while (ReplayEvents.IsValidIndex(NextReplayEvent) && ReplayEvents[NextReplayEvent].Frame <= Frame)
+			DispatchReplayEvent(ReplayEvents[NextReplayEvent++]);
+		bDispatchingReplay = false;
+
+		const uint32 LastEventFrame = ReplayEvents.IsEmpty() ? 0 : ReplayEvents.Last().Frame;
+		if (NextReplayEvent >= ReplayEvents.Num() && Frame >= LastEventFrame + ReplaySettleFrames)
+		{
+			FinishReplay();
+			return;
+		}
+	}
+
+	if (Mode != EMode::Idle)
+		Frame++;
+}
+
+TStatId UCPP_CombatRecorderSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_CombatRecorderSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_CombatRecorderSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+uint32 UCPP_CombatRecorderSubsystem::GetRecordedActorId(AActor* Actor)
+{
+	if (!Actor) return 0;
+
+	if (const uint32* ActorId = RecordedActorIds.Find(Actor))
+		return *ActorId;
+
+	// Actors that were not spawned during the recording, such as the player, are found again by name
+	uint32 ActorId = NextActorId++;
+	RecordedActorIds.Add(Actor, ActorId);
+
+	FString ActorName = Actor->GetName();
+	BeginEvent(EEventType::ActorName);
+	*RecordWriter << ActorId << ActorName;
+
+	return ActorId;
+}
+
+void UCPP_CombatRecorderSubsystem::BeginEvent(EEventType Type)
+{
+	uint8 TypeValue = static_cast<uint8>(Type);
+	*RecordWriter << Frame << TypeValue;
+}
+
+void UCPP_CombatRecorderSubsystem::DispatchReplayEvent(const FReplayEvent& Event)
+{
+	switch (Event.Type)
+	{
+	case EEventType::ActorName:
+		{
+			AActor* Found = FindReplayActorByName(Event.Path);
+			if (!Found)
+				UE_LOG(LogTemp, Warning, TEXT("Combat replay: actor %s not found"), *Event.Path);
+			ReplayActors.Add(Event.ActorId, Found);
+			break;
+		}
+	case EEventType::ChangeWeapon:
+		if (ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(FindReplayActor(Event.ActorId)))
+			Character->ChangeWeapon(Event.Value);
+		break;
+	case EEventType::TakeAttack:
+		if (ACPP_CharacterBase* Target = Cast<ACPP_CharacterBase>(FindReplayActor(Event.ActorId)))
+			Target->TakeAttack(Cast<ACharacter>(FindReplayActor(Event.OtherActorId)), Event.Value);
+		break;
+	case EEventType::RoundStart:
+		{
+			// Only stream the round in; its spawns are replayed as separate events
+			U_CPP_RoundsConfigurations* Configurations = Cast<U_CPP_RoundsConfigurations>(
+				FSoftObjectPath(Event.Path).TryLoad());
+			UCPP_RoundStreamingSubsystem* RoundStreaming = GetWorld()->GetSubsystem<UCPP_RoundStreamingSubsystem>();
+			if (Configurations && RoundStreaming)
+				RoundStreaming->BeginRound(Configurations, Event.Round);
+			break;
+		}
+	case EEventType::Spawn:
+		{
+			UClass* EnemyClass = TSoftClassPtr<ACPP_EnemyCharacterBase>(FSoftObjectPath(Event.Path)).LoadSynchronous();
+			UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+			ReplayActors.Add(Event.ActorId, EnemyPool ? EnemyPool->SpawnEnemy(EnemyClass, Event.Transform) : nullptr);
+			break;
+		}
+	}
+}
+
+AActor* UCPP_CombatRecorderSubsystem::FindReplayActor(uint32 ActorId) const
+{
+	const TWeakObjectPtr<AActor>* Actor = ReplayActors.Find(ActorId);
+	return Actor ? Actor->Get() : nullptr;
+}
+
+AActor* UCPP_CombatRecorderSubsystem::FindReplayActorByName(const FString& Name)
+{
+	if (const TWeakObjectPtr<AActor>* Actor = ReplayActorsByName.Find(Name))
+		if (Actor->IsValid())
+			return Actor->Get();
+
+	// Spawned after the replay started
+	RebuildReplayActorsByName();
+
+	const TWeakObjectPtr<AActor>* Actor = ReplayActorsByName.Find(Name);
+	return Actor ? Actor->Get() : nullptr;
+}
+
+void UCPP_CombatRecorderSubsystem::RebuildReplayActorsByName()
+{
+	ReplayActorsByName.Reset();
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+		ReplayActorsByName.Add(It->GetName(), *It);
+}
+
+void UCPP_CombatRecorderSubsystem::RestoreTimeStep()
+{
+	if (!bTimeStepOverridden) return;
+
+	bTimeStepOverridden = false;
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+}
+
+void UCPP_CombatRecorderSubsystem::FinishReplay()
+{
+	Mode = EMode::Idle;
+	RestoreTimeStep();
+	ReplayActorsByName.Empty();
+
+	// The first frame includes the load of the replay and is left out
+	TArray<float> SortedFrameTimes(FrameTimes.GetData() + FMath::Min(1, FrameTimes.Num()),
+	                               FMath::Max(FrameTimes.Num() - 1, 0));
+	SortedFrameTimes.Sort();
+	auto Percentile = [&SortedFrameTimes](float Fraction)
+	{
+		if (SortedFrameTimes.IsEmpty()) return 0.0f;
+		return SortedFrameTimes[FMath::Clamp(FMath::FloorToInt32(Fraction * SortedFrameTimes.Num()), 0,
+		                                     SortedFrameTimes.Num() - 1)];
+	};
+
+	FString Report = TEXT("Frames,P50 ms,P90 ms,P99 ms,Max ms\n");
+	Report += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.3f\n\n"), SortedFrameTimes.Num(), Percentile(0.5f),
+	                          Percentile(0.9f), Percentile(0.99f), Percentile(1.0f));
+
+	UE_LOG(LogTemp, Display, TEXT("Combat replay: %d frames, P50 %.3f ms, P90 %.3f ms, P99 %.3f ms, max %.3f ms"),
+	       SortedFrameTimes.Num(), Percentile(0.5f), Percentile(0.9f), Percentile(0.99f), Percentile(1.0f));
+
+	Report += TEXT("Character,Health,Dead,Active\n");
+	for (TActorIterator<ACPP_CharacterBase> It(GetWorld()); It; ++It)
+	{
+		const ACPP_EnemyCharacterBase* Enemy = Cast<ACPP_EnemyCharacterBase>(*It);
+		const bool bActive = !Enemy || !Enemy->IsHidden();
+		Report += FString::Printf(TEXT("%s,%.2f,%d,%d\n"), *It->GetName(), It->GetHealth(), It->IsDead() ? 1 : 0,
+		                          bActive ? 1 : 0);
+		UE_LOG(LogTemp, Display, TEXT("Combat replay: %s health %.2f%s"), *It->GetName(), It->GetHealth(),
+		       It->IsDead() ? TEXT(" (dead)") : TEXT(""));
+	}
+
+	const FString ReportPath = ReplayPath + TEXT(".report.csv");
+	FFileHelper::SaveStringToFile(Report, *ReportPath);
+	UE_LOG(LogTemp, Display, TEXT("Combat replay report written to %s"), *ReportPath);
+
+	if (bExitAfterReplay)
+		FPlatformMisc::RequestExit(false);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CombatRecorderStartCommand(
+	TEXT("ArenaFighter.Recorder.Start"),
+	TEXT("Starts recording combat inputs. Usage: ArenaFighter.Recorder.Start [File]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCPP_CombatRecorderSubsystem* Recorder = World ? World->GetSubsystem<UCPP_CombatRecorderSubsystem>() : nullptr;
+		if (!Recorder) return;
+
+		Recorder->StartRecording(Args.Num() > 0
+			                         ? Args[0]
+			                         : FPaths::ProjectSavedDir() / TEXT("CombatRecordings")
+			                         / FString::Printf(TEXT("Combat-%s.bin"), *FDateTime::Now().ToString()));
+	}));
+
+static FAutoConsoleCommandWithWorld CombatRecorderStopCommand(
+	TEXT("ArenaFighter.Recorder.Stop"),
+	TEXT("Stops recording combat inputs and writes the file."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (UCPP_CombatRecorderSubsystem* Recorder = World ? World->GetSubsystem<UCPP_CombatRecorderSubsystem>() : nullptr)
+			Recorder->StopRecording();
+	}));
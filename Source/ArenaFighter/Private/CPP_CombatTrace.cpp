@@ -0,0 +1,267 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_CombatTrace.h"
+
+#include "ArenaFighter.h"
+#include "HAL/FileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include <atomic>
+
+static TAutoConsoleVariable<bool> CVarVerboseCombatLog(
+	TEXT("ArenaFighter.VerboseCombatLog"),
+	false,
+	TEXT("Print combat events (state changes, damage, deaths, targets, detection) to the screen and the log."));
+
+namespace CPP_CombatTraceFile
+{
+	static constexpr uint32 Magic = 0x54434641; // "AFCT"
+	static constexpr uint32 Version = 2;
+
+	/** Key of a record name in the file's name table. */
+	uint64 GetNameKey(const FMinimalName& Name)
+	{
+		return uint64(Name.Index.ToUnstableInt()) << 32 | uint32(Name.Number);
+	}
+}
+
+#if ARENAFIGHTER_COMBAT_TRACE
+
+DECLARE_MEMORY_STAT(TEXT("Combat Trace Rings"), STAT_CombatTraceMemory, STATGROUP_ArenaFighter);
+
+namespace
+{
+	/** Ring of one thread. Only the owning thread writes; Dump reads it from the game thread. */
+	struct FThreadRing
+	{
+		std::atomic<uint64> WriteIndex{0};
+		FCPP_CombatTraceRecord Records[FCPP_CombatTrace::RecordsPerThread];
+	};
+
+	static_assert((FCPP_CombatTrace::RecordsPerThread & (FCPP_CombatTrace::RecordsPerThread - 1)) == 0,
+	              "RecordsPerThread must be a power of two");
+
+	FCriticalSection RingsLock;
+	TArray<TUniquePtr<FThreadRing>> Rings;
+	thread_local FThreadRing* ThreadRing = nullptr;
+
+	FThreadRing& GetThreadRing()
+	{
+		if (!ThreadRing)
+		{
+			FScopeLock Lock(&RingsLock);
+			ThreadRing = Rings.Add_GetRef(MakeUnique<FThreadRing>()).Get();
+			INC_MEMORY_STAT_BY(STAT_CombatTraceMemory, sizeof(FThreadRing));
+		}
+		return *ThreadRing;
+	}
+
+	FMinimalName GetObjectName(const UObject* Object)
+	{
+		return Object ? FMinimalName(Object->GetFName()) : FMinimalName();
+	}
+
+	/** Copies the records of a ring, dropping the ones the owner overwrote while they were copied. */
+	void CopyRing(const FThreadRing& Ring, TArray<FCPP_CombatTraceRecord>& OutRecords)
+	{
+		constexpr uint64 Capacity = FCPP_CombatTrace::RecordsPerThread;
+
+		const uint64 End = Ring.WriteIndex.load(std::memory_order_acquire);
+		const uint64 Begin = End > Capacity ? End - Capacity : 0;
+
+		const int32 FirstCopied = OutRecords.Num();
+		for (uint64 Index = Begin; Index < End; ++Index)
+			OutRecords.Add(Ring.Records[Index & (Capacity - 1)]);
+
+		const uint64 EndAfterCopy = Ring.WriteIndex.load(std::memory_order_acquire);
+		const uint64 FirstIntact = EndAfterCopy > Capacity ? EndAfterCopy - Capacity : 0;
+		if (FirstIntact > Begin)
+			OutRecords.RemoveAt(FirstCopied, static_cast<int32>(FMath::Min(FirstIntact, End) - Begin), EAllowShrinking::No);
+	}
+}
+
+void FCPP_CombatTrace::Write(ECPP_CombatEvent Event, const UObject* Subject, const UObject* Other, float Value)
+{
+	FThreadRing& Ring = GetThreadRing();
+	const uint64 Index = Ring.WriteIndex.load(std::memory_order_relaxed);
+
+	FCPP_CombatTraceRecord& Record = Ring.Records[Index & (RecordsPerThread - 1)];
+	Record.Cycles = FPlatformTime::Cycles64();
+	Record.Frame = static_cast<uint32>(GFrameCounter);
+	Record.Subject = GetObjectName(Subject);
+	Record.Other = GetObjectName(Other);
+	Record.Value = Value;
+	Record.Event = Event;
+
+	Ring.WriteIndex.store(Index + 1, std::memory_order_release);
+}
+
+bool FCPP_CombatTrace::Dump(const FString& FilePath)
+{
+	TArray<FCPP_CombatTraceRecord> Records;
+	{
+		FScopeLock Lock(&RingsLock);
+		for (const TUniquePtr<FThreadRing>& Ring : Rings)
+			CopyRing(*Ring, Records);
+	}
+
+	Records.StableSort([](const FCPP_CombatTraceRecord& A, const FCPP_CombatTraceRecord& B) { return A.Cycles < B.Cycles; });
+
+	// Name indices only mean something in this process, so the file carries their text
+	TMap<uint64, FString> Names;
+	auto AddName = [&Names](const FMinimalName& Name)
+	{
+		const uint64 Key = CPP_CombatTraceFile::GetNameKey(Name);
+		if (!Name.IsNone() && !Names.Contains(Key))
+			Names.Add(Key, FName(Name).ToString());
+	};
+	for (const FCPP_CombatTraceRecord& Record : Records)
+	{
+		AddName(Record.Subject);
+		AddName(Record.Other);
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Writer) return false;
+
+	uint32 Magic = CPP_CombatTraceFile::Magic;
+	uint32 Version = CPP_CombatTraceFile::Version;
+	double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+	uint32 NumRecords = Records.Num();
+	uint32 NumNames = Names.Num();
+	*Writer << Magic << Version << SecondsPerCycle << NumRecords << NumNames;
+
+	Writer->Serialize(Records.GetData(), Records.Num() * sizeof(FCPP_CombatTraceRecord));
+
+	for (TPair<uint64, FString>& Name : Names)
+		*Writer << Name.Key << Name.Value;
+
+	return Writer->Close();
+}
+
+static FAutoConsoleCommand CombatTraceDumpCommand(
+	TEXT("ArenaFighter.CombatTrace.Dump"),
+	TEXT("Writes the combat trace to a binary file. Usage: ArenaFighter.CombatTrace.Dump [File]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const FString FilePath = Args.Num() > 0
+			                         ? Args[0]
+			                         : FPaths::ProjectSavedDir() / TEXT("CombatTrace")
+			                         / FString::Printf(TEXT("CombatTrace-%s.bin"), *FDateTime::Now().ToString());
+
+		if (FCPP_CombatTrace::Dump(FilePath))
+		{
+			UE_LOG(LogTemp, Display, TEXT("Combat trace written to %s"), *FilePath);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to write combat trace to %s"), *FilePath);
+		}
+	}));
+
+#else
+
+void FCPP_CombatTrace::Write(ECPP_CombatEvent Event, const UObject* Subject, const UObject* Other, float Value)
+{
+}
+
+bool FCPP_CombatTrace::Dump(const FString& FilePath)
+{
+	return false;
+}
+
+static FAutoConsoleCommand CombatTraceDumpCommand(
+	TEXT("ArenaFighter.CombatTrace.Dump"),
+	TEXT("Writes the combat trace to a binary file. The trace is compiled out of this build."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The combat trace is disabled in this build, rebuild with ARENAFIGHTER_COMBAT_TRACE=1 to record it"));
+	}));
+
+#endif
+
+bool FCPP_CombatTrace::Decode(const FString& FilePath, const FString& OutFilePath)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Reader) return false;
+
+	uint32 Magic = 0, Version = 0, NumRecords = 0, NumNames = 0;
+	double SecondsPerCycle = 0.0;
+	*Reader << Magic << Version << SecondsPerCycle << NumRecords << NumNames;
+	if (Magic != CPP_CombatTraceFile::Magic || Version != CPP_CombatTraceFile::Version) return false;
+
+	TArray<FCPP_CombatTraceRecord> Records;
+	Records.SetNumUninitialized(NumRecords);
+	Reader->Serialize(Records.GetData(), NumRecords * sizeof(FCPP_CombatTraceRecord));
+
+	TMap<uint64, FString> Names;
+	for (uint32 Index = 0; Index < NumNames && !Reader->IsError(); ++Index)
+	{
+		uint64 Key = 0;
+		FString Name;
+		*Reader << Key << Name;
+		Names.Add(Key, MoveTemp(Name));
+	}
+	if (Reader->IsError()) return false;
+
+	auto GetName = [&Names](const FMinimalName& Name)
+	{
+		if (Name.IsNone()) return FString(TEXT("-"));
+
+		const FString* Text = Names.Find(CPP_CombatTraceFile::GetNameKey(Name));
+		return Text ? *Text : FString::Printf(TEXT("#%llx"), CPP_CombatTraceFile::GetNameKey(Name));
+	};
+
+	FString Text = TEXT("Frame,Seconds,Event,Subject,Other,Value\n");
+	const uint64 FirstCycles = Records.IsEmpty() ? 0 : Records[0].Cycles;
+	for (const FCPP_CombatTraceRecord& Record : Records)
+		Text += FString::Printf(TEXT("%u,%.6f,%s,%s,%s,%g\n"), Record.Frame,
+		                        (Record.Cycles - FirstCycles) * SecondsPerCycle, GetEventName(Record.Event),
+		                        *GetName(Record.Subject), *GetName(Record.Other), Record.Value);
+
+	return FFileHelper::SaveStringToFile(Text, *OutFilePath);
+}
+
+static FAutoConsoleCommand CombatTraceDecodeCommand(
+	TEXT("ArenaFighter.CombatTrace.Decode"),
+	TEXT("Decodes a combat trace file to CSV text. Usage: ArenaFighter.CombatTrace.Decode File [OutFile]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Usage: ArenaFighter.CombatTrace.Decode File [OutFile]"));
+			return;
+		}
+
+		const FString OutFilePath = Args.Num() > 1 ? Args[1] : FPaths::ChangeExtension(Args[0], TEXT("csv"));
+		if (FCPP_CombatTrace::Decode(Args[0], OutFilePath))
+		{
+			UE_LOG(LogTemp, Display, TEXT("Combat trace decoded to %s"), *OutFilePath);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Failed to decode combat trace %s"), *Args[0]);
+		}
+	}));
+
+bool FCPP_CombatTrace::IsVerbose()
+{
+	return CVarVerboseCombatLog.GetValueOnAnyThread();
+}
+
+const TCHAR* FCPP_CombatTrace::GetEventName(ECPP_CombatEvent Event)
+{
+	switch (Event)
+	{
+	case ECPP_CombatEvent::StateEnter: return TEXT("StateEnter");
+	case ECPP_CombatEvent::StateExit: return TEXT("StateExit");
+	case ECPP_CombatEvent::Damage: return TEXT("Damage");
+	case ECPP_CombatEvent::Death: return TEXT("Death");
+	case ECPP_CombatEvent::TargetChanged: return TEXT("TargetChanged");
+	case ECPP_CombatEvent::Detected: return TEXT("Detected");
+	case ECPP_CombatEvent::LostSight: return TEXT("LostSight");
+	default: return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_CrowdMovementProcessor.h"
+
+#include "CPP_CrowdFragments.h"
+#include "MassExecutionContext.h"
+
+UCPP_CrowdMovementProcessor::UCPP_CrowdMovementProcessor()
+{
+	// Run explicitly by UCPP_CrowdSubsystem
+	bAutoRegisterWithProcessingPhases = false;
+	ExecutionFlags = static_cast<int32>(EProcessorExecutionFlags::All);
+}
+
+void UCPP_CrowdMovementProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FCPP_CrowdTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.RegisterWithProcessor(*this);
+}
+
+void UCPP_CrowdMovementProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	const float StopRadiusSquared = FMath::Square(StopRadius);
+	const float PromotionRadiusSquared = FMath::Square(PromotionRadius);
+
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [this, StopRadiusSquared, PromotionRadiusSquared]
+	                               (FMassExecutionContext& ChunkContext)
+	{
+		const TArrayView<FCPP_CrowdTransformFragment> Transforms =
+			ChunkContext.GetMutableFragmentView<FCPP_CrowdTransformFragment>();
+		const float Step = Speed * ChunkContext.GetDeltaTimeSeconds();
+
+		for (int32 Index = 0; Index < ChunkContext.GetNumEntities(); ++Index)
+		{
+			FCPP_CrowdTransformFragment& Transform = Transforms[Index];
+
+			const FVector ToTarget = FVector(Target.X - Transform.Location.X, Target.Y - Transform.Location.Y, 0.0f);
+			const float DistanceSquared = ToTarget.SizeSquared();
+			if (DistanceSquared > StopRadiusSquared)
+			{
+				const float Distance = FMath::Sqrt(DistanceSquared);
+				Transform.Location += ToTarget * (FMath::Min(Step, Distance) / Distance);
+				Transform.Yaw = FMath::RadiansToDegrees(FMath::Atan2(ToTarget.Y, ToTarget.X));
+			}
+
+			InstanceTransforms.Emplace(FRotator(0.0f, Transform.Yaw, 0.0f), Transform.Location);
+
+			if (FVector::DistSquared(Transform.Location, PlayerLocation) <= PromotionRadiusSquared)
+				PromotionCandidates.Add(ChunkContext.GetEntity(Index));
+		}
+	});
+}
@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_CrowdSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CrowdFragments.h"
+#include "CPP_CrowdMovementProcessor.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/PlayerController.h"
+#include "MassEntitySubsystem.h"
+#include "MassExecutor.h"
+
+DECLARE_CYCLE_STAT(TEXT("Crowd Update"), STAT_CrowdUpdate, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Entities"), STAT_CrowdEntities, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crowd Promoted"), STAT_CrowdPromoted, STATGROUP_ArenaFighter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Promotions"), STAT_CrowdPromotions, STATGROUP_ArenaFighter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Crowd Demotions"), STAT_CrowdDemotions, STATGROUP_ArenaFighter);
+
+void UCPP_CrowdSubsystem::SpawnCrowd(TConstArrayView<TSoftClassPtr<ACPP_EnemyCharacterBase>> Classes,
+                                     TConstArrayView<FTransform> Transforms, TSharedPtr<FStreamableHandle> LoadHandle)
+{
+	const int32 Count = FMath::Min(Classes.Num(), Transforms.Num());
+	if (Count <= 0 || !EnsureCrowdSetUp()) return;
+
+	if (!LoadHandle.IsValid())
+	{
+		TArray<FSoftObjectPath> AssetPaths;
+		for (int32 Index = 0; Index < Count; ++Index)
+			if (!Classes[Index].IsNull())
+				AssetPaths.AddUnique(Classes[Index].ToSoftObjectPath());
+		GetAssetsToLoad(AssetPaths);
+
+		if (!AssetPaths.IsEmpty())
+			LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetPaths, FStreamableDelegate());
+	}
+
+	if (LoadHandle.IsValid())
+		LoadHandles.Add(LoadHandle);
+
+	FMassEntityManager& EntityManager = GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+
+	NewEntities.Reset();
+	EntityManager.BatchCreateEntities(CrowdArchetype, Count, NewEntities);
+
+	for (int32 Index = 0; Index < NewEntities.Num(); ++Index)
+	{
+		FCPP_CrowdTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FCPP_CrowdTransformFragment>(NewEntities[Index]);
+		Transform.Location = Transforms[Index].GetLocation();
+		Transform.Yaw = Transforms[Index].Rotator().Yaw;
+
+		EntityManager.GetFragmentDataChecked<FCPP_CrowdEnemyFragment>(NewEntities[Index]).EnemyClassIndex =
+			EnemyClasses.AddUnique(Classes[Index]);
+	}
+
+	NumEntities += NewEntities.Num();
+}
+
+void UCPP_CrowdSubsystem::GetAssetsToLoad(TArray<FSoftObjectPath>& OutAssetPaths) const
+{
+	if (!CrowdMesh.IsNull())
+		OutAssetPaths.AddUnique(CrowdMesh.ToSoftObjectPath());
+}
+
+void UCPP_CrowdSubsystem::ClearCrowd()
+{
+	if (!CrowdArchetype.IsValid()) return;
+
+	FMassEntityManager& EntityManager = GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+	EntityManager.BatchDestroyEntityChunks(FMassArchetypeEntityCollection(CrowdArchetype));
+	NumEntities = 0;
+
+	UpdateInstances(TArray<FTransform>());
+}
+
+void UCPP_CrowdSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	EnsureCrowdSetUp();
+}
+
+void UCPP_CrowdSubsystem::Deinitialize()
+{
+	// Entities go away with the world's entity manager
+	PromotedEnemies.Empty();
+	EnemyClasses.Empty();
+	LoadHandles.Empty();
+	ReportedMissingClasses.Empty();
+	NewEntities.Empty();
+	MovementProcessor = nullptr;
+	CrowdActor = nullptr;
+	CrowdInstances = nullptr;
+	NumEntities = 0;
+
+	Super::Deinitialize();
+}
+
+void UCPP_CrowdSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!MovementProcessor) return;
+
+	// The last crowd enemy is gone, let its classes unload
+	if (NumEntities == 0 && PromotedEnemies.IsEmpty())
+	{
+		LoadHandles.Reset();
+		return;
+	}
+
+	CPP_PROFILE_SCOPE(CrowdUpdate);
+
+	ApplyCrowdMesh();
+
+	FVector PlayerLocation;
+	const bool bHasPlayer = GetPlayerLocation(PlayerLocation);
+
+	MovementProcessor->Target = ArenaCenter;
+	MovementProcessor->Speed = MoveSpeed;
+	MovementProcessor->StopRadius = ArenaCenterStopRadius;
+	MovementProcessor->PlayerLocation = PlayerLocation;
+	MovementProcessor->PromotionRadius = bHasPlayer ? PromotionRadius : 0.0f;
+	MovementProcessor->InstanceTransforms.Reset();
+	MovementProcessor->PromotionCandidates.Reset();
+
+	FMassEntityManager& EntityManager = GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+	FMassProcessingContext ProcessingContext(EntityManager, DeltaTime);
+	UE::Mass::Executor::Run(*MovementProcessor, ProcessingContext);
+
+	if (bHasPlayer)
+	{
+		PromoteCandidates(MovementProcessor->PromotionCandidates);
+		DemoteFarEnemies(PlayerLocation);
+	}
+
+	// Instances were gathered before promotion, so an enemy promoted this frame keeps its instance
+	// under the actor until the next update
+	UpdateInstances(MovementProcessor->InstanceTransforms);
+
+	SET_DWORD_STAT(STAT_CrowdEntities, NumEntities);
+	SET_DWORD_STAT(STAT_CrowdPromoted, PromotedEnemies.Num());
+	CSV_CUSTOM_STAT(ArenaFighter, CrowdEntities, NumEntities, ECsvCustomStatOp::Set);
+}
+
+TStatId UCPP_CrowdSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_CrowdSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_CrowdSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UCPP_CrowdSubsystem::EnsureCrowdSetUp()
+{
+	if (MovementProcessor) return true;
+
+	UMassEntitySubsystem* EntitySubsystem = GetWorld()->GetSubsystem<UMassEntitySubsystem>();
+	if (!EntitySubsystem)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No MassEntity subsystem, the enemy crowd is disabled"));
+		return false;
+	}
+
+	const UScriptStruct* Fragments[] = {
+		FCPP_CrowdTransformFragment::StaticStruct(),
+		FCPP_CrowdHealthFragment::StaticStruct(),
+		FCPP_CrowdEnemyFragment::StaticStruct()
+	};
+	CrowdArchetype = EntitySubsystem->GetMutableEntityManager().CreateArchetype(Fragments, TEXT("ArenaFighterCrowd"));
+
+	MovementProcessor = NewObject<UCPP_CrowdMovementProcessor>(this);
+	MovementProcessor->CallInitialize(this);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+	CrowdActor = GetWorld()->SpawnActor<AActor>(SpawnParameters);
+	if (CrowdActor)
+	{
+		CrowdInstances = NewObject<UInstancedStaticMeshComponent>(CrowdActor, TEXT("CrowdInstances"));
+		CrowdInstances->SetStaticMesh(CrowdMesh.Get());
+		CrowdInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		CrowdInstances->SetCanEverAffectNavigation(false);
+		CrowdActor->SetRootComponent(CrowdInstances);
+		CrowdInstances->RegisterComponent();
+	}
+
+	if (CrowdMesh.IsNull())
+		UE_LOG(LogTemp, Warning, TEXT("UCPP_CrowdSubsystem has no CrowdMesh configured, crowd enemies are invisible"));
+
+	return true;
+}
+
+void UCPP_CrowdSubsystem::ApplyCrowdMesh()
+{
+	if (!CrowdInstances || CrowdInstances->GetStaticMesh()) return;
+
+	if (UStaticMesh* Mesh = CrowdMesh.Get())
+		CrowdInstances->SetStaticMesh(Mesh);
+}
+
+bool UCPP_CrowdSubsystem::GetPlayerLocation(FVector& OutLocation) const
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const APawn* Player = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (!Player) return false;
+
+	OutLocation = Player->GetActorLocation();
+	return true;
+}
+
+void UCPP_CrowdSubsystem::PromoteCandidates(const TArray<FMassEntityHandle>& Candidates)
+{
+	if (Candidates.IsEmpty()) return;
+
+	FMassEntityManager& EntityManager = GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+	UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+
+	int32 Promotions = 0;
+	for (const FMassEntityHandle& Entity : Candidates)
+	{
+		if (Promotions >= MaxPromotionsPerFrame) break;
+		if (!EntityManager.IsEntityValid(Entity)) continue;
+
+		const int32 EnemyClassIndex = EntityManager.GetFragmentDataChecked<FCPP_CrowdEnemyFragment>(Entity).EnemyClassIndex;
+		UClass* EnemyClass = EnemyClasses.IsValidIndex(EnemyClassIndex) ? EnemyClasses[EnemyClassIndex].Get() : nullptr;
+		if (!EnemyClass)
+		{
+			// Still loading, the enemy waits in the crowd; a class whose load is over could not be loaded
+			const bool bLoading = LoadHandles.ContainsByPredicate([](const TSharedPtr<FStreamableHandle>& Handle)
+			{
+				return Handle->IsLoadingInProgress();
+			});
+			if (!bLoading && !ReportedMissingClasses.Contains(EnemyClassIndex))
+			{
+				ReportedMissingClasses.Add(EnemyClassIndex);
+				UE_LOG(LogTemp, Error, TEXT("Crowd enemy class %s could not be loaded, its crowd enemies are not promoted"),
+				       EnemyClasses.IsValidIndex(EnemyClassIndex) ? *EnemyClasses[EnemyClassIndex].ToString() : TEXT("None"));
+			}
+			continue;
+		}
+
+		const FCPP_CrowdTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FCPP_CrowdTransformFragment>(Entity);
+		const FTransform SpawnTransform(FRotator(0.0f, Transform.Yaw, 0.0f), Transform.Location);
+		const float Health = EntityManager.GetFragmentDataChecked<FCPP_CrowdHealthFragment>(Entity).Health;
+
+		ACPP_EnemyCharacterBase* Enemy = nullptr;
+		if (EnemyPool)
+			Enemy = EnemyPool->SpawnEnemy(EnemyClass, SpawnTransform);
+		else
+		{
+			FActorSpawnParameters spawnParameters;
+			spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+			Enemy = GetWorld()->SpawnActor<ACPP_EnemyCharacterBase>(EnemyClass, SpawnTransform, spawnParameters);
+		}
+		if (!Enemy) continue;
+
+		if (Health >= 0.0f)
+			Enemy->SetHealth(Health);
+
+		FPromotedEnemy& Promoted = PromotedEnemies.AddDefaulted_GetRef();
+		Promoted.Enemy = Enemy;
+		Promoted.EnemyClassIndex = EnemyClassIndex;
+
+		EntityManager.DestroyEntity(Entity);
+		NumEntities--;
+		Promotions++;
+		INC_DWORD_STAT(STAT_CrowdPromotions);
+	}
+}
+
+void UCPP_CrowdSubsystem::DemoteFarEnemies(const FVector& PlayerLocation)
+{
+	FMassEntityManager& EntityManager = GetWorld()->GetSubsystem<UMassEntitySubsystem>()->GetMutableEntityManager();
+	UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+	const float DemotionRadiusSquared = FMath::Square(DemotionRadius);
+
+	for (int32 Index = PromotedEnemies.Num() - 1; Index >= 0; --Index)
+	{
+		ACPP_EnemyCharacterBase* Enemy = PromotedEnemies[Index].Enemy.Get();
+
+		// Dead enemies finish their death sequence and return to the pool on their own
+		if (!Enemy || Enemy->IsHidden() || Enemy->IsDead())
+		{
+			PromotedEnemies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+
+		if (FVector::DistSquared(Enemy->GetActorLocation(), PlayerLocation) <= DemotionRadiusSquared) continue;
+
+		const FMassEntityHandle Entity = EntityManager.CreateEntity(CrowdArchetype);
+
+		FCPP_CrowdTransformFragment& Transform = EntityManager.GetFragmentDataChecked<FCPP_CrowdTransformFragment>(Entity);
+		Transform.Location = Enemy->GetActorLocation();
+		Transform.Yaw = Enemy->GetActorRotation().Yaw;
+		EntityManager.GetFragmentDataChecked<FCPP_CrowdHealthFragment>(Entity).Health = Enemy->GetHealth();
+		EntityManager.GetFragmentDataChecked<FCPP_CrowdEnemyFragment>(Entity).EnemyClassIndex = PromotedEnemies[Index].EnemyClassIndex;
+		NumEntities++;
+
+		if (EnemyPool)
+			EnemyPool->ReleaseEnemy(Enemy);
+		else
+			Enemy->Destroy();
+
+		PromotedEnemies.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+		INC_DWORD_STAT(STAT_CrowdDemotions);
+	}
+}
+
+void UCPP_CrowdSubsystem::UpdateInstances(const TArray<FTransform>& Transforms)
+{
+	if (!CrowdInstances) return;
+
+	// Only the difference in count is added or removed, the rest is moved in place
+	const int32 InstanceCount = CrowdInstances->GetInstanceCount();
+	if (InstanceCount < Transforms.Num())
+	{
+		TArray<FTransform> AddedTransforms(Transforms.GetData() + InstanceCount, Transforms.Num() - InstanceCount);
+		CrowdInstances->AddInstances(AddedTransforms, false, false, false);
+	}
+	else if (InstanceCount > Transforms.Num())
+	{
+		// Removing from the back, highest index first, keeps the remaining indices unchanged
+		TArray<int32> RemovedInstances;
+		RemovedInstances.Reserve(InstanceCount - Transforms.Num());
+		for (int32 Index = InstanceCount - 1; Index >= Transforms.Num(); --Index)
+			RemovedInstances.Add(Index);
+		CrowdInstances->RemoveInstances(RemovedInstances);
+	}
+
+	if (!Transforms.IsEmpty())
+		CrowdInstances->BatchUpdateInstancesTransforms(0, Transforms, false, true, false);
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_DamageSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CharacterBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("ResolvePendingAttacks"), STAT_ResolvePendingAttacks, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attacks Resolved"), STAT_AttacksResolved, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damaged Targets"), STAT_DamagedTargets, STATGROUP_ArenaFighter);
+
+bool UCPP_DamageSubsystem::QueueAttack(ACPP_CharacterBase* Target, ACharacter* Attacker, float Damage)
+{
+	if (!bBatchDamage) return false;
+
+	FPendingAttack& Attack = PendingAttacks.AddDefaulted_GetRef();
+	Attack.Target = Target;
+	Attack.Attacker = Attacker;
+	Attack.Damage = Damage;
+
+	return true;
+}
+
+void UCPP_DamageSubsystem::DiscardAttacks(const ACPP_CharacterBase* Target)
+{
+	PendingAttacks.RemoveAll([Target](const FPendingAttack& Attack) { return Attack.Target.Get() == Target; });
+}
+
+void UCPP_DamageSubsystem::ResolvePendingAttacks()
+{
+	if (PendingAttacks.IsEmpty()) return;
+
+	CPP_PROFILE_SCOPE_BUCKET(ResolvePendingAttacks, Damage);
+
+	// Hits queued by the damage and death handlers below go to the fresh PendingAttacks array
+	Swap(PendingAttacks, ResolvingAttacks);
+
+	for (const FPendingAttack& Attack : ResolvingAttacks)
+	{
+		ACPP_CharacterBase* Target = Attack.Target.Get();
+		if (!Target) continue;
+
+		ACharacter* Attacker = Attack.Attacker.Get();
+
+		int32& TargetIndex = TargetIndices.FindOrAdd(Target, INDEX_NONE);
+		if (TargetIndex == INDEX_NONE)
+		{
+			TargetIndex = Targets.AddDefaulted();
+			Targets[TargetIndex].Target = Target;
+		}
+
+		FTargetDamage& TargetDamage = Targets[TargetIndex];
+		TargetDamage.Damage += Attack.Damage;
+		TargetDamage.LastAttacker = Attacker;
+		TargetDamage.Hits++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_AttacksResolved, ResolvingAttacks.Num());
+	INC_DWORD_STAT_BY(STAT_DamagedTargets, Targets.Num());
+	CSV_CUSTOM_STAT(ArenaFighter, AttacksResolved, ResolvingAttacks.Num(), ECsvCustomStatOp::Set);
+
+	ResolvingAttacks.Reset();
+	TargetIndices.Reset();
+
+	for (const FTargetDamage& TargetDamage : Targets)
+		if (IsValid(TargetDamage.Target))
+			TargetDamage.Target->ApplyBatchedDamage(TargetDamage.Damage, TargetDamage.Hits, TargetDamage.LastAttacker);
+
+	Targets.Reset();
+}
+
+void UCPP_DamageSubsystem::Deinitialize()
+{
+	PendingAttacks.Empty();
+	ResolvingAttacks.Empty();
+	Targets.Empty();
+	TargetIndices.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_DamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ResolvePendingAttacks();
+}
+
+TStatId UCPP_DamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_DamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_DamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -3,3 +3,154 @@
 
 #include "CPP_EnemyCharacterBase.h"
 
+#include "AIController.h"
+#include "CPP_AttackTokenSubsystem.h"
+#include "CPP_EnemyDecisionSubsystem.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_EnemySignificanceSubsystem.h"
+#include "CPP_PerceptionSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
+
+void ACPP_EnemyCharacterBase::ActivateFromPool(const FTransform& SpawnTransform)
+{
+	GetWorldTimerManager().ClearTimer(ReturnToPoolTimerHandle);
+
+	SetActorTransform(SpawnTransform, false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorEnableCollision(true);
+	GetCharacterMovement()->SetDefaultMovementMode();
+
+	// Also restores the actor tick for the reasons that still apply
+	ResetCharacterState();
+	RegisterWithWorldSubsystems();
+	EquipSelectedWeapon();
+
+	if (PooledController)
+		PooledController->Possess(this);
+	else
+		SpawnDefaultController();
+	PooledController = nullptr;
+
+	OnTakenFromPool();
+}
+
+void ACPP_EnemyCharacterBase::DeactivateToPool()
+{
+	GetWorldTimerManager().ClearTimer(ReturnToPoolTimerHandle);
+
+	PooledController = GetController();
+	if (PooledController)
+		PooledController->UnPossess();
+
+	// Also stops perception and line-of-sight traces for the enemy and towards it until it is activated again
+	UnregisterFromWorldSubsystems();
+	UnequipWeapon();
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	SetActorTickEnabled(false);
+	SetActorEnableCollision(false);
+	SetActorHiddenInGame(true);
+}
+
+void ACPP_EnemyCharacterBase::ApplySignificanceBucket(const FCPP_SignificanceBucket& Bucket)
+{
+	SetActorTickInterval(Bucket.TickInterval);
+	GetCharacterMovement()->SetComponentTickInterval(Bucket.TickInterval);
+
+	if (UCPP_PerceptionSubsystem* Perception = GetWorld()->GetSubsystem<UCPP_PerceptionSubsystem>())
+		Perception->SetIntervalScale(this, Bucket.SensingIntervalScale);
+
+	if (USkeletalMeshComponent* SkeletalMesh = GetMesh())
+	{
+		SkeletalMesh->bEnableUpdateRateOptimizations = Bucket.AnimationFrameSkip > 0;
+
+		// Force the bucket's frame skip on every LOD instead of the engine's distance-based choice
+		if (FAnimUpdateRateParameters* UpdateRateParams = SkeletalMesh->AnimUpdateRateParams)
+		{
+			UpdateRateParams->bShouldUseLodMap = true;
+			UpdateRateParams->LODToFrameSkipMap.Reset();
+			for (int32 LODIndex = 0; LODIndex < MAX_SKELETAL_MESH_LODS; ++LODIndex)
+				UpdateRateParams->LODToFrameSkipMap.Add(LODIndex, Bucket.AnimationFrameSkip);
+		}
+	}
+}
+
+void ACPP_EnemyCharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(ReturnToPoolTimerHandle);
+
+	// A pooled controller is not possessing anything, so nothing else would clean it up
+	if (PooledController)
+	{
+		PooledController->Destroy();
+		PooledController = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACPP_EnemyCharacterBase::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// The controller's Blueprint runs its own tree after this, the native tree replaces it afterwards
+	if (bRunNativeBehaviorTree && Cast<AAIController>(NewController))
+		NewController->OnPossessedPawnChanged.AddUniqueDynamic(this, &ACPP_EnemyCharacterBase::HandlePossessedPawnChanged);
+}
+
+void ACPP_EnemyCharacterBase::HandlePossessedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	AAIController* AIController = Cast<AAIController>(GetController());
+	if (!AIController) return;
+
+	AIController->OnPossessedPawnChanged.RemoveDynamic(this, &ACPP_EnemyCharacterBase::HandlePossessedPawnChanged);
+	if (NewPawn != this) return;
+
+	UCPP_EnemyDecisionSubsystem* Decisions = GetWorld()->GetSubsystem<UCPP_EnemyDecisionSubsystem>();
+	if (UBehaviorTree* NativeTree = Decisions ? Decisions->GetNativeTree() : nullptr)
+		AIController->RunBehaviorTree(NativeTree);
+}
+
+bool ACPP_EnemyCharacterBase::RequestAttackToken(AActor* Target)
+{
+	UCPP_AttackTokenSubsystem* AttackTokens = GetWorld()->GetSubsystem<UCPP_AttackTokenSubsystem>();
+	return !AttackTokens || AttackTokens->RequestToken(this, Target);
+}
+
+void ACPP_EnemyCharacterBase::Die()
+{
+	Super::Die();
+
+	if (UCPP_AttackTokenSubsystem* AttackTokens = GetWorld()->GetSubsystem<UCPP_AttackTokenSubsystem>())
+		AttackTokens->ReleaseTokens(this);
+
+	if (bIsPooled)
+		GetWorldTimerManager().SetTimer(ReturnToPoolTimerHandle, this, &ACPP_EnemyCharacterBase::ReturnToPool,
+		                                ReturnToPoolDelay, false);
+}
+
+void ACPP_EnemyCharacterBase::RegisterWithWorldSubsystems()
+{
+	Super::RegisterWithWorldSubsystems();
+
+	if (UCPP_EnemySignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCPP_EnemySignificanceSubsystem>())
+		Significance->Register(this);
+}
+
+void ACPP_EnemyCharacterBase::UnregisterFromWorldSubsystems()
+{
+	if (UCPP_EnemySignificanceSubsystem* Significance = GetWorld()->GetSubsystem<UCPP_EnemySignificanceSubsystem>())
+		Significance->Unregister(this);
+
+	if (UCPP_AttackTokenSubsystem* AttackTokens = GetWorld()->GetSubsystem<UCPP_AttackTokenSubsystem>())
+		AttackTokens->ReleaseTokens(this);
+
+	Super::UnregisterFromWorldSubsystems();
+}
+
+void ACPP_EnemyCharacterBase::ReturnToPool()
+{
+	if (UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>())
+		EnemyPool->ReleaseEnemy(this);
+}
@@ -0,0 +1,297 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_EnemyDecisionSubsystem.h"
+
+#include "AIController.h"
+#include "Animation/AnimMontage.h"
+#include "ArenaFighter.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Bool.h"
+#include "BehaviorTree/Blackboard/BlackboardKeyType_Object.h"
+#include "BehaviorTree/Composites/BTComposite_Selector.h"
+#include "BehaviorTree/Composites/BTComposite_Sequence.h"
+#include "BehaviorTree/Tasks/BTTask_Wait.h"
+#include "CPP_BTService_EnemyDecisions.h"
+#include "CPP_BTTask_Attack.h"
+#include "CPP_BTTask_ClearFocus.h"
+#include "CPP_BTTask_MoveToAttackTarget.h"
+#include "CPP_BTTask_PrepareForAttack.h"
+#include "CPP_BTTask_ShouldChase.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Enemy Decisions"), STAT_EnemyDecisions, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemy Decisions Per Frame"), STAT_EnemyDecisionsPerFrame, STATGROUP_ArenaFighter);
+
+namespace CPP_EnemyNativeTree
+{
+	static const FName TargetKeyName(TEXT("TargetActor"));
+	static const FName ShouldChaseKeyName(TEXT("ShouldChase"));
+
+	template <typename T>
+	T* AddKey(UBlackboardData& Blackboard, FName Name)
+	{
+		FBlackboardEntry& Entry = Blackboard.Keys.AddDefaulted_GetRef();
+		Entry.EntryName = Name;
+		T* KeyType = NewObject<T>(&Blackboard);
+		Entry.KeyType = KeyType;
+		return KeyType;
+	}
+
+	/** Adds a child node to Parent, owned by the tree like the nodes of a tree asset. */
+	template <typename T>
+	T* AddChild(UBTCompositeNode& Parent, const TCHAR* NodeName = nullptr)
+	{
+		T* Node = NewObject<T>(Parent.GetOuter());
+		if (NodeName)
+			Node->NodeName = NodeName;
+
+		FBTCompositeChild& Child = Parent.Children.AddDefaulted_GetRef();
+		if constexpr (TIsDerivedFrom<T, UBTCompositeNode>::Value)
+			Child.ChildComposite = Node;
+		else
+			Child.ChildTask = Node;
+		return Node;
+	}
+
+	template <typename T>
+	T* AddEnemyTask(UBTCompositeNode& Parent)
+	{
+		T* Task = AddChild<T>(Parent);
+		Task->TargetKey.SelectedKeyName = TargetKeyName;
+		return Task;
+	}
+}
+
+void UCPP_EnemyDecisionSubsystem::Register(UBehaviorTreeComponent& Tree, FBlackboard::FKey TargetKey, FBlackboard::FKey ShouldChaseKey)
+{
+	const AAIController* Controller = Tree.GetAIOwner();
+	ACPP_EnemyCharacterBase* Enemy = Controller ? Cast<ACPP_EnemyCharacterBase>(Controller->GetPawn()) : nullptr;
+	if (!Enemy) return;
+
+	Unregister(Tree);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Tree = &Tree;
+	Entry.Enemy = Enemy;
+	Entry.TargetKey = TargetKey;
+	Entry.ShouldChaseKey = ShouldChaseKey;
+	Decide(Entry, Now);
+	Entry.NextDecisionTime = Now + FMath::FRand() * DecisionInterval;
+}
+
+void UCPP_EnemyDecisionSubsystem::Unregister(const UBehaviorTreeComponent& Tree)
+{
+	const int32 Index = Entries.IndexOfByPredicate([&Tree](const FEntry& Entry)
+	{
+		return Entry.Tree == &Tree;
+	});
+	if (Index == INDEX_NONE) return;
+
+	Entries.RemoveAtSwap(Index);
+	if (Cursor >= Entries.Num())
+		Cursor = 0;
+}
+
+void UCPP_EnemyDecisionSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Cursor = 0;
+	NativeTree = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UCPP_EnemyDecisionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	CPP_PROFILE_SCOPE(EnemyDecisions);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	DecisionsLastFrame = 0;
+
+	for (int32 Visited = 0, NumEntries = Entries.Num(); Visited < NumEntries && DecisionsLastFrame < DecisionsPerFrame; ++Visited)
+	{
+		FEntry& Entry = Entries[Cursor];
+		Cursor = (Cursor + 1) % NumEntries;
+		if (Entry.NextDecisionTime > Now) continue;
+
+		Entry.NextDecisionTime = Now + DecisionInterval;
+		Decide(Entry, Now);
+		DecisionsLastFrame++;
+	}
+
+	for (int32 Index = Entries.Num() - 1; Index >= 0; --Index)
+		if (!Entries[Index].Tree.IsValid() || !Entries[Index].Enemy.IsValid())
+		{
+			Entries.RemoveAt(Index, 1, EAllowShrinking::No);
+			if (Index < Cursor)
+				Cursor--;
+		}
+	if (Cursor >= Entries.Num())
+		Cursor = 0;
+
+	SET_DWORD_STAT(STAT_EnemyDecisionsPerFrame, DecisionsLastFrame);
+}
+
+UBehaviorTree* UCPP_EnemyDecisionSubsystem::GetNativeTree()
+{
+	using namespace CPP_EnemyNativeTree;
+
+	if (NativeTree) return NativeTree;
+
+	UBlackboardData* Blackboard = NewObject<UBlackboardData>(this, TEXT("BB_Enemy_Native"));
+	AddKey<UBlackboardKeyType_Object>(*Blackboard, TargetKeyName)->BaseClass = AActor::StaticClass();
+	AddKey<UBlackboardKeyType_Bool>(*Blackboard, ShouldChaseKeyName);
+
+	NativeTree = NewObject<UBehaviorTree>(this, TEXT("BT_Enemy_Native"));
+	NativeTree->BlackboardAsset = Blackboard;
+
+	UBTComposite_Selector* Root = NewObject<UBTComposite_Selector>(NativeTree);
+	NativeTree->RootNode = Root;
+
+	UCPP_BTService_EnemyDecisions* DecisionService = NewObject<UCPP_BTService_EnemyDecisions>(NativeTree);
+	DecisionService->TargetKey.SelectedKeyName = TargetKeyName;
+	DecisionService->ShouldChaseKey.SelectedKeyName = ShouldChaseKeyName;
+	Root->Services.Add(DecisionService);
+
+	UBTComposite_Sequence* Chase = AddChild<UBTComposite_Sequence>(*Root, TEXT("Chase And Attack"));
+	AddEnemyTask<UCPP_BTTask_ShouldChase>(*Chase)->ShouldChaseKey.SelectedKeyName = ShouldChaseKeyName;
+	AddEnemyTask<UCPP_BTTask_MoveToAttackTarget>(*Chase);
+	AddEnemyTask<UCPP_BTTask_PrepareForAttack>(*Chase);
+	AddEnemyTask<UCPP_BTTask_Attack>(*Chase)->AttackMontage = NativeTreeAttackMontage.LoadSynchronous();
+
+	UBTComposite_Sequence* Idle = AddChild<UBTComposite_Sequence>(*Root, TEXT("Idle"));
+	AddChild<UCPP_BTTask_ClearFocus>(*Idle);
+	AddChild<UBTTask_Wait>(*Idle)->WaitTime = DecisionInterval;
+
+	return NativeTree;
+}
+
+TStatId UCPP_EnemyDecisionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_EnemyDecisionSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_EnemyDecisionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCPP_EnemyDecisionSubsystem::Decide(FEntry& Entry, double Now) const
+{
+	ACPP_EnemyCharacterBase* Enemy = Entry.Enemy.Get();
+	const UBehaviorTreeComponent* Tree = Entry.Tree.Get();
+	UBlackboardComponent* Blackboard = Tree ? Tree->GetBlackboardComponent() : nullptr;
+	if (!Enemy || !Blackboard) return;
+
+	if (APawn* Selected = Enemy->GetSelectedPawn())
+	{
+		Entry.Target = Selected;
+		Entry.LastSeenTime = Now;
+	}
+	else if (Now - Entry.LastSeenTime > Enemy->SecondsToLostTarget)
+	{
+		Entry.Target = nullptr;
+	}
+
+	ACPP_CharacterBase* TargetCharacter = Cast<ACPP_CharacterBase>(Entry.Target.Get());
+	if (Enemy->IsDead() || (TargetCharacter && TargetCharacter->IsDead()))
+		Entry.Target = nullptr;
+
+	if (Entry.TargetKey != FBlackboard::InvalidKey)
+		Blackboard->SetValue<UBlackboardKeyType_Object>(Entry.TargetKey, Entry.Target.Get());
+	if (Entry.ShouldChaseKey != FBlackboard::InvalidKey)
+		Blackboard->SetValue<UBlackboardKeyType_Bool>(Entry.ShouldChaseKey, Entry.Target.IsValid());
+}
+
+double UCPP_EnemyDecisionSubsystem::TimeTreeTicks(TConstArrayView<AAIController*> Controllers, UBehaviorTree* Tree,
+                                                  int32 Frames, float DeltaTime, double& OutDecisionMicroseconds)
+{
+	TArray<UBrainComponent*> Brains;
+	for (AAIController* Controller : Controllers)
+		if (Controller && Controller->RunBehaviorTree(Tree))
+			Brains.Add(Controller->GetBrainComponent());
+
+	double BrainSeconds = 0.0;
+	double DecisionSeconds = 0.0;
+	for (int32 Frame = 0; Frame < FMath::Max(Frames, 1); ++Frame)
+	{
+		double Start = FPlatformTime::Seconds();
+		for (UBrainComponent* Brain : Brains)
+			Brain->TickComponent(DeltaTime, LEVELTICK_All, &Brain->PrimaryComponentTick);
+		BrainSeconds += FPlatformTime::Seconds() - Start;
+
+		Start = FPlatformTime::Seconds();
+		Tick(DeltaTime);
+		DecisionSeconds += FPlatformTime::Seconds() - Start;
+	}
+
+	OutDecisionMicroseconds = DecisionSeconds * 1e6 / FMath::Max(Frames, 1);
+	return BrainSeconds * 1e6 / FMath::Max(Frames, 1);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs EnemyTreeBenchmarkCommand(
+	TEXT("ArenaFighter.AI.Benchmark"),
+	TEXT("Times the brain component ticks of the live enemies running BT_Enemy_Base, then another tree, by default the native tree. Usage: ArenaFighter.AI.Benchmark [TreePath|Native] [Enemies] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCPP_EnemyDecisionSubsystem* Decisions = World ? World->GetSubsystem<UCPP_EnemyDecisionSubsystem>() : nullptr;
+		if (!Decisions) return;
+
+		UBehaviorTree* BaselineTree = Decisions->BaselineTree.LoadSynchronous();
+		if (!BaselineTree)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("The baseline tree %s could not be loaded"), *Decisions->BaselineTree.ToString());
+			return;
+		}
+
+		const bool bNativeTree = Args.IsEmpty() || Args[0] == TEXT("Native");
+		UBehaviorTree* OtherTree = bNativeTree ? Decisions->GetNativeTree() : LoadObject<UBehaviorTree>(nullptr, *Args[0]);
+		if (!OtherTree)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Usage: ArenaFighter.AI.Benchmark [TreePath|Native] [Enemies] [Frames]"));
+			return;
+		}
+
+		const int32 MaxEnemies = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 200;
+		const int32 Frames = Args.Num() > 2 ? FMath::Max(FCString::Atoi(*Args[2]), 1) : 60;
+		constexpr float DeltaTime = 1.0f / 60.0f;
+
+		TArray<AAIController*> Controllers;
+		TArray<UBehaviorTree*> OriginalTrees;
+		for (TActorIterator<ACPP_EnemyCharacterBase> It(World); It && Controllers.Num() < MaxEnemies; ++It)
+			if (AAIController* Controller = Cast<AAIController>(It->GetController()))
+			{
+				const UBehaviorTreeComponent* Tree = Cast<UBehaviorTreeComponent>(Controller->GetBrainComponent());
+				Controllers.Add(Controller);
+				OriginalTrees.Add(Tree ? Tree->GetRootTree() : nullptr);
+			}
+
+		if (Controllers.Num() < MaxEnemies)
+			UE_LOG(LogTemp, Warning, TEXT("Only %d enemies have an AI controller, spawn more (e.g. with -ArenaStress) for a %d enemy benchmark"),
+			       Controllers.Num(), MaxEnemies);
+		if (Controllers.IsEmpty()) return;
+
+		double BaselineDecisionTime = 0.0;
+		double OtherDecisionTime = 0.0;
+		const double BaselineTime = Decisions->TimeTreeTicks(Controllers, BaselineTree, Frames, DeltaTime, BaselineDecisionTime);
+		const double OtherTime = Decisions->TimeTreeTicks(Controllers, OtherTree, Frames, DeltaTime, OtherDecisionTime);
+
+		for (int32 Index = 0; Index < Controllers.Num(); ++Index)
+			if (OriginalTrees[Index])
+				Controllers[Index]->RunBehaviorTree(OriginalTrees[Index]);
+
+		UE_LOG(LogTemp, Log, TEXT("%d enemies, %d frames of brain ticks: %s %.1f us/frame (%.2f us/enemy), %s %.1f us/frame (%.2f us/enemy)"),
+		       Controllers.Num(), Frames, *BaselineTree->GetName(), BaselineTime, BaselineTime / Controllers.Num(),
+		       *OtherTree->GetName(), OtherTime, OtherTime / Controllers.Num());
+		UE_LOG(LogTemp, Log, TEXT("Shared decision queue, not included above: %.1f us/frame with %s, %.1f us/frame with %s"),
+		       BaselineDecisionTime, *BaselineTree->GetName(), OtherDecisionTime, *OtherTree->GetName());
+	}));
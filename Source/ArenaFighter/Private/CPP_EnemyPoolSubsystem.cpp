@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_EnemyPoolSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CombatRecorderSubsystem.h"
+#include "CPP_EnemyCharacterBase.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Hits"), STAT_EnemyPoolHits, STATGROUP_ArenaFighter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Misses"), STAT_EnemyPoolMisses, STATGROUP_ArenaFighter);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Enemy Pool Free"), STAT_EnemyPoolFree, STATGROUP_ArenaFighter);
+
+ACPP_EnemyCharacterBase* UCPP_EnemyPoolSubsystem::SpawnEnemy(TSubclassOf<ACPP_EnemyCharacterBase> EnemyClass,
+                                                            const FTransform& SpawnTransform)
+{
+	if (!EnemyClass) return nullptr;
+
+	UCPP_CombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCPP_CombatRecorderSubsystem>();
+	if (Recorder && !Recorder->AcceptsLiveInput()) return nullptr;
+
+	if (FCPP_EnemyPoolBucket* Bucket = Buckets.Find(EnemyClass))
+		while (!Bucket->FreeEnemies.IsEmpty())
+		{
+			ACPP_EnemyCharacterBase* Enemy = Bucket->FreeEnemies.Pop(EAllowShrinking::No);
+			DEC_DWORD_STAT(STAT_EnemyPoolFree);
+			if (!IsValid(Enemy)) continue;
+
+			Hits++;
+			INC_DWORD_STAT(STAT_EnemyPoolHits);
+			Enemy->ActivateFromPool(SpawnTransform);
+			if (Recorder)
+				Recorder->RecordSpawn(Enemy, EnemyClass, SpawnTransform);
+			return Enemy;
+		}
+
+	Misses++;
+	INC_DWORD_STAT(STAT_EnemyPoolMisses);
+
+	FActorSpawnParameters spawnParameters;
+	spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	ACPP_EnemyCharacterBase* Enemy = GetWorld()->SpawnActor<ACPP_EnemyCharacterBase>(
+		EnemyClass, SpawnTransform, spawnParameters);
+	if (Enemy)
+	{
+		Enemy->SetPooled(true);
+		if (!Enemy->GetController())
+			Enemy->SpawnDefaultController();
+
+		if (Recorder)
+			Recorder->RecordSpawn(Enemy, EnemyClass, SpawnTransform);
+	}
+
+	return Enemy;
+}
+
+void UCPP_EnemyPoolSubsystem::ReleaseEnemy(ACPP_EnemyCharacterBase* Enemy)
+{
+	if (!IsValid(Enemy)) return;
+
+	FCPP_EnemyPoolBucket& Bucket = Buckets.FindOrAdd(Enemy->GetClass());
+	if (Bucket.FreeEnemies.Contains(Enemy)) return;
+
+	Enemy->SetPooled(true);
+	Enemy->DeactivateToPool();
+	Bucket.FreeEnemies.Add(Enemy);
+	INC_DWORD_STAT(STAT_EnemyPoolFree);
+}
+
+int32 UCPP_EnemyPoolSubsystem::GetNumFree(TSubclassOf<ACPP_EnemyCharacterBase> EnemyClass) const
+{
+	const FCPP_EnemyPoolBucket* Bucket = Buckets.Find(EnemyClass);
+	return Bucket ? Bucket->FreeEnemies.Num() : 0;
+}
+
+void UCPP_EnemyPoolSubsystem::Deinitialize()
+{
+	Buckets.Empty();
+	SET_DWORD_STAT(STAT_EnemyPoolFree, 0);
+
+	Super::Deinitialize();
+}
+
+bool UCPP_EnemyPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,169 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_EnemySignificanceSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "GameFramework/PlayerController.h"
+#include "SignificanceManager.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies In Bucket 0"), STAT_SignificanceBucket0, STATGROUP_ArenaFighterSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies In Bucket 1"), STAT_SignificanceBucket1, STATGROUP_ArenaFighterSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies In Bucket 2"), STAT_SignificanceBucket2, STATGROUP_ArenaFighterSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Enemies In Bucket 3+"), STAT_SignificanceBucket3, STATGROUP_ArenaFighterSignificance);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Enemies"), STAT_ActiveEnemies, STATGROUP_ArenaFighter);
+
+const FName UCPP_EnemySignificanceSubsystem::SignificanceTag = TEXT("ArenaFighterEnemy");
+
+UCPP_EnemySignificanceSubsystem::UCPP_EnemySignificanceSubsystem()
+{
+	// Defaults used when DefaultGame.ini does not override Buckets
+	FCPP_SignificanceBucket FullRate;
+	FullRate.MaxDistance = 2500.0f;
+
+	FCPP_SignificanceBucket Reduced;
+	Reduced.MaxDistance = 5000.0f;
+	Reduced.TickInterval = 1.0f / 30.0f;
+	Reduced.SensingIntervalScale = 2.0f;
+	Reduced.AnimationFrameSkip = 1;
+
+	FCPP_SignificanceBucket Low;
+	Low.MaxDistance = 10000.0f;
+	Low.TickInterval = 1.0f / 15.0f;
+	Low.SensingIntervalScale = 4.0f;
+	Low.AnimationFrameSkip = 3;
+
+	FCPP_SignificanceBucket Minimal;
+	Minimal.MaxDistance = FLT_MAX;
+	Minimal.TickInterval = 0.25f;
+	Minimal.SensingIntervalScale = 8.0f;
+	Minimal.AnimationFrameSkip = 7;
+
+	Buckets = { FullRate, Reduced, Low, Minimal };
+}
+
+void UCPP_EnemySignificanceSubsystem::Register(ACPP_EnemyCharacterBase* Enemy)
+{
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!Enemy || !SignificanceManager || EnemyBuckets.Contains(Enemy)) return;
+
+	EnemyBuckets.Add(Enemy, 0);
+
+	SignificanceManager->RegisterObject(
+		Enemy, SignificanceTag,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint)
+		{
+			return CalculateSignificance(CastChecked<AActor>(ObjectInfo->GetObject()), Viewpoint);
+		},
+		USignificanceManager::EPostSignificanceType::Sequential,
+		[this](USignificanceManager::FManagedObjectInfo* ObjectInfo, float OldSignificance, float NewSignificance, bool bFinal)
+		{
+			if (OldSignificance != NewSignificance)
+				ApplyBucket(CastChecked<ACPP_EnemyCharacterBase>(ObjectInfo->GetObject()), GetBucketIndex(NewSignificance));
+		});
+}
+
+void UCPP_EnemySignificanceSubsystem::Unregister(ACPP_EnemyCharacterBase* Enemy)
+{
+	if (EnemyBuckets.Remove(Enemy) == 0) return;
+
+	if (USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld()))
+		SignificanceManager->UnregisterObject(Enemy);
+
+	// Leave the enemy at full fidelity, e.g. when it goes back to a pool
+	if (!Buckets.IsEmpty())
+		Enemy->ApplySignificanceBucket(Buckets[0]);
+}
+
+int32 UCPP_EnemySignificanceSubsystem::GetNumEnemiesInBucket(int32 BucketIndex) const
+{
+	int32 Count = 0;
+	for (const TPair<TWeakObjectPtr<ACPP_EnemyCharacterBase>, int32>& EnemyBucket : EnemyBuckets)
+		if (EnemyBucket.Value == BucketIndex)
+			Count++;
+
+	return Count;
+}
+
+void UCPP_EnemySignificanceSubsystem::Deinitialize()
+{
+	EnemyBuckets.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_EnemySignificanceSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SET_DWORD_STAT(STAT_ActiveEnemies, EnemyBuckets.Num());
+	CSV_CUSTOM_STAT(ArenaFighter, ActiveEnemies, EnemyBuckets.Num(), ECsvCustomStatOp::Set);
+
+	USignificanceManager* SignificanceManager = USignificanceManager::Get(GetWorld());
+	if (!SignificanceManager || EnemyBuckets.IsEmpty()) return;
+
+	TArray<FTransform, TInlineAllocator<4>> Viewpoints;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		if (const APlayerController* PlayerController = It->Get())
+			if (PlayerController->IsLocalController())
+			{
+				FVector ViewLocation;
+				FRotator ViewRotation;
+				PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+				Viewpoints.Emplace(ViewRotation, ViewLocation);
+			}
+
+	SignificanceManager->Update(Viewpoints);
+
+	int32 BucketCounts[4] = { 0, 0, 0, 0 };
+	for (const TPair<TWeakObjectPtr<ACPP_EnemyCharacterBase>, int32>& EnemyBucket : EnemyBuckets)
+		BucketCounts[FMath::Min(EnemyBucket.Value, 3)]++;
+
+	SET_DWORD_STAT(STAT_SignificanceBucket0, BucketCounts[0]);
+	SET_DWORD_STAT(STAT_SignificanceBucket1, BucketCounts[1]);
+	SET_DWORD_STAT(STAT_SignificanceBucket2, BucketCounts[2]);
+	SET_DWORD_STAT(STAT_SignificanceBucket3, BucketCounts[3]);
+}
+
+TStatId UCPP_EnemySignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_EnemySignificanceSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_EnemySignificanceSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+float UCPP_EnemySignificanceSubsystem::CalculateSignificance(const AActor* Enemy, const FTransform& Viewpoint) const
+{
+	const FVector ToEnemy = Enemy->GetActorLocation() - Viewpoint.GetLocation();
+	const float Distance = ToEnemy.Size();
+	if (Distance <= FullFidelityDistance)
+		return Buckets.Num();
+
+	const bool bInView = FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToEnemy / Distance)
+		>= FMath::Cos(FMath::DegreesToRadians(ViewHalfAngle));
+	const float EffectiveDistance = bInView ? Distance : Distance * OutOfViewDistanceScale;
+
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); ++BucketIndex)
+		if (EffectiveDistance <= Buckets[BucketIndex].MaxDistance)
+			return Buckets.Num() - BucketIndex;
+
+	return 1.0f;
+}
+
+int32 UCPP_EnemySignificanceSubsystem::GetBucketIndex(float Significance) const
+{
+	return FMath::Clamp(Buckets.Num() - FMath::RoundToInt32(Significance), 0, FMath::Max(Buckets.Num() - 1, 0));
+}
+
+void UCPP_EnemySignificanceSubsystem::ApplyBucket(ACPP_EnemyCharacterBase* Enemy, int32 BucketIndex)
+{
+	int32* CurrentBucket = EnemyBuckets.Find(Enemy);
+	if (!CurrentBucket || !Buckets.IsValidIndex(BucketIndex)) return;
+
+	*CurrentBucket = BucketIndex;
+	Enemy->ApplySignificanceBucket(Buckets[BucketIndex]);
+}
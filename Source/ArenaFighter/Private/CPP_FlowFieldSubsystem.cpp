@@ -0,0 +1,398 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_FlowFieldSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
+#include "NavigationPath.h"
+
+DECLARE_CYCLE_STAT(TEXT("Flow Field Build"), STAT_FlowFieldBuild, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Fields"), STAT_FlowFields, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Cells Expanded"), STAT_FlowFieldCellsExpanded, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Flow Field Samples"), STAT_FlowFieldSamples, STATGROUP_ArenaFighter);
+
+namespace CPP_FlowField
+{
+	static constexpr int32 NeighbourX[] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+	static constexpr int32 NeighbourY[] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+}
+
+bool UCPP_FlowFieldSubsystem::SampleDirection(const AActor* Target, const FVector& Location, FVector& OutDirection)
+{
+	if (!Target || !BuildGrid()) return false;
+
+	INC_DWORD_STAT(STAT_FlowFieldSamples);
+
+	FField* Field = &FindOrAddField(Target);
+	Field->LastSampleTime = GetWorld()->GetTimeSeconds();
+
+	const int32 Cell = GetCell(Location);
+	if (Field->Distances.IsEmpty() || Cell == INDEX_NONE) return false;
+
+	const int32 X = Cell % GridWidth;
+	const int32 Y = Cell / GridWidth;
+
+	int32 BestCell = INDEX_NONE;
+	uint16 BestDistance = Field->Distances[Cell];
+	for (int32 Neighbour = 0; Neighbour < 8; ++Neighbour)
+	{
+		const int32 DeltaX = CPP_FlowField::NeighbourX[Neighbour];
+		const int32 DeltaY = CPP_FlowField::NeighbourY[Neighbour];
+		if (!CanStep(X, Y, DeltaX, DeltaY)) continue;
+
+		const int32 NeighbourCell = Cell + DeltaY * GridWidth + DeltaX;
+		if (Field->Distances[NeighbourCell] < BestDistance)
+		{
+			BestDistance = Field->Distances[NeighbourCell];
+			BestCell = NeighbourCell;
+		}
+	}
+
+	if (BestCell == INDEX_NONE) return false;
+
+	OutDirection = (GetCellCenter(BestCell) - Location).GetSafeNormal2D();
+	return !OutDirection.IsNearlyZero();
+}
+
+bool UCPP_FlowFieldSubsystem::HasField(const AActor* Target) const
+{
+	const FField* Field = Fields.FindByPredicate([Target](const FField& Candidate) { return Candidate.Target.Get() == Target; });
+	return Field && !Field->Distances.IsEmpty();
+}
+
+int32 UCPP_FlowFieldSubsystem::GetDistance(const AActor* Target, const FVector& Location) const
+{
+	const FField* Field = Fields.FindByPredicate([Target](const FField& Candidate) { return Candidate.Target.Get() == Target; });
+	const int32 Cell = bGridBuilt ? GetCell(Location) : INDEX_NONE;
+	if (!Field || Field->Distances.IsEmpty() || Cell == INDEX_NONE || Field->Distances[Cell] == Unreachable) return INDEX_NONE;
+
+	return Field->Distances[Cell];
+}
+
+int32 UCPP_FlowFieldSubsystem::BuildFieldNow(const AActor* Target)
+{
+	if (!Target || !BuildGrid()) return 0;
+
+	const int32 TargetCell = GetCell(Target->GetActorLocation());
+	if (TargetCell == INDEX_NONE) return 0;
+
+	FField& Field = FindOrAddField(Target);
+	Field.LastSampleTime = GetWorld()->GetTimeSeconds();
+
+	CPP_PROFILE_SCOPE(FlowFieldBuild);
+
+	StartBuild(Field, TargetCell);
+	return ExpandBuild(Field, MAX_int32);
+}
+
+bool UCPP_FlowFieldSubsystem::BuildGrid()
+{
+	if (bGridBuilt) return true;
+
+	// The navmesh may still be generating, don't project the whole grid again every sample
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now < NextGridBuildTime) return false;
+	NextGridBuildTime = Now + GridRetryInterval;
+
+	return RasterizeGrid();
+}
+
+bool UCPP_FlowFieldSubsystem::RasterizeGrid()
+{
+	const UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavigationSystem) return false;
+
+	const FBox Bounds = NavigationSystem->GetNavigableWorldBounds();
+	if (!Bounds.IsValid) return false;
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	const FVector2D Size(Bounds.GetSize());
+	const float NewCellSize = FMath::Max(CellSize, FMath::Sqrt(Size.X * Size.Y / FMath::Max(MaxCells, 1)));
+	const FVector2D NewOrigin(Bounds.Min);
+	const int32 NewWidth = FMath::Max(FMath::CeilToInt32(Size.X / NewCellSize), 1);
+	const int32 NewHeight = FMath::Max(FMath::CeilToInt32(Size.Y / NewCellSize), 1);
+
+	const float CenterZ = Bounds.GetCenter().Z;
+	const FVector ProjectionExtent(NewCellSize * 0.5f, NewCellSize * 0.5f, FMath::Max(ProjectionHeight, Bounds.GetExtent().Z));
+
+	TBitArray<> NewWalkable(false, NewWidth * NewHeight);
+	int32 WalkableCells = 0;
+	for (int32 Cell = 0; Cell < NewWidth * NewHeight; ++Cell)
+	{
+		FNavLocation Projected;
+		const FVector Center(NewOrigin.X + (Cell % NewWidth + 0.5f) * NewCellSize,
+		                     NewOrigin.Y + (Cell / NewWidth + 0.5f) * NewCellSize,
+		                     CenterZ);
+		NewWalkable[Cell] = NavigationSystem->ProjectPointToNavigation(Center, Projected, ProjectionExtent);
+		WalkableCells += NewWalkable[Cell] ? 1 : 0;
+	}
+
+	if (WalkableCells == 0)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Flow field grid: no cell projects onto the navmesh yet"));
+		return false;
+	}
+
+	SetGrid(NewOrigin, NewCellSize, NewWidth, NewHeight, MoveTemp(NewWalkable));
+	UE_LOG(LogTemp, Log, TEXT("Flow field grid: %d x %d cells of %.0f units, %d walkable, built in %.1f ms"),
+	       GridWidth, GridHeight, GridCellSize, WalkableCells, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	return true;
+}
+
+void UCPP_FlowFieldSubsystem::SetGrid(const FVector2D& Origin, float InCellSize, int32 Width, int32 Height,
+                                      TBitArray<> InWalkable)
+{
+	check(InWalkable.Num() == Width * Height);
+
+	const bool bSameLayout = bGridBuilt && Width == GridWidth && Height == GridHeight
+		&& Origin.Equals(GridOrigin) && InCellSize == GridCellSize;
+
+	if (bSameLayout)
+	{
+		if (InWalkable == Walkable) return;
+
+		// Same cells, different obstacles: samples keep the current distances while the fields are rebuilt
+		Walkable = MoveTemp(InWalkable);
+		for (FField& Field : Fields)
+		{
+			const int32 Goal = Field.IsBuilding() ? Field.PendingTargetCell : Field.TargetCell;
+			if (Goal != INDEX_NONE)
+				StartBuild(Field, Goal);
+		}
+	}
+	else
+	{
+		GridCellSize = InCellSize;
+		GridOrigin = Origin;
+		GridWidth = Width;
+		GridHeight = Height;
+		Walkable = MoveTemp(InWalkable);
+
+		// Distances are indexed by cell, they don't survive a new layout
+		Fields.Empty();
+	}
+
+	bGridBuilt = true;
+}
+
+void UCPP_FlowFieldSubsystem::HandleNavigationGenerationFinished(ANavigationData* NavData)
+{
+	RasterizeGrid();
+}
+
+UCPP_FlowFieldSubsystem::FField& UCPP_FlowFieldSubsystem::FindOrAddField(const AActor* Target)
+{
+	FField* Field = Fields.FindByPredicate([Target](const FField& Candidate) { return Candidate.Target.Get() == Target; });
+	if (!Field)
+	{
+		Field = &Fields.AddDefaulted_GetRef();
+		Field->Target = Target;
+	}
+	return *Field;
+}
+
+void UCPP_FlowFieldSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(&InWorld))
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(
+			this, &UCPP_FlowFieldSubsystem::HandleNavigationGenerationFinished);
+
+	BuildGrid();
+}
+
+void UCPP_FlowFieldSubsystem::Deinitialize()
+{
+	if (UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+		NavigationSystem->OnNavigationGenerationFinishedDelegate.RemoveDynamic(
+			this, &UCPP_FlowFieldSubsystem::HandleNavigationGenerationFinished);
+
+	Fields.Empty();
+	Walkable.Empty();
+	bGridBuilt = false;
+	NextGridBuildTime = 0.0;
+
+	Super::Deinitialize();
+}
+
+void UCPP_FlowFieldSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	Fields.RemoveAll([this, Now](const FField& Field)
+	{
+		return !Field.Target.IsValid() || Now - Field.LastSampleTime > FieldLifetime;
+	});
+
+	SET_DWORD_STAT(STAT_FlowFields, Fields.Num());
+	if (Fields.IsEmpty() || !bGridBuilt) return;
+
+	CPP_PROFILE_SCOPE(FlowFieldBuild);
+
+	int32 Budget = CellsPerFrame;
+	for (FField& Field : Fields)
+	{
+		// A build in progress is finished first, restarting it on every move would starve a fast target
+		const int32 TargetCell = GetCell(Field.Target->GetActorLocation());
+		if (!Field.IsBuilding() && TargetCell != INDEX_NONE && TargetCell != Field.TargetCell)
+			StartBuild(Field, TargetCell);
+
+		if (Field.IsBuilding() && Budget > 0)
+			Budget -= ExpandBuild(Field, Budget);
+	}
+
+	INC_DWORD_STAT_BY(STAT_FlowFieldCellsExpanded, CellsPerFrame - Budget);
+}
+
+TStatId UCPP_FlowFieldSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_FlowFieldSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_FlowFieldSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UCPP_FlowFieldSubsystem::GetCell(const FVector& Location) const
+{
+	const int32 X = FMath::FloorToInt32((Location.X - GridOrigin.X) / GridCellSize);
+	const int32 Y = FMath::FloorToInt32((Location.Y - GridOrigin.Y) / GridCellSize);
+	if (X < 0 || Y < 0 || X >= GridWidth || Y >= GridHeight) return INDEX_NONE;
+
+	return Y * GridWidth + X;
+}
+
+FVector UCPP_FlowFieldSubsystem::GetCellCenter(int32 Cell) const
+{
+	return FVector(GridOrigin.X + (Cell % GridWidth + 0.5f) * GridCellSize,
+	               GridOrigin.Y + (Cell / GridWidth + 0.5f) * GridCellSize,
+	               0.0f);
+}
+
+bool UCPP_FlowFieldSubsystem::CanStep(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const
+{
+	const int32 ToX = X + DeltaX;
+	const int32 ToY = Y + DeltaY;
+	if (ToX < 0 || ToY < 0 || ToX >= GridWidth || ToY >= GridHeight) return false;
+	if (!Walkable[ToY * GridWidth + ToX]) return false;
+
+	return DeltaX == 0 || DeltaY == 0 || (Walkable[Y * GridWidth + ToX] && Walkable[ToY * GridWidth + X]);
+}
+
+void UCPP_FlowFieldSubsystem::StartBuild(FField& Field, int32 TargetCell)
+{
+	Field.PendingTargetCell = TargetCell;
+	Field.PendingDistances.Init(Unreachable, GridWidth * GridHeight);
+	Field.PendingDistances[TargetCell] = 0;
+	Field.Frontier.Reset();
+	Field.Frontier.Add(TargetCell);
+	Field.FrontierHead = 0;
+}
+
+int32 UCPP_FlowFieldSubsystem::ExpandBuild(FField& Field, int32 Budget)
+{
+	int32 Expanded = 0;
+	while (Field.FrontierHead < Field.Frontier.Num() && Expanded < Budget)
+	{
+		const int32 Cell = Field.Frontier[Field.FrontierHead++];
+		const int32 X = Cell % GridWidth;
+		const int32 Y = Cell / GridWidth;
+		const uint16 NextDistance = Field.PendingDistances[Cell] + 1;
+		Expanded++;
+
+		for (int32 Neighbour = 0; Neighbour < 8; ++Neighbour)
+		{
+			const int32 DeltaX = CPP_FlowField::NeighbourX[Neighbour];
+			const int32 DeltaY = CPP_FlowField::NeighbourY[Neighbour];
+			if (!CanStep(X, Y, DeltaX, DeltaY)) continue;
+
+			const int32 NeighbourCell = Cell + DeltaY * GridWidth + DeltaX;
+			if (Field.PendingDistances[NeighbourCell] != Unreachable) continue;
+
+			Field.PendingDistances[NeighbourCell] = NextDistance;
+			Field.Frontier.Add(NeighbourCell);
+		}
+	}
+
+	// Wave finished: publish the new field, samples used the previous one until now
+	if (Field.FrontierHead >= Field.Frontier.Num())
+	{
+		Swap(Field.Distances, Field.PendingDistances);
+		Field.TargetCell = Field.PendingTargetCell;
+		Field.PendingTargetCell = INDEX_NONE;
+		Field.PendingDistances.Reset();
+		Field.Frontier.Reset();
+		Field.FrontierHead = 0;
+	}
+
+	return Expanded;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs FlowFieldBenchmarkCommand(
+	TEXT("ArenaFighter.FlowField.Benchmark"),
+	TEXT("Times a full flow field build toward the player, then one frame of path queries for 50, 200 and 500 chasers, flow field samples against FindPathSync. Usage: ArenaFighter.FlowField.Benchmark [Radius]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UCPP_FlowFieldSubsystem* FlowField = World ? World->GetSubsystem<UCPP_FlowFieldSubsystem>() : nullptr;
+		UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(World);
+		const APawn* Player = World && World->GetFirstPlayerController() ? World->GetFirstPlayerController()->GetPawn() : nullptr;
+		if (!FlowField || !NavigationSystem || !Player) return;
+
+		const float Radius = Args.Num() > 0 ? FMath::Max(FCString::Atof(*Args[0]), 100.0f) : 3000.0f;
+		const FVector Goal = Player->GetActorLocation();
+
+		// The breadth-first wave is what a target changing cell costs, spread over frames by CellsPerFrame
+		const double BuildStart = FPlatformTime::Seconds();
+		const int32 ExpandedCells = FlowField->BuildFieldNow(Player);
+		const double BuildTime = (FPlatformTime::Seconds() - BuildStart) * 1000.0;
+		if (!FlowField->HasField(Player))
+		{
+			UE_LOG(LogTemp, Log, TEXT("No flow field toward the player: the grid is not built or the player is outside it"));
+			return;
+		}
+
+		const int32 BuildFrames = FMath::DivideAndRoundUp(ExpandedCells, FMath::Max(FlowField->CellsPerFrame, 1));
+		UE_LOG(LogTemp, Log, TEXT("Field build: %d cells in %.3f ms, %d frames of %d cells at %.3f ms per frame"),
+		       ExpandedCells, BuildTime, BuildFrames, FlowField->CellsPerFrame, BuildTime / FMath::Max(BuildFrames, 1));
+
+		FVector Direction;
+
+		// Chasers start at the live enemies, then at random reachable points around the player
+		TArray<FVector> Starts;
+		for (TActorIterator<ACPP_EnemyCharacterBase> It(World); It && Starts.Num() < 500; ++It)
+			if (!It->IsHidden())
+				Starts.Add(It->GetActorLocation());
+
+		FNavLocation RandomPoint;
+		while (Starts.Num() < 500 && NavigationSystem->GetRandomReachablePointInRadius(Goal, Radius, RandomPoint))
+			Starts.Add(RandomPoint.Location);
+
+		for (const int32 Chasers : { 50, 200, 500 })
+		{
+			const int32 Count = FMath::Min(Chasers, Starts.Num());
+			int32 Checksum = 0;
+
+			double Start = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; ++Index)
+				Checksum += FlowField->SampleDirection(Player, Starts[Index], Direction) ? 1 : 0;
+			const double FlowFieldTime = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			Start = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				const UNavigationPath* Path = NavigationSystem->FindPathToLocationSynchronously(World, Starts[Index], Goal);
+				Checksum += Path && Path->IsValid() ? Path->PathPoints.Num() : 0;
+			}
+			const double PathTime = (FPlatformTime::Seconds() - Start) * 1000.0;
+
+			UE_LOG(LogTemp, Log, TEXT("%d chasers: flow field %.3f ms, FindPathSync %.3f ms per frame (checksum %d)"),
+			       Count, FlowFieldTime, PathTime, Checksum);
+		}
+	}));
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_LineOfSightSubsystem.h"
+
+#include "CPP_CharacterBase.h"
+
+ECPP_LineOfSight UCPP_LineOfSightSubsystem::QueryLineOfSight(APawn* Observer, APawn* Target)
+{
+	const uint64 Key = MakeKey(Observer, Target);
+
+	if (const FCacheEntry* Entry = Cache.Find(Key))
+	{
+		const double Now = GetWorld()->GetTimeSeconds();
+		const float MoveToleranceSquared = FMath::Square(MoveTolerance);
+
+		if (Now - Entry->Time <= CacheLifetime
+			&& FVector::DistSquared(Entry->ObserverLocation, Observer->GetActorLocation()) <= MoveToleranceSquared
+			&& FVector::DistSquared(Entry->TargetLocation, Target->GetActorLocation()) <= MoveToleranceSquared)
+			return Entry->bVisible ? ECPP_LineOfSight::Visible : ECPP_LineOfSight::Hidden;
+	}
+
+	bool bAlreadyPending = false;
+	PendingKeys.Add(Key, &bAlreadyPending);
+	if (!bAlreadyPending)
+	{
+		FPendingTrace& Trace = QueuedTraces.AddDefaulted_GetRef();
+		Trace.Observer = Observer;
+		Trace.Target = Target;
+		Trace.Key = Key;
+		Trace.Start = GetEyesLocation(Observer);
+		Trace.End = Target->GetActorLocation();
+	}
+
+	return ECPP_LineOfSight::Pending;
+}
+
+void UCPP_LineOfSightSubsystem::MarkVisible(APawn* Observer, APawn* Target)
+{
+	FCacheEntry& Entry = Cache.FindOrAdd(MakeKey(Observer, Target));
+	Entry.ObserverLocation = Observer->GetActorLocation();
+	Entry.TargetLocation = Target->GetActorLocation();
+	Entry.Time = GetWorld()->GetTimeSeconds();
+	Entry.bVisible = true;
+}
+
+void UCPP_LineOfSightSubsystem::CancelQueries(const APawn* Pawn)
+{
+	auto Involves = [this, Pawn](const FPendingTrace& Trace)
+	{
+		if (Trace.Observer.Get() != Pawn && Trace.Target.Get() != Pawn) return false;
+
+		PendingKeys.Remove(Trace.Key);
+		return true;
+	};
+
+	QueuedTraces.RemoveAllSwap(Involves, EAllowShrinking::No);
+	InFlightTraces.RemoveAllSwap(Involves, EAllowShrinking::No);
+}
+
+void UCPP_LineOfSightSubsystem::Deinitialize()
+{
+	Cache.Empty();
+	QueuedTraces.Empty();
+	InFlightTraces.Empty();
+	PendingKeys.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_LineOfSightSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ConsumeResults();
+	SubmitQueuedTraces();
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastPruneTime > 1.0)
+		PruneCache(Now);
+}
+
+TStatId UCPP_LineOfSightSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_LineOfSightSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_LineOfSightSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+uint64 UCPP_LineOfSightSubsystem::MakeKey(const APawn* Observer, const APawn* Target)
+{
+	return static_cast<uint64>(Observer->GetUniqueID()) << 32 | Target->GetUniqueID();
+}
+
+FVector UCPP_LineOfSightSubsystem::GetEyesLocation(const APawn* Pawn)
+{
+	FVector EyesLocation;
+	FRotator EyesRotation;
+	Pawn->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+	return EyesLocation;
+}
+
+void UCPP_LineOfSightSubsystem::ConsumeResults()
+{
+	UWorld* World = GetWorld();
+	const double Now = World->GetTimeSeconds();
+
+	// Iterate on a copy, notifying characters may queue new queries
+	TArray<FPendingTrace> Traces = MoveTemp(InFlightTraces);
+	InFlightTraces.Reset();
+
+	for (FPendingTrace& Trace : Traces)
+	{
+		APawn* Observer = Trace.Observer.Get();
+		APawn* Target = Trace.Target.Get();
+
+		FTraceDatum Datum;
+		const bool bHasResult = World->QueryTraceData(Trace.Handle, Datum);
+		if (!bHasResult && World->IsTraceHandleValid(Trace.Handle, false) && Observer && Target)
+		{
+			InFlightTraces.Add(Trace);
+			continue;
+		}
+
+		PendingKeys.Remove(Trace.Key);
+		if (!bHasResult || !Observer || !Target) continue;
+
+		// The observer and the target are ignored by the trace, so any blocking hit means something is in between
+		const bool bVisible = !FHitResult::GetFirstBlockingHit(Datum.OutHits);
+
+		FCacheEntry& Entry = Cache.FindOrAdd(Trace.Key);
+		Entry.ObserverLocation = Observer->GetActorLocation();
+		Entry.TargetLocation = Target->GetActorLocation();
+		Entry.Time = Now;
+		Entry.bVisible = bVisible;
+
+		if (!bVisible)
+			if (ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(Observer))
+				Character->OnLineOfSightLost(Target);
+	}
+}
+
+void UCPP_LineOfSightSubsystem::SubmitQueuedTraces()
+{
+	UWorld* World = GetWorld();
+
+	for (FPendingTrace& Trace : QueuedTraces)
+	{
+		APawn* Observer = Trace.Observer.Get();
+		APawn* Target = Trace.Target.Get();
+		if (!Observer || !Target)
+		{
+			PendingKeys.Remove(Trace.Key);
+			continue;
+		}
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ArenaFighterLineOfSight), true, Observer);
+		QueryParams.AddIgnoredActor(Target);
+
+		Trace.Handle = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Trace.Start, Trace.End, TraceChannel,
+		                                              QueryParams);
+		InFlightTraces.Add(Trace);
+	}
+
+	QueuedTraces.Reset();
+}
+
+void UCPP_LineOfSightSubsystem::PruneCache(double Now)
+{
+	LastPruneTime = Now;
+
+	for (TMap<uint64, FCacheEntry>::TIterator It = Cache.CreateIterator(); It; ++It)
+		if (Now - It.Value().Time > CacheLifetime)
+			It.RemoveCurrent();
+}
@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_MeleeHitSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_AttackTarget.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_Weapon.h"
+#include "GameFramework/Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("Melee Hit Results"), STAT_MeleeHitResults, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Swings"), STAT_MeleeSwings, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Sweeps"), STAT_MeleeSweeps, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Melee Hits"), STAT_MeleeHits, STATGROUP_ArenaFighter);
+
+void UCPP_MeleeHitSubsystem::QueueSwing(ACharacter* Attacker, const ACPP_Weapon* Weapon)
+{
+	if (Weapon)
+		QueueSwing(Attacker, Weapon->GetAttackReach(), Weapon->GetDamage());
+}
+
+void UCPP_MeleeHitSubsystem::QueueSwing(ACharacter* Attacker, float Reach, float Damage)
+{
+	if (!Attacker || Reach <= 0.0f) return;
+
+	FSwing Swing;
+	Swing.Attacker = Attacker;
+	Swing.Damage = Damage;
+	Swing.Reach = Reach;
+	Swing.Origin = Attacker->GetActorLocation();
+	Swing.Forward = Attacker->GetActorForwardVector().GetSafeNormal2D();
+
+	INC_DWORD_STAT(STAT_MeleeSwings);
+
+	if (bAsyncSweeps)
+		QueuedSwings.Add(MoveTemp(Swing));
+	else
+		SweepNow(Swing);
+}
+
+void UCPP_MeleeHitSubsystem::Deinitialize()
+{
+	QueuedSwings.Empty();
+	InFlightSwings.Empty();
+	SwingHits.Empty();
+	SweepResults.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_MeleeHitSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ConsumeResults();
+	SubmitQueuedSwings();
+}
+
+TStatId UCPP_MeleeHitSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_MeleeHitSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_MeleeHitSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+FVector UCPP_MeleeHitSubsystem::GetSweepDirection(const FSwing& Swing, int32 SweepIndex) const
+{
+	const int32 NumSweeps = FMath::Max(ArcSweeps, 1);
+	if (NumSweeps == 1) return Swing.Forward;
+
+	const float Alpha = static_cast<float>(SweepIndex) / (NumSweeps - 1);
+	const float Yaw = FMath::Lerp(-ArcHalfAngle, ArcHalfAngle, Alpha);
+	return Swing.Forward.RotateAngleAxis(Yaw, FVector::UpVector);
+}
+
+FCollisionQueryParams UCPP_MeleeHitSubsystem::MakeQueryParams(const ACharacter* Attacker) const
+{
+	return FCollisionQueryParams(SCENE_QUERY_STAT(ArenaFighterMeleeHit), false, Attacker);
+}
+
+FCollisionResponseParams UCPP_MeleeHitSubsystem::MakeResponseParams()
+{
+	// Every touch is returned as an overlap so a nearer target never hides the ones behind it,
+	// but static geometry still blocks and ends the sweep there
+	FCollisionResponseParams ResponseParams(ECR_Overlap);
+	ResponseParams.CollisionResponse.SetResponse(ECC_WorldStatic, ECR_Block);
+	return ResponseParams;
+}
+
+void UCPP_MeleeHitSubsystem::SweepNow(FSwing& Swing)
+{
+	ACharacter* Attacker = Swing.Attacker.Get();
+	UWorld* World = GetWorld();
+
+	const FCollisionQueryParams QueryParams = MakeQueryParams(Attacker);
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(SweepRadius);
+
+	const FCollisionResponseParams ResponseParams = MakeResponseParams();
+
+	TArray<FHitResult> Hits;
+	for (int32 SweepIndex = 0; SweepIndex < FMath::Max(ArcSweeps, 1); ++SweepIndex)
+	{
+		const FVector End = Swing.Origin + GetSweepDirection(Swing, SweepIndex) * Swing.Reach;
+		World->SweepMultiByChannel(Hits, Swing.Origin, End, FQuat::Identity, SweepChannel, Shape, QueryParams,
+		                           ResponseParams);
+		INC_DWORD_STAT(STAT_MeleeSweeps);
+
+		for (const FHitResult& Hit : Hits)
+			DeliverHit(Swing, Attacker, Hit.GetActor());
+	}
+
+	SwingHits.Reset();
+}
+
+void UCPP_MeleeHitSubsystem::ConsumeResults()
+{
+	if (InFlightSwings.IsEmpty()) return;
+
+	CPP_PROFILE_SCOPE(MeleeHitResults);
+
+	UWorld* World = GetWorld();
+
+	// Iterate on a copy, TakeAttack handlers may start new swings
+	TArray<FSwing> Swings = MoveTemp(InFlightSwings);
+	InFlightSwings.Reset();
+
+	for (FSwing& Swing : Swings)
+	{
+		ACharacter* Attacker = Swing.Attacker.Get();
+		if (!Attacker) continue;
+
+		// Hits are delivered once every sweep of the swing has a result, so deduplication sees all of them
+		SweepResults.Reset();
+		SweepResults.SetNum(Swing.Handles.Num());
+		bool bPending = false;
+		for (int32 SweepIndex = 0; SweepIndex < Swing.Handles.Num(); ++SweepIndex)
+			if (!World->QueryTraceData(Swing.Handles[SweepIndex], SweepResults[SweepIndex])
+				&& World->IsTraceHandleValid(Swing.Handles[SweepIndex], false))
+				bPending = true;
+
+		if (bPending)
+		{
+			InFlightSwings.Add(MoveTemp(Swing));
+			continue;
+		}
+
+		for (const FTraceDatum& Datum : SweepResults)
+			for (const FHitResult& Hit : Datum.OutHits)
+				DeliverHit(Swing, Attacker, Hit.GetActor());
+
+		SwingHits.Reset();
+	}
+
+	SweepResults.Reset();
+}
+
+void UCPP_MeleeHitSubsystem::SubmitQueuedSwings()
+{
+	UWorld* World = GetWorld();
+	const FCollisionShape Shape = FCollisionShape::MakeSphere(SweepRadius);
+	const FCollisionResponseParams ResponseParams = MakeResponseParams();
+
+	for (FSwing& Swing : QueuedSwings)
+	{
+		const ACharacter* Attacker = Swing.Attacker.Get();
+		if (!Attacker) continue;
+
+		const FCollisionQueryParams QueryParams = MakeQueryParams(Attacker);
+		for (int32 SweepIndex = 0; SweepIndex < FMath::Max(ArcSweeps, 1); ++SweepIndex)
+		{
+			const FVector End = Swing.Origin + GetSweepDirection(Swing, SweepIndex) * Swing.Reach;
+			Swing.Handles.Add(World->AsyncSweepByChannel(EAsyncTraceType::Multi, Swing.Origin, End, FQuat::Identity,
+			                                             SweepChannel, Shape, QueryParams, ResponseParams));
+			INC_DWORD_STAT(STAT_MeleeSweeps);
+		}
+
+		InFlightSwings.Add(MoveTemp(Swing));
+	}
+
+	QueuedSwings.Reset();
+}
+
+void UCPP_MeleeHitSubsystem::DeliverHit(const FSwing& Swing, ACharacter* Attacker, AActor* Actor)
+{
+	if (!Actor || Actor == Attacker) return;
+
+	bool bAlreadyHit = false;
+	SwingHits.Add(Actor, &bAlreadyHit);
+	if (bAlreadyHit) return;
+
+	ICPP_AttackTarget* Target = Cast<ICPP_AttackTarget>(Actor);
+	if (!Target) return;
+
+	if (!bFriendlyFire && Attacker->IsA<ACPP_EnemyCharacterBase>() && Actor->IsA<ACPP_EnemyCharacterBase>())
+		return;
+
+	INC_DWORD_STAT(STAT_MeleeHits);
+	Target->TakeAttack(Attacker, Swing.Damage);
+}
@@ -0,0 +1,228 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_PerceptionSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CharacterBase.h"
+#include "CPP_LineOfSightSubsystem.h"
+#include "CPP_TargetIndexSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Perception"), STAT_Perception, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Observers Updated"), STAT_PerceptionObservers, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Observers Deferred"), STAT_PerceptionDeferred, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Cone Tests"), STAT_PerceptionConeTests, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Perception Sight Queries"), STAT_PerceptionSightQueries, STATGROUP_ArenaFighter);
+
+void UCPP_PerceptionSubsystem::Register(ACPP_CharacterBase* Character)
+{
+	if (!Character || IsRegistered(Character)) return;
+
+	FObserver& Observer = Observers.AddDefaulted_GetRef();
+	Observer.Character = Character;
+	Observer.NextUpdateTime = GetWorld()->GetTimeSeconds() + FMath::FRand() * Character->GetSensingInterval();
+}
+
+void UCPP_PerceptionSubsystem::Unregister(ACPP_CharacterBase* Character)
+{
+	const int32 Index = Observers.IndexOfByPredicate([Character](const FObserver& Observer)
+	{
+		return Observer.Character == Character;
+	});
+	if (Index == INDEX_NONE) return;
+
+	// Updates may unregister characters through Blueprint events; compact after the frame's pass instead
+	if (bIsUpdating)
+	{
+		Observers[Index].Character = nullptr;
+		return;
+	}
+
+	Observers.RemoveAt(Index);
+	if (Index < Cursor)
+		Cursor--;
+	if (Cursor >= Observers.Num())
+		Cursor = 0;
+}
+
+bool UCPP_PerceptionSubsystem::IsRegistered(const ACPP_CharacterBase* Character) const
+{
+	return Observers.ContainsByPredicate([Character](const FObserver& Observer)
+	{
+		return Observer.Character == Character;
+	});
+}
+
+void UCPP_PerceptionSubsystem::SetIntervalScale(ACPP_CharacterBase* Character, float IntervalScale)
+{
+	FObserver* Found = Observers.FindByPredicate([Character](const FObserver& Observer)
+	{
+		return Observer.Character == Character;
+	});
+
+	if (Found)
+		Found->IntervalScale = FMath::Max(IntervalScale, MinIntervalScale);
+}
+
+void UCPP_PerceptionSubsystem::Deinitialize()
+{
+	Observers.Empty();
+	Cursor = 0;
+	Candidates.Empty();
+	SeenPawns.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_PerceptionSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	UpdatesLastFrame = 0;
+	DeferredLastFrame = 0;
+
+	const UCPP_TargetIndexSubsystem* TargetIndex = GetWorld()->GetSubsystem<UCPP_TargetIndexSubsystem>();
+	if (TargetIndex && !Observers.IsEmpty())
+	{
+		CPP_PROFILE_SCOPE_BUCKET(Perception, Sensing);
+
+		UCPP_LineOfSightSubsystem* LineOfSight = GetWorld()->GetSubsystem<UCPP_LineOfSightSubsystem>();
+		const double BudgetEnd = FPlatformTime::Seconds() + BudgetMicroseconds * 1e-6;
+
+		bIsUpdating = true;
+		const int32 NumObservers = Observers.Num();
+		int32 Visited = 0;
+		for (; Visited < NumObservers; ++Visited)
+		{
+			FObserver& Observer = Observers[Cursor];
+			Cursor = (Cursor + 1) % NumObservers;
+
+			ACPP_CharacterBase* Character = Observer.Character.Get();
+			if (!Character || Observer.NextUpdateTime > Now) continue;
+
+			Observer.NextUpdateTime = Now + Character->GetSensingInterval() * Observer.IntervalScale;
+			if (Character->IsDead() || Character->IsHidden()) continue;
+
+			UpdateObserver(*Character, *TargetIndex, LineOfSight);
+			UpdatesLastFrame++;
+
+			if (FPlatformTime::Seconds() >= BudgetEnd)
+			{
+				Visited++;
+				break;
+			}
+		}
+		bIsUpdating = false;
+
+		// Observers due but left for the next frames because the budget ran out
+		for (int32 Index = Cursor; Visited < NumObservers; ++Visited, Index = (Index + 1) % NumObservers)
+			if (Observers[Index].Character.IsValid() && Observers[Index].NextUpdateTime <= Now)
+				DeferredLastFrame++;
+	}
+
+	for (int32 Index = Observers.Num() - 1; Index >= 0; --Index)
+		if (!Observers[Index].Character.IsValid())
+		{
+			Observers.RemoveAt(Index, 1, EAllowShrinking::No);
+			if (Index < Cursor)
+				Cursor--;
+		}
+	if (Cursor >= Observers.Num())
+		Cursor = 0;
+
+	SET_DWORD_STAT(STAT_PerceptionObservers, UpdatesLastFrame);
+	CSV_CUSTOM_STAT(ArenaFighter, PerceptionObservers, UpdatesLastFrame, ECsvCustomStatOp::Set);
+	SET_DWORD_STAT(STAT_PerceptionDeferred, DeferredLastFrame);
+	CSV_CUSTOM_STAT(ArenaFighter, PerceptionDeferred, DeferredLastFrame, ECsvCustomStatOp::Set);
+}
+
+TStatId UCPP_PerceptionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_PerceptionSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_PerceptionSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCPP_PerceptionSubsystem::UpdateObserver(ACPP_CharacterBase& Observer, const UCPP_TargetIndexSubsystem& TargetIndex,
+                                               UCPP_LineOfSightSubsystem* LineOfSight)
+{
+	FVector EyesLocation;
+	FRotator EyesRotation;
+	Observer.GetActorEyesViewPoint(EyesLocation, EyesRotation);
+
+	const FVector Forward = EyesRotation.Vector();
+	const float SightRadiusSquared = FMath::Square(Observer.GetSightRadius());
+	const float ConeCosine = FMath::Cos(FMath::DegreesToRadians(Observer.GetPeripheralVisionAngle()));
+	const float ConeCosineSquared = ConeCosine * ConeCosine;
+	const bool bOnlySensePlayers = Observer.ShouldOnlySensePlayers();
+	const bool bAsyncTraces = LineOfSight && LineOfSight->bAsyncTraces;
+	const TSet<APawn*>& DetectedPawns = Observer.GetDetectedPawns();
+
+	// Only the characters in the cells around the observer; a cone up to 90 degrees also skips the cells behind it
+	Candidates.Reset();
+	if (ConeCosine >= 0.0f)
+		TargetIndex.QueryInFront(EyesLocation, Forward, Observer.GetSightRadius(), &Observer, Candidates);
+	else
+		TargetIndex.QueryInRadius(EyesLocation, Observer.GetSightRadius(), &Observer, Candidates);
+
+	SeenPawns.Reset();
+	int32 ConeTests = 0;
+	int32 SightQueries = 0;
+
+	for (ACPP_CharacterBase* Candidate : Candidates)
+	{
+		if (Candidate->IsDead() || Candidate->IsHidden() || (bOnlySensePlayers && !Candidate->IsPlayerControlled())) continue;
+
+		ConeTests++;
+		const FVector CandidateLocation = Candidate->GetActorLocation();
+		const FVector ToCandidate = CandidateLocation - EyesLocation;
+		const float DistanceSquared = ToCandidate.SizeSquared();
+		if (DistanceSquared > SightRadiusSquared) continue;
+
+		// Dot >= Cosine * Distance, compared squared to avoid the square root
+		const float Dot = FVector::DotProduct(Forward, ToCandidate);
+		const bool bInCone = ConeCosine >= 0.0f
+			                     ? Dot >= 0.0f && Dot * Dot >= ConeCosineSquared * DistanceSquared
+			                     : Dot >= 0.0f || Dot * Dot <= ConeCosineSquared * DistanceSquared;
+		if (!bInCone) continue;
+
+		SightQueries++;
+		if (bAsyncTraces)
+		{
+			// A pending answer keeps the current state until the trace comes back
+			const ECPP_LineOfSight Sight = LineOfSight->QueryLineOfSight(&Observer, Candidate);
+			if (Sight == ECPP_LineOfSight::Visible || (Sight == ECPP_LineOfSight::Pending && DetectedPawns.Contains(Candidate)))
+				SeenPawns.Add(Candidate);
+		}
+		else
+		{
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ArenaFighterPerception), true, &Observer);
+			QueryParams.AddIgnoredActor(Candidate);
+			if (!GetWorld()->LineTraceTestByChannel(EyesLocation, CandidateLocation, TraceChannel, QueryParams))
+			{
+				SeenPawns.Add(Candidate);
+				if (LineOfSight)
+					LineOfSight->MarkVisible(&Observer, Candidate);
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY(STAT_PerceptionConeTests, ConeTests);
+	INC_DWORD_STAT_BY(STAT_PerceptionSightQueries, SightQueries);
+
+	AddedPawns.Reset();
+	RemovedPawns.Reset();
+	for (APawn* Pawn : SeenPawns)
+		if (!DetectedPawns.Contains(Pawn))
+			AddedPawns.Add(Pawn);
+	for (APawn* Pawn : DetectedPawns)
+		if (!SeenPawns.Contains(Pawn))
+			RemovedPawns.Add(Pawn);
+
+	if (!AddedPawns.IsEmpty() || !RemovedPawns.IsEmpty())
+		Observer.ApplyPerception(AddedPawns, RemovedPawns);
+}
@@ -3,21 +3,39 @@
 
 #include "CPP_PlayerAttackState.h"
 
+#include "ArenaFighter.h"
+#include "CPP_StateMachineBase.h"
+#include "Animation/AnimInstance.h"
+#include "GameFramework/Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("AttackState Enter"), STAT_AttackStateEnter, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Attack Montages Played"), STAT_AttackMontagesPlayed, STATGROUP_ArenaFighter);
+
 void UCPP_PlayerAttackState::Init(UObject* Context)
 {
 	Super::Init(Context);
-	AnimInstance = SkeletalMesh->GetAnimInstance();
+
+	// States created from a UCPP_StateMachineDefinition have no SkeletalMesh assigned and use the owner's mesh
+	if (SkeletalMesh)
+		AnimInstance = SkeletalMesh->GetAnimInstance();
+	else if (const ACharacter* Character = Cast<ACharacter>(Context))
+		AnimInstance = Character->GetMesh()->GetAnimInstance();
 }
 
 void UCPP_PlayerAttackState::OnEnter()
 {
 	Super::OnEnter();
+	CPP_PROFILE_SCOPE(AttackStateEnter);
+	INC_DWORD_STAT(STAT_AttackMontagesPlayed);
+
 	float animMontageLenght = AnimInstance->Montage_Play(AnimMontage);
 
 	if (animMontageLenght <= 0.0f)
 	{
 		FString outputMessage = TEXT("Failed to play attack anim montage");
+#if !UE_BUILD_SHIPPING
 		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, outputMessage);
+#endif
 		UE_LOG(LogTemp, Error, TEXT("%s"), *outputMessage);
 		return;
 	}
@@ -30,6 +48,38 @@ void UCPP_PlayerAttackState::OnMontageEnded(UAnimMontage* Montage, bool bInterru
 	if(Montage == AnimMontage)
 	{
 		AnimInstance->OnMontageEnded.RemoveDynamic(this, &UCPP_PlayerAttackState::OnMontageEnded);
-		// TODO to locomotion state
+
+		UCPP_StateMachineBase* Machine = Cast<UCPP_StateMachineBase>(GetOuter());
+		if (Machine && !MontageEndedTrigger.IsNone())
+			Machine->FireTrigger(MontageEndedTrigger);
 	}
 }
+
+void UCPP_PlayerAttackState::EnterShared(FCPP_StateContext& Context) const
+{
+	Super::EnterShared(Context);
+	CPP_PROFILE_SCOPE(AttackStateEnter);
+	INC_DWORD_STAT(STAT_AttackMontagesPlayed);
+
+	float animMontageLenght = Context.AnimInstance ? Context.AnimInstance->Montage_Play(AnimMontage) : 0.0f;
+
+	if (animMontageLenght <= 0.0f)
+	{
+		FString outputMessage = TEXT("Failed to play attack anim montage");
+#if !UE_BUILD_SHIPPING
+		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, outputMessage);
+#endif
+		UE_LOG(LogTemp, Error, TEXT("%s"), *outputMessage);
+		return;
+	}
+
+	if (MontageEndedTrigger.IsNone() || !Context.Machine) return;
+
+	// The state is shared, so the end notification is bound per montage instance to the owning machine
+	FOnMontageEnded EndDelegate = FOnMontageEnded::CreateWeakLambda(
+		Context.Machine, [Machine = Context.Machine, Trigger = MontageEndedTrigger](UAnimMontage*, bool)
+		{
+			Machine->FireTrigger(Trigger);
+		});
+	Context.AnimInstance->Montage_SetEndDelegate(EndDelegate, AnimMontage);
+}
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_RoundSpawnSchedulerSubsystem.h"
+
+#include "Algo/Sort.h"
+#include "CPP_AttackTokenSubsystem.h"
+#include "CPP_CombatRecorderSubsystem.h"
+#include "CPP_CrowdSubsystem.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_RoundStreamingSubsystem.h"
+#include "CPP_RoundsConfigurations.h"
+#include "Engine/AssetManager.h"
+#include "GameFramework/PlayerController.h"
+
+void UCPP_RoundSpawnSchedulerSubsystem::QueueWave(U_CPP_RoundsConfigurations* Configurations, int32 Round,
+                                                  const TArray<AActor*>& SpawnPoints, int32 EnemyCount)
+{
+	if (!Configurations || SpawnPoints.IsEmpty() || EnemyCount <= 0) return;
+
+	// A replay streams the round and spawns the recorded enemies itself
+	UCPP_CombatRecorderSubsystem* Recorder = GetWorld()->GetSubsystem<UCPP_CombatRecorderSubsystem>();
+	if (Recorder && !Recorder->AcceptsLiveInput()) return;
+
+	const FCPP_RoundsConfig* Config = Configurations->FindRoundConfig(Round);
+	if (!Config)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No rounds configuration covers round %d"), Round);
+		return;
+	}
+
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+	Config->GetEnemyClasses(EnemyClasses);
+	if (EnemyClasses.IsEmpty()) return;
+
+	// Nothing of the round starts when the wave cannot spawn anywhere
+	TArray<AActor*> SortedSpawnPoints = SpawnPoints;
+	SortedSpawnPoints.RemoveAll([](const AActor* SpawnPoint) { return !SpawnPoint; });
+	if (SortedSpawnPoints.IsEmpty()) return;
+	SortByVisibility(SortedSpawnPoints);
+
+	if (Recorder)
+		Recorder->RecordRoundStart(Configurations, Round);
+
+	if (UCPP_AttackTokenSubsystem* AttackTokens = GetWorld()->GetSubsystem<UCPP_AttackTokenSubsystem>())
+		AttackTokens->ApplyRoundConfig(*Config);
+
+	if (UCPP_RoundStreamingSubsystem* RoundStreaming = GetWorld()->GetSubsystem<UCPP_RoundStreamingSubsystem>())
+		RoundStreaming->BeginRound(Configurations, Round);
+
+	FRandomStream ClassStream(Round);
+
+	FPendingWave& Wave = Waves.AddDefaulted_GetRef();
+	Wave.Round = Round;
+	Wave.Spawns.Reserve(EnemyCount);
+	for (int32 Index = 0; Index < EnemyCount; ++Index)
+		Wave.Spawns.Add(EnemyClasses[ClassStream.RandRange(0, EnemyClasses.Num() - 1)]);
+	Wave.SpawnPoints.Append(SortedSpawnPoints);
+
+	UCPP_CrowdSubsystem* Crowd = Config->CrowdCount > 0 ? GetWorld()->GetSubsystem<UCPP_CrowdSubsystem>() : nullptr;
+
+	// The classes load while earlier waves spawn; the handle completes at once when they are already resident.
+	// The crowd's own assets load with them, and the crowd keeps the handle while it uses the classes.
+	TArray<FSoftObjectPath> AssetPaths;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+		AssetPaths.Add(EnemyClass.ToSoftObjectPath());
+	if (Crowd)
+		Crowd->GetAssetsToLoad(AssetPaths);
+	Wave.LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority);
+
+	if (Crowd)
+	{
+		TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> CrowdClasses;
+		TArray<FTransform> CrowdTransforms;
+		CrowdClasses.Reserve(Config->CrowdCount);
+		CrowdTransforms.Reserve(Config->CrowdCount);
+
+		// Spread the crowd around the spawn points so it does not start as a single column
+		for (int32 Index = 0; Index < Config->CrowdCount; ++Index)
+		{
+			CrowdClasses.Add(EnemyClasses[ClassStream.RandRange(0, EnemyClasses.Num() - 1)]);
+
+			FTransform CrowdTransform = SortedSpawnPoints[Index % SortedSpawnPoints.Num()]->GetActorTransform();
+			const float Angle = ClassStream.FRandRange(0.0f, UE_TWO_PI);
+			const float Distance = ClassStream.FRandRange(0.0f, CrowdSpreadRadius);
+			CrowdTransform.AddToTranslation(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Distance);
+			CrowdTransforms.Add(CrowdTransform);
+		}
+
+		Crowd->SpawnCrowd(CrowdClasses, CrowdTransforms, Wave.LoadHandle);
+	}
+}
+
+void UCPP_RoundSpawnSchedulerSubsystem::Deinitialize()
+{
+	for (FPendingWave& Wave : Waves)
+		if (Wave.LoadHandle.IsValid())
+			Wave.LoadHandle->CancelHandle();
+	Waves.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_RoundSpawnSchedulerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SpawnedLastFrame = 0;
+	if (Waves.IsEmpty()) return;
+
+	FPendingWave& Wave = Waves[0];
+
+	// Never block on a load, wait for the wave's classes instead
+	if (!Wave.bClassesResolved)
+	{
+		if (Wave.LoadHandle.IsValid() && Wave.LoadHandle->IsLoadingInProgress()) return;
+		ResolveWaveClasses(Wave);
+	}
+
+	TArray<AActor*> SpawnPoints;
+	for (const TWeakObjectPtr<AActor>& SpawnPoint : Wave.SpawnPoints)
+		if (AActor* Actor = SpawnPoint.Get())
+			SpawnPoints.Add(Actor);
+
+	if (SpawnPoints.IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Round %d: every spawn point was destroyed, %d enemies are not spawned"),
+		       Wave.Round, Wave.Spawns.Num() - Wave.NextSpawn);
+		Wave.NextSpawn = Wave.Spawns.Num();
+	}
+
+	// The player may have turned since the last batch, score the points again
+	const int32 NumHidden = SpawnPoints.IsEmpty() ? 0 : SortByVisibility(SpawnPoints);
+
+	UCPP_EnemyPoolSubsystem* EnemyPool = GetWorld()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+	const double BudgetEnd = FPlatformTime::Seconds() + BudgetMilliseconds * 1e-3;
+
+	for (int32 BatchIndex = 0; Wave.NextSpawn < Wave.Spawns.Num(); ++BatchIndex)
+	{
+		UClass* EnemyClass = Wave.Spawns[Wave.NextSpawn].Get();
+
+		// Every point once, least visible first, then only the hidden ones, or the least visible if none is
+		const AActor* SpawnPoint = BatchIndex < SpawnPoints.Num()
+			                           ? SpawnPoints[BatchIndex]
+			                           : SpawnPoints[(BatchIndex - SpawnPoints.Num()) % FMath::Max(NumHidden, 1)];
+		const FTransform SpawnTransform = SpawnPoint->GetActorTransform();
+
+		Wave.NextSpawn++;
+		SpawnedLastFrame++;
+
+		if (EnemyPool)
+			EnemyPool->SpawnEnemy(EnemyClass, SpawnTransform);
+		else
+		{
+			FActorSpawnParameters spawnParameters;
+			spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+			GetWorld()->SpawnActor<ACPP_EnemyCharacterBase>(EnemyClass, SpawnTransform, spawnParameters);
+		}
+
+		if (FPlatformTime::Seconds() >= BudgetEnd) break;
+	}
+
+	if (Wave.NextSpawn >= Wave.Spawns.Num())
+	{
+		const int32 Round = Wave.Round;
+		Waves.RemoveAt(0);
+		OnWaveSpawned.Broadcast(Round);
+	}
+}
+
+TStatId UCPP_RoundSpawnSchedulerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_RoundSpawnSchedulerSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_RoundSpawnSchedulerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+int32 UCPP_RoundSpawnSchedulerSubsystem::SortByVisibility(TArray<AActor*>& SpawnPoints) const
+{
+	// Without a player every point is hidden
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!PlayerController) return SpawnPoints.Num();
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	TArray<TPair<float, AActor*>> ScoredPoints;
+	ScoredPoints.Reserve(SpawnPoints.Num());
+	for (AActor* SpawnPoint : SpawnPoints)
+		ScoredPoints.Emplace(FVector::DotProduct(ViewDirection, (SpawnPoint->GetActorLocation() - ViewLocation).GetSafeNormal()), SpawnPoint);
+	Algo::SortBy(ScoredPoints, [](const TPair<float, AActor*>& ScoredPoint) { return ScoredPoint.Key; });
+
+	int32 NumHidden = 0;
+	for (int32 Index = 0; Index < ScoredPoints.Num(); ++Index)
+	{
+		SpawnPoints[Index] = ScoredPoints[Index].Value;
+		NumHidden += ScoredPoints[Index].Key < HiddenViewScore;
+	}
+	return NumHidden;
+}
+
+void UCPP_RoundSpawnSchedulerSubsystem::ResolveWaveClasses(FPendingWave& Wave) const
+{
+	Wave.bClassesResolved = true;
+
+	TSet<TSoftClassPtr<ACPP_EnemyCharacterBase>> MissingClasses;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : Wave.Spawns)
+		if (!EnemyClass.Get())
+			MissingClasses.Add(EnemyClass);
+
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : MissingClasses)
+		UE_LOG(LogTemp, Error, TEXT("Round %d: enemy class %s could not be loaded, its spawns are skipped"),
+		       Wave.Round, *EnemyClass.ToString());
+
+	if (!MissingClasses.IsEmpty())
+		Wave.Spawns.RemoveAll([](const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass) { return !EnemyClass.Get(); });
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_RoundStreamingSubsystem.h"
+
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_RoundsConfigurations.h"
+#include "Engine/AssetManager.h"
+
+void UCPP_RoundStreamingSubsystem::BeginRound(U_CPP_RoundsConfigurations* InConfigurations, int32 Round)
+{
+	if (Configurations != InConfigurations)
+	{
+		ReleaseRoundsBefore(MAX_int32);
+		Configurations = InConfigurations;
+	}
+
+	CurrentRound = Round;
+
+	RequestRound(Round);
+	RequestRound(Round + 1);
+	ReleaseRoundsBefore(Round);
+}
+
+void UCPP_RoundStreamingSubsystem::RequestRound(int32 Round)
+{
+	if (!Configurations || RoundHandles.Contains(Round)) return;
+
+	const FCPP_RoundsConfig* Config = Configurations->FindRoundConfig(Round);
+	if (!Config) return;
+
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+	Config->GetEnemyClasses(EnemyClasses);
+
+	TArray<FSoftObjectPath> AssetPaths;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+		AssetPaths.Add(EnemyClass.ToSoftObjectPath());
+
+	if (AssetPaths.IsEmpty()) return;
+
+	const double RequestTime = FPlatformTime::Seconds();
+	FStreamableDelegate OnStreamed = FStreamableDelegate::CreateWeakLambda(this, [this, Round, RequestTime]()
+	{
+		UE_LOG(LogTemp, Log, TEXT("Round %d enemies streamed in %.1f ms"),
+		       Round, (FPlatformTime::Seconds() - RequestTime) * 1000.0);
+
+		RequestRoundWeapons(Round);
+	});
+
+	RoundHandles.Add(Round).Add(UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths, OnStreamed, FStreamableManager::AsyncLoadHighPriority));
+}
+
+void UCPP_RoundStreamingSubsystem::RequestRoundWeapons(int32 Round)
+{
+	TArray<TSharedPtr<FStreamableHandle>>* Handles = RoundHandles.Find(Round);
+	const FCPP_RoundsConfig* Config = Configurations ? Configurations->FindRoundConfig(Round) : nullptr;
+	if (!Handles || !Config) return;
+
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+	Config->GetEnemyClasses(EnemyClasses);
+
+	TArray<FSoftObjectPath> AssetPaths;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+	{
+		const ACPP_EnemyCharacterBase* EnemyCDO = EnemyClass.Get() ? EnemyClass.Get()->GetDefaultObject<ACPP_EnemyCharacterBase>() : nullptr;
+		if (!EnemyCDO)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Round %d: enemy class %s could not be loaded"), Round, *EnemyClass.ToString());
+			continue;
+		}
+
+		for (const TSoftClassPtr<ACPP_Weapon>& WeaponClass : EnemyCDO->GetWeaponClasses())
+			if (!WeaponClass.IsNull())
+				AssetPaths.AddUnique(WeaponClass.ToSoftObjectPath());
+	}
+
+	if (AssetPaths.IsEmpty()) return;
+
+	Handles->Add(UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		AssetPaths, FStreamableDelegate(), FStreamableManager::AsyncLoadHighPriority));
+}
+
+bool UCPP_RoundStreamingSubsystem::IsRoundLoaded(int32 Round) const
+{
+	if (!Configurations) return false;
+
+	const FCPP_RoundsConfig* Config = Configurations->FindRoundConfig(Round);
+	if (!Config) return false;
+
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+	Config->GetEnemyClasses(EnemyClasses);
+
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+	{
+		if (!EnemyClass.Get())
+			return false;
+
+		for (const TSoftClassPtr<ACPP_Weapon>& WeaponClass : EnemyClass.Get()->GetDefaultObject<ACPP_EnemyCharacterBase>()->GetWeaponClasses())
+			if (!WeaponClass.IsNull() && !WeaponClass.Get())
+				return false;
+	}
+
+	return true;
+}
+
+void UCPP_RoundStreamingSubsystem::Deinitialize()
+{
+	ReleaseRoundsBefore(MAX_int32);
+	Configurations = nullptr;
+
+	Super::Deinitialize();
+}
+
+bool UCPP_RoundStreamingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCPP_RoundStreamingSubsystem::ReleaseRoundsBefore(int32 Round)
+{
+	for (TMap<int32, TArray<TSharedPtr<FStreamableHandle>>>::TIterator It = RoundHandles.CreateIterator(); It; ++It)
+		if (It.Key() < Round)
+		{
+			for (const TSharedPtr<FStreamableHandle>& Handle : It.Value())
+				if (Handle.IsValid())
+					Handle->ReleaseHandle();
+			It.RemoveCurrent();
+		}
+}
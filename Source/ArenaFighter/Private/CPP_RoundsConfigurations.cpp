@@ -3,4 +3,27 @@
 
 #include "CPP_RoundsConfigurations.h"
 
+void U_CPP_RoundsConfigurations::PostLoad()
+{
+	Super::PostLoad();
 
+	for (FCPP_RoundsConfig& Config : Data.Configurations)
+		Config.SyncSoftEnemies();
+}
+
+const FCPP_RoundsConfig* U_CPP_RoundsConfigurations::FindRoundConfig(int32 Round) const
+{
+	return Data.Configurations.FindByPredicate([Round](const FCPP_RoundsConfig& Config)
+	{
+		return Round >= Config.LevelsSpan.X && Round <= Config.LevelsSpan.Y;
+	});
+}
+
+bool U_CPP_RoundsConfigurations::GetRoundConfig(int32 Round, FCPP_RoundsConfig& OutConfig) const
+{
+	const FCPP_RoundsConfig* Config = FindRoundConfig(Round);
+	if (!Config) return false;
+
+	OutConfig = *Config;
+	return true;
+}
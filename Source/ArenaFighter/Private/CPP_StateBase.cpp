@@ -3,30 +3,89 @@
 
 #include "CPP_StateBase.h"
 
+#include "CPP_CombatTrace.h"
+
 void UCPP_StateBase::Init(UObject* Context)
 {
-	StateName = this->GetClass()->GetDisplayNameText();
+	CacheClassInfo();
 	this->OwnerContext = Context;
 	OnInitEvent();
 }
 
 void UCPP_StateBase::OnEnter()
 {
-	FString outputMessage = TEXT("State.OnEnter - " + StateName.ToString());
-	if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, outputMessage);
-	UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
-	OnEnterEvent();
+	CPP_COMBAT_TRACE(StateEnter, OwnerContext, GetClass(), 0.0f);
+
+	if (FCPP_CombatTrace::IsVerbose())
+	{
+		FString outputMessage = TEXT("State.OnEnter - " + StateName.ToString());
+		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, outputMessage);
+		UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
+	}
+
+	if (bImplementsEnterEvent)
+		OnEnterEvent();
 }
 
 void UCPP_StateBase::OnTick(float deltaTime)
 {
-	OnTickEvent(deltaTime);
+	if (bImplementsTickEvent)
+		OnTickEvent(deltaTime);
 }
 
 void UCPP_StateBase::OnExit()
 {
-	FString outputMessage = TEXT("State.OnExit - " + StateName.ToString());
-	if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow, outputMessage);
-	UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
-	OnExitEvent();
+	CPP_COMBAT_TRACE(StateExit, OwnerContext, GetClass(), 0.0f);
+
+	if (FCPP_CombatTrace::IsVerbose())
+	{
+		FString outputMessage = TEXT("State.OnExit - " + StateName.ToString());
+		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow, outputMessage);
+		UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
+	}
+
+	if (bImplementsExitEvent)
+		OnExitEvent();
+}
+
+void UCPP_StateBase::InitShared()
+{
+	CacheClassInfo();
+}
+
+void UCPP_StateBase::EnterShared(FCPP_StateContext& Context) const
+{
+	CPP_COMBAT_TRACE(StateEnter, Context.OwnerContext, GetClass(), 0.0f);
+
+	if (FCPP_CombatTrace::IsVerbose())
+	{
+		FString outputMessage = TEXT("State.OnEnter - " + StateName.ToString());
+		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, outputMessage);
+		UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
+	}
+}
+
+void UCPP_StateBase::TickShared(FCPP_StateContext& Context, float deltaTime) const
+{
+}
+
+void UCPP_StateBase::ExitShared(FCPP_StateContext& Context) const
+{
+	CPP_COMBAT_TRACE(StateExit, Context.OwnerContext, GetClass(), 0.0f);
+
+	if (FCPP_CombatTrace::IsVerbose())
+	{
+		FString outputMessage = TEXT("State.OnExit - " + StateName.ToString());
+		if (GEngine) GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Yellow, outputMessage);
+		UE_LOG(LogTemp, Log, TEXT("%s"), *outputMessage);
+	}
+}
+
+void UCPP_StateBase::CacheClassInfo()
+{
+	const UClass* Class = GetClass();
+	StateName = Class->GetDisplayNameText();
+	bImplementsEnterEvent = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnEnterEvent));
+	bImplementsTickEvent = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnTickEvent));
+	bImplementsExitEvent = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnExitEvent));
 }
@@ -3,6 +3,14 @@
 
 #include "CPP_StateMachineBase.h"
 
+#include "ArenaFighter.h"
+#include "CPP_StateMachineManagerSubsystem.h"
+#include "CPP_TransitionGuard.h"
+#include "GameFramework/Character.h"
+
+DECLARE_CYCLE_STAT(TEXT("StateMachine OnTick"), STAT_StateMachineOnTick, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("StateMachine SetState"), STAT_StateMachineSetState, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("SetState Calls"), STAT_SetStateCalls, STATGROUP_ArenaFighter);
 
 UCPP_StateMachineBase::UCPP_StateMachineBase()
 {
@@ -11,26 +19,179 @@ UCPP_StateMachineBase::UCPP_StateMachineBase()
 void UCPP_StateMachineBase::Init(UObject* Context)
 {
 	this->OwnerContext = Context;
+
+	StateContext = FCPP_StateContext();
+	StateContext.OwnerContext = Context;
+	StateContext.Machine = this;
+	if (const ACharacter* Character = Cast<ACharacter>(Context))
+		StateContext.AnimInstance = Character->GetMesh() ? Character->GetMesh()->GetAnimInstance() : nullptr;
+	else if (const USkeletalMeshComponent* Mesh = Cast<USkeletalMeshComponent>(Context))
+		StateContext.AnimInstance = Mesh->GetAnimInstance();
+
+	const UClass* Class = GetClass();
+	bImplementsTickEvent = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateMachineBase, OnTickEvent));
+	bImplementsStateChangedEvent = Class->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateMachineBase, OnStateChangedEvent));
+
+	if (Definition)
+		BuildFromDefinition();
+
+	if (bTickFromManager)
+	{
+		const UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(Context, EGetWorldErrorMode::ReturnNull) : nullptr;
+		if (UCPP_StateMachineManagerSubsystem* Manager = World ? World->GetSubsystem<UCPP_StateMachineManagerSubsystem>() : nullptr)
+			Manager->Register(this);
+	}
+
 	OnInitEvent();
 }
 
 void UCPP_StateMachineBase::OnTick(float deltaTime)
 {
-	if (CurrentState && CurrentState->IsValidLowLevel())
+	CPP_PROFILE_SCOPE_BUCKET(StateMachineOnTick, StateMachines);
+
+	if (bHasAutomaticTransitions)
+		ApplyTransition(EvaluateTransitions(NAME_None));
+
+	TickActiveState(deltaTime);
+}
+
+void UCPP_StateMachineBase::ApplyTransition(int32 TargetIndex)
+{
+	if (DefinitionStates.IsValidIndex(TargetIndex))
+		SetState(DefinitionStates[TargetIndex]);
+}
+
+void UCPP_StateMachineBase::TickActiveState(float deltaTime)
+{
+	StateContext.TimeInState += deltaTime;
+
+	if (IsCurrentStateShared())
+		CurrentState->TickShared(StateContext, deltaTime);
+	else if (CurrentState && CurrentState->IsValidLowLevel())
 		CurrentState->OnTick(deltaTime);
-	OnTickEvent(deltaTime);
+
+	if (bImplementsTickEvent)
+		OnTickEvent(deltaTime);
+}
+
+bool UCPP_StateMachineBase::FireTrigger(FName Trigger)
+{
+	if (Trigger.IsNone()) return false;
+
+	const int32 Target = EvaluateTransitions(Trigger);
+	if (Target == INDEX_NONE) return false;
+
+	ApplyTransition(Target);
+	return true;
+}
+
+bool UCPP_StateMachineBase::SetStateByName(FName StateName)
+{
+	const int32 Index = Definition ? Definition->FindStateIndex(StateName) : INDEX_NONE;
+	if (!DefinitionStates.IsValidIndex(Index)) return false;
+
+	SetState(DefinitionStates[Index]);
+	return true;
+}
+
+FName UCPP_StateMachineBase::GetCurrentStateName() const
+{
+	return Definition && Definition->States.IsValidIndex(CurrentStateIndex)
+		       ? Definition->States[CurrentStateIndex].Name
+		       : NAME_None;
+}
+
+int32 UCPP_StateMachineBase::EvaluateTransitions(FName Trigger) const
+{
+	for (const FCompiledTransition& Transition : CompiledTransitions)
+	{
+		if (Transition.Trigger != Trigger) continue;
+		if (Transition.From != INDEX_NONE && Transition.From != CurrentStateIndex) continue;
+		if (Transition.To == CurrentStateIndex) continue;
+		if (Transition.Guard && !Transition.Guard->CanTransition(this)) continue;
+
+		return Transition.To;
+	}
+
+	return INDEX_NONE;
 }
 
 void UCPP_StateMachineBase::SetState(UCPP_StateBase* NewState)
 {
 	if (CurrentState == NewState) return;
 
-	if (CurrentState && CurrentState->IsValidLowLevel())
+	CPP_PROFILE_SCOPE_BUCKET(StateMachineSetState, StateMachines);
+	INC_DWORD_STAT(STAT_SetStateCalls);
+
+	if (IsCurrentStateShared())
+		CurrentState->ExitShared(StateContext);
+	else if (CurrentState && CurrentState->IsValidLowLevel())
 		CurrentState->OnExit();
 
 	CurrentState = NewState;
-	OnStateChangedEvent();
+	CurrentStateIndex = NewState ? DefinitionStates.IndexOfByKey(NewState) : INDEX_NONE;
+	StateContext.TimeInState = 0.0f;
 
-	if (CurrentState && CurrentState->IsValidLowLevel())
+	if (bImplementsStateChangedEvent)
+		OnStateChangedEvent();
+
+	if (IsCurrentStateShared())
+		CurrentState->EnterShared(StateContext);
+	else if (CurrentState && CurrentState->IsValidLowLevel())
 		CurrentState->OnEnter();
 }
+
+void UCPP_StateMachineBase::BuildFromDefinition()
+{
+	DefinitionStates.Reset(Definition->States.Num());
+	CompiledTransitions.Reset(Definition->Transitions.Num());
+	bHasAutomaticTransitions = false;
+	bSharedStates = Definition->bShareStates;
+
+	if (bSharedStates)
+	{
+		DefinitionStates = Definition->GetSharedStates();
+	}
+	else
+	{
+		for (const FCPP_StateDefinition& StateDefinition : Definition->States)
+		{
+			UCPP_StateBase* State = StateDefinition.StateClass
+				                        ? NewObject<UCPP_StateBase>(this, StateDefinition.StateClass)
+				                        : nullptr;
+			if (State)
+				State->Init(OwnerContext);
+
+			DefinitionStates.Add(State);
+		}
+	}
+
+	for (int32 Index = 0; Index < DefinitionStates.Num(); ++Index)
+		if (!DefinitionStates[Index])
+			UE_LOG(LogTemp, Error, TEXT("State machine definition %s: state %s has no state class"),
+			       *Definition->GetName(), *Definition->States[Index].Name.ToString());
+
+	for (const FCPP_StateTransition& Transition : Definition->Transitions)
+	{
+		FCompiledTransition Compiled;
+		Compiled.From = Transition.From.IsNone() ? INDEX_NONE : Definition->FindStateIndex(Transition.From);
+		Compiled.To = Definition->FindStateIndex(Transition.To);
+		Compiled.Trigger = Transition.Trigger;
+		Compiled.Guard = Transition.Guard;
+
+		if (Compiled.To == INDEX_NONE || !DefinitionStates[Compiled.To]
+			|| (!Transition.From.IsNone() && Compiled.From == INDEX_NONE))
+		{
+			UE_LOG(LogTemp, Error, TEXT("State machine definition %s: skipping invalid transition %s -> %s"),
+			       *Definition->GetName(), *Transition.From.ToString(), *Transition.To.ToString());
+			continue;
+		}
+
+		bHasAutomaticTransitions |= Compiled.Trigger.IsNone();
+		CompiledTransitions.Add(Compiled);
+	}
+
+	const int32 InitialIndex = Definition->InitialState.IsNone() ? 0 : Definition->FindStateIndex(Definition->InitialState);
+	if (DefinitionStates.IsValidIndex(InitialIndex))
+		SetState(DefinitionStates[InitialIndex]);
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_StateMachineDefinition.h"
+
+#include "CPP_StateBase.h"
+
+#if WITH_EDITOR
+#include "Misc/DataValidation.h"
+#endif
+
+int32 UCPP_StateMachineDefinition::FindStateIndex(FName StateName) const
+{
+	return States.IndexOfByPredicate([StateName](const FCPP_StateDefinition& State) { return State.Name == StateName; });
+}
+
+const TArray<UCPP_StateBase*>& UCPP_StateMachineDefinition::GetSharedStates()
+{
+	if (SharedStates.Num() == States.Num()) return SharedStates;
+
+	SharedStates.Reset(States.Num());
+	for (const FCPP_StateDefinition& State : States)
+	{
+		UCPP_StateBase* SharedState = State.StateClass
+			                              ? NewObject<UCPP_StateBase>(this, State.StateClass, NAME_None, RF_Transient)
+			                              : nullptr;
+		if (SharedState)
+			SharedState->InitShared();
+
+		SharedStates.Add(SharedState);
+	}
+
+	return SharedStates;
+}
+
+#if WITH_EDITOR
+EDataValidationResult UCPP_StateMachineDefinition::IsDataValid(FDataValidationContext& Context) const
+{
+	EDataValidationResult Result = Super::IsDataValid(Context);
+
+	for (const FCPP_StateDefinition& State : States)
+	{
+		if (!State.StateClass)
+		{
+			Context.AddError(FText::Format(INVTEXT("State '{0}' has no state class"), FText::FromName(State.Name)));
+			Result = EDataValidationResult::Invalid;
+		}
+		else if (bShareStates
+			&& (State.StateClass->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnEnterEvent))
+				|| State.StateClass->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnTickEvent))
+				|| State.StateClass->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UCPP_StateBase, OnExitEvent))))
+		{
+			Context.AddWarning(FText::Format(INVTEXT("State '{0}' implements Blueprint events, which are not called for shared states"),
+			                                 FText::FromName(State.Name)));
+		}
+	}
+
+	if (!InitialState.IsNone() && FindStateIndex(InitialState) == INDEX_NONE)
+	{
+		Context.AddError(FText::Format(INVTEXT("Initial state '{0}' is not declared"), FText::FromName(InitialState)));
+		Result = EDataValidationResult::Invalid;
+	}
+
+	for (const FCPP_StateTransition& Transition : Transitions)
+		if ((!Transition.From.IsNone() && FindStateIndex(Transition.From) == INDEX_NONE)
+			|| FindStateIndex(Transition.To) == INDEX_NONE)
+		{
+			Context.AddError(FText::Format(INVTEXT("Transition '{0}' -> '{1}' references an undeclared state"),
+			                               FText::FromName(Transition.From), FText::FromName(Transition.To)));
+			Result = EDataValidationResult::Invalid;
+		}
+
+	return Result;
+}
+#endif
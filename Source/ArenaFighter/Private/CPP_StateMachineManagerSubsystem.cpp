@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_StateMachineManagerSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_StateMachineBase.h"
+#include "Async/ParallelFor.h"
+
+DECLARE_CYCLE_STAT(TEXT("State Machines Tick"), STAT_StateMachinesTick, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("State Machines Evaluate"), STAT_StateMachinesEvaluate, STATGROUP_ArenaFighter);
+DECLARE_CYCLE_STAT(TEXT("State Machines Apply"), STAT_StateMachinesApply, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("State Machines"), STAT_StateMachines, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("State Machine Transitions"), STAT_StateMachineTransitions, STATGROUP_ArenaFighter);
+
+void UCPP_StateMachineManagerSubsystem::Register(UCPP_StateMachineBase* Machine)
+{
+	if (Machine)
+		Machines.AddUnique(Machine);
+}
+
+void UCPP_StateMachineManagerSubsystem::Unregister(UCPP_StateMachineBase* Machine)
+{
+	const int32 Index = Machines.IndexOfByKey(Machine);
+	if (Index == INDEX_NONE) return;
+
+	// State callbacks may unregister machines; compact after the update instead
+	if (bIsUpdating)
+		Machines[Index] = nullptr;
+	else
+		Machines.RemoveAt(Index);
+}
+
+void UCPP_StateMachineManagerSubsystem::Deinitialize()
+{
+	Machines.Empty();
+	EvaluatedMachines.Empty();
+	TargetStates.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_StateMachineManagerSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	CPP_PROFILE_SCOPE_BUCKET(StateMachinesTick, StateMachines);
+
+	EvaluatedMachines.Reset();
+	for (const TWeakObjectPtr<UCPP_StateMachineBase>& Machine : Machines)
+		if (Machine.IsValid() && Machine->HasAutomaticTransitions())
+			EvaluatedMachines.Add(Machine.Get());
+
+	TargetStates.SetNumUninitialized(EvaluatedMachines.Num());
+
+	{
+		CPP_PROFILE_SCOPE(StateMachinesEvaluate);
+
+		const EParallelForFlags Flags = bParallelEvaluation && EvaluatedMachines.Num() >= MinMachinesForParallel
+			                                ? EParallelForFlags::None
+			                                : EParallelForFlags::ForceSingleThread;
+
+		const int32 NumMachines = EvaluatedMachines.Num();
+		const int32 NumTasks = MaxEvaluationTasks > 0 ? FMath::Min(MaxEvaluationTasks, NumMachines) : NumMachines;
+
+		ParallelFor(NumTasks, [this, NumMachines, NumTasks](int32 Task)
+		{
+			const int32 End = (int64(Task) + 1) * NumMachines / NumTasks;
+			for (int32 Index = int64(Task) * NumMachines / NumTasks; Index < End; ++Index)
+				TargetStates[Index] = EvaluatedMachines[Index]->EvaluateTransitions(NAME_None);
+		}, Flags);
+	}
+
+	TransitionsLastFrame = 0;
+	bIsUpdating = true;
+
+	{
+		CPP_PROFILE_SCOPE(StateMachinesApply);
+
+		for (int32 Index = 0; Index < EvaluatedMachines.Num(); ++Index)
+			if (TargetStates[Index] != INDEX_NONE)
+			{
+				EvaluatedMachines[Index]->ApplyTransition(TargetStates[Index]);
+				TransitionsLastFrame++;
+			}
+	}
+
+	for (int32 Index = 0; Index < Machines.Num(); ++Index)
+		if (UCPP_StateMachineBase* Machine = Machines[Index].Get())
+			Machine->TickActiveState(DeltaTime);
+
+	bIsUpdating = false;
+
+	Machines.RemoveAll([](const TWeakObjectPtr<UCPP_StateMachineBase>& Machine) { return !Machine.IsValid(); });
+	EvaluatedMachines.Reset();
+
+	SET_DWORD_STAT(STAT_StateMachines, Machines.Num());
+	SET_DWORD_STAT(STAT_StateMachineTransitions, TransitionsLastFrame);
+	CSV_CUSTOM_STAT(ArenaFighter, StateMachineTransitions, TransitionsLastFrame, ECsvCustomStatOp::Set);
+}
+
+TStatId UCPP_StateMachineManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_StateMachineManagerSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_StateMachineManagerSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_StressTimers.h"
+
+#if !UE_BUILD_SHIPPING
+
+bool FCPP_StressTimers::bEnabled = false;
+uint64 FCPP_StressTimers::Cycles[static_cast<int32>(ECPP_StressBucket::Num)] = {};
+ECPP_StressBucket FCPP_StressTimers::ActiveBucket = ECPP_StressBucket::Num;
+uint64 FCPP_StressTimers::ActiveStart = 0;
+int32 FCPP_StressTimers::Depth = 0;
+
+void FCPP_StressTimers::SetEnabled(bool bInEnabled)
+{
+	// Toggling inside a scope would unbalance the active bucket
+	check(IsInGameThread() && Depth == 0);
+	bEnabled = bInEnabled;
+}
+
+double FCPP_StressTimers::GetSeconds(ECPP_StressBucket Bucket)
+{
+	return Cycles[static_cast<int32>(Bucket)] * FPlatformTime::GetSecondsPerCycle64();
+}
+
+void FCPP_StressTimers::Reset()
+{
+	FMemory::Memzero(Cycles);
+}
+
+FCPP_StressTimerScope::FCPP_StressTimerScope(ECPP_StressBucket Bucket)
+{
+	// Only the game thread is measured; worker threads run alongside it
+	if (!FCPP_StressTimers::bEnabled || !IsInGameThread()) return;
+
+	const uint64 Now = FPlatformTime::Cycles64();
+	PreviousBucket = FCPP_StressTimers::ActiveBucket;
+	if (PreviousBucket != ECPP_StressBucket::Num)
+		FCPP_StressTimers::Cycles[static_cast<int32>(PreviousBucket)] += Now - FCPP_StressTimers::ActiveStart;
+
+	FCPP_StressTimers::ActiveBucket = Bucket;
+	FCPP_StressTimers::ActiveStart = Now;
+	FCPP_StressTimers::Depth++;
+	bActive = true;
+}
+
+FCPP_StressTimerScope::~FCPP_StressTimerScope()
+{
+	if (!bActive) return;
+
+	const uint64 Now = FPlatformTime::Cycles64();
+	FCPP_StressTimers::Cycles[static_cast<int32>(FCPP_StressTimers::ActiveBucket)] += Now - FCPP_StressTimers::ActiveStart;
+
+	FCPP_StressTimers::ActiveBucket = PreviousBucket;
+	FCPP_StressTimers::ActiveStart = Now;
+	FCPP_StressTimers::Depth--;
+}
+
+#endif
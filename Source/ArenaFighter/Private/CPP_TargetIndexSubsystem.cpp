@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_TargetIndexSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CharacterBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("TargetIndex Refresh"), STAT_TargetIndexRefresh, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("TargetIndex Entries"), STAT_TargetIndexEntries, STATGROUP_ArenaFighter);
+DECLARE_MEMORY_STAT(TEXT("TargetIndex Memory"), STAT_TargetIndexMemory, STATGROUP_ArenaFighter);
+
+void UCPP_TargetIndexSubsystem::Register(ACPP_CharacterBase* Character)
+{
+	if (!Character || EntryIndices.Contains(Character)) return;
+
+	FEntry Entry;
+	Entry.Character = Character;
+	Entry.Cell = GetCell(Character->GetActorLocation());
+
+	EntryIndices.Add(Character, Entries.Add(Entry));
+	Cells.FindOrAdd(Entry.Cell).Add(Character);
+}
+
+void UCPP_TargetIndexSubsystem::Unregister(ACPP_CharacterBase* Character)
+{
+	int32 Index;
+	if (!EntryIndices.RemoveAndCopyValue(Character, Index)) return;
+
+	if (TArray<ACPP_CharacterBase*>* CellCharacters = Cells.Find(Entries[Index].Cell))
+	{
+		CellCharacters->RemoveSwap(Character);
+		if (CellCharacters->IsEmpty())
+			Cells.Remove(Entries[Index].Cell);
+	}
+
+	Entries.RemoveAtSwap(Index);
+	if (Entries.IsValidIndex(Index))
+		EntryIndices[Entries[Index].Character] = Index;
+}
+
+bool UCPP_TargetIndexSubsystem::IsRegistered(const ACPP_CharacterBase* Character) const
+{
+	return EntryIndices.Contains(Character);
+}
+
+void UCPP_TargetIndexSubsystem::UpdateCharacter(ACPP_CharacterBase* Character)
+{
+	if (const int32* Index = EntryIndices.Find(Character))
+	{
+		FEntry& Entry = Entries[*Index];
+		MoveEntry(Entry, GetCell(Character->GetActorLocation()));
+	}
+}
+
+void UCPP_TargetIndexSubsystem::QueryInFront(const FVector& Origin, const FVector& Forward, float Radius,
+                                             const ACPP_CharacterBase* Ignore,
+                                             TArray<ACPP_CharacterBase*>& OutCharacters) const
+{
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+
+	const FVector2D Origin2D(Origin);
+	const FVector2D Forward2D = FVector2D(Forward).GetSafeNormal();
+	const float HalfCellDiagonal = CellSize * UE_HALF_SQRT_2;
+	const float ReachSquared = FMath::Square(Radius + HalfCellDiagonal);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const FIntPoint Cell(X, Y);
+			const TArray<ACPP_CharacterBase*>* CellCharacters = Cells.Find(Cell);
+			if (!CellCharacters) continue;
+
+			const FVector2D CellCenter = (FVector2D(Cell) + 0.5f) * CellSize;
+			const FVector2D ToCell = CellCenter - Origin2D;
+
+			// Skip cells that are entirely out of reach or entirely behind the character
+			if (ToCell.SizeSquared() > ReachSquared) continue;
+			if (FVector2D::DotProduct(ToCell, Forward2D) < -HalfCellDiagonal) continue;
+
+			for (ACPP_CharacterBase* Character : *CellCharacters)
+				if (Character != Ignore)
+					OutCharacters.Add(Character);
+		}
+}
+
+void UCPP_TargetIndexSubsystem::QueryInRadius(const FVector& Origin, float Radius, const ACPP_CharacterBase* Ignore,
+                                              TArray<ACPP_CharacterBase*>& OutCharacters) const
+{
+	// A zero forward direction keeps every cell in reach
+	QueryInFront(Origin, FVector::ZeroVector, Radius, Ignore, OutCharacters);
+}
+
+void UCPP_TargetIndexSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	EntryIndices.Empty();
+	Cells.Empty();
+
+	Super::Deinitialize();
+}
+
+void UCPP_TargetIndexSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	CPP_PROFILE_SCOPE(TargetIndexRefresh);
+
+	for (FEntry& Entry : Entries)
+		MoveEntry(Entry, GetCell(Entry.Character->GetActorLocation()));
+
+	SET_DWORD_STAT(STAT_TargetIndexEntries, Entries.Num());
+	SET_MEMORY_STAT(STAT_TargetIndexMemory, GetAllocatedSize());
+}
+
+TStatId UCPP_TargetIndexSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_TargetIndexSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_TargetIndexSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+SIZE_T UCPP_TargetIndexSubsystem::GetAllocatedSize() const
+{
+	SIZE_T Size = Entries.GetAllocatedSize() + EntryIndices.GetAllocatedSize() + Cells.GetAllocatedSize();
+	for (const TPair<FIntPoint, TArray<ACPP_CharacterBase*>>& Cell : Cells)
+		Size += Cell.Value.GetAllocatedSize();
+
+	return Size;
+}
+
+FIntPoint UCPP_TargetIndexSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void UCPP_TargetIndexSubsystem::MoveEntry(FEntry& Entry, const FIntPoint& NewCell)
+{
+	if (Entry.Cell == NewCell) return;
+
+	if (TArray<ACPP_CharacterBase*>* OldCellCharacters = Cells.Find(Entry.Cell))
+	{
+		OldCellCharacters->RemoveSwap(Entry.Character);
+		if (OldCellCharacters->IsEmpty())
+			Cells.Remove(Entry.Cell);
+	}
+
+	Cells.FindOrAdd(NewCell).Add(Entry.Character);
+	Entry.Cell = NewCell;
+}
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_TargetScoringSubsystem.h"
+
+#include "ArenaFighter.h"
+#include "CPP_CharacterBase.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("ResolvePendingSelections"), STAT_ResolvePendingSelections, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Selections"), STAT_BatchedSelections, STATGROUP_ArenaFighter);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Batched Candidates"), STAT_BatchedCandidates, STATGROUP_ArenaFighter);
+
+bool UCPP_TargetScoringSubsystem::RequestSelection(ACPP_CharacterBase* Selector)
+{
+	if (!bBatchScoring) return false;
+
+	bool bAlreadyPending = false;
+	PendingSelectorSet.Add(Selector, &bAlreadyPending);
+	if (!bAlreadyPending)
+		PendingSelectors.Add(Selector);
+
+	return true;
+}
+
+void UCPP_TargetScoringSubsystem::CancelSelection(ACPP_CharacterBase* Selector)
+{
+	if (PendingSelectorSet.Remove(Selector) == 0) return;
+
+	PendingSelectors.RemoveAllSwap([Selector](const TWeakObjectPtr<ACPP_CharacterBase>& Pending)
+	{
+		return Pending.Get() == Selector;
+	}, EAllowShrinking::No);
+}
+
+void UCPP_TargetScoringSubsystem::ResolvePendingSelections()
+{
+	if (PendingSelectors.IsEmpty()) return;
+
+	CPP_PROFILE_SCOPE_BUCKET(ResolvePendingSelections, Selection);
+
+	GatherBuffers();
+
+	INC_DWORD_STAT_BY(STAT_BatchedSelections, Selectors.Num());
+	INC_DWORD_STAT_BY(STAT_BatchedCandidates, Candidates.Num());
+	CSV_CUSTOM_STAT(ArenaFighter, BatchedSelections, Selectors.Num(), ECsvCustomStatOp::Set);
+
+	for (int32 SelectorIndex = 0; SelectorIndex < Selectors.Num(); ++SelectorIndex)
+		ScoreCandidates(SelectorIndex);
+
+	// Write back after all scoring is done so Blueprint handlers never observe a half-updated frame
+	for (int32 SelectorIndex = 0; SelectorIndex < Selectors.Num(); ++SelectorIndex)
+		Selectors[SelectorIndex]->ApplySelectedPawn(PickCandidate(SelectorIndex));
+
+	ResetBuffers();
+}
+
+void UCPP_TargetScoringSubsystem::Deinitialize()
+{
+	PendingSelectors.Empty();
+	PendingSelectorSet.Empty();
+	ResetBuffers();
+
+	Super::Deinitialize();
+}
+
+void UCPP_TargetScoringSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ResolvePendingSelections();
+}
+
+TStatId UCPP_TargetScoringSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCPP_TargetScoringSubsystem, STATGROUP_Tickables);
+}
+
+bool UCPP_TargetScoringSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UCPP_TargetScoringSubsystem::GatherBuffers()
+{
+	for (const TWeakObjectPtr<ACPP_CharacterBase>& PendingSelector : PendingSelectors)
+	{
+		ACPP_CharacterBase* Selector = PendingSelector.Get();
+		if (!Selector || Selector->IsDead()) continue;
+
+		const FVector Location = Selector->GetActorLocation();
+		const FVector Forward = Selector->GetActorForwardVector();
+
+		Selectors.Add(Selector);
+		SelectorX.Add(Location.X);
+		SelectorY.Add(Location.Y);
+		SelectorZ.Add(Location.Z);
+		ForwardX.Add(Forward.X);
+		ForwardY.Add(Forward.Y);
+		ForwardZ.Add(Forward.Z);
+
+		Selector->GatherSelectionCandidates(GatherScratch);
+		CandidateStart.Add(Candidates.Num());
+		CandidateCount.Add(GatherScratch.Num());
+
+		for (ACPP_CharacterBase* Candidate : GatherScratch)
+		{
+			const FVector CandidateLocation = Candidate->GetActorLocation();
+			Candidates.Add(Candidate);
+			CandidateX.Add(CandidateLocation.X);
+			CandidateY.Add(CandidateLocation.Y);
+			CandidateZ.Add(CandidateLocation.Z);
+		}
+	}
+
+	CandidateDistance.SetNumUninitialized(Candidates.Num());
+	CandidateDot.SetNumUninitialized(Candidates.Num());
+
+	PendingSelectors.Reset();
+	PendingSelectorSet.Reset();
+}
+
+void UCPP_TargetScoringSubsystem::ScoreCandidates(int32 SelectorIndex)
+{
+	const int32 Start = CandidateStart[SelectorIndex];
+	const int32 End = Start + CandidateCount[SelectorIndex];
+	const int32 VectorEnd = Start + (CandidateCount[SelectorIndex] & ~3);
+
+	const VectorRegister4Float OriginX = VectorSetFloat1(SelectorX[SelectorIndex]);
+	const VectorRegister4Float OriginY = VectorSetFloat1(SelectorY[SelectorIndex]);
+	const VectorRegister4Float OriginZ = VectorSetFloat1(SelectorZ[SelectorIndex]);
+	const VectorRegister4Float FacingX = VectorSetFloat1(ForwardX[SelectorIndex]);
+	const VectorRegister4Float FacingY = VectorSetFloat1(ForwardY[SelectorIndex]);
+	const VectorRegister4Float FacingZ = VectorSetFloat1(ForwardZ[SelectorIndex]);
+
+	int32 Index = Start;
+	for (; Index < VectorEnd; Index += 4)
+	{
+		const VectorRegister4Float DeltaX = VectorSubtract(VectorLoad(&CandidateX[Index]), OriginX);
+		const VectorRegister4Float DeltaY = VectorSubtract(VectorLoad(&CandidateY[Index]), OriginY);
+		const VectorRegister4Float DeltaZ = VectorSubtract(VectorLoad(&CandidateZ[Index]), OriginZ);
+
+		VectorRegister4Float DistanceSquared = VectorMultiply(DeltaX, DeltaX);
+		DistanceSquared = VectorMultiplyAdd(DeltaY, DeltaY, DistanceSquared);
+		DistanceSquared = VectorMultiplyAdd(DeltaZ, DeltaZ, DistanceSquared);
+		const VectorRegister4Float Distance = VectorSqrt(DistanceSquared);
+
+		VectorRegister4Float Facing = VectorMultiply(FacingX, DeltaX);
+		Facing = VectorMultiplyAdd(FacingY, DeltaY, Facing);
+		Facing = VectorMultiplyAdd(FacingZ, DeltaZ, Facing);
+
+		VectorStore(Distance, &CandidateDistance[Index]);
+		VectorStore(VectorDivide(Facing, Distance), &CandidateDot[Index]);
+	}
+
+	for (; Index < End; ++Index)
+	{
+		const float DeltaX = CandidateX[Index] - SelectorX[SelectorIndex];
+		const float DeltaY = CandidateY[Index] - SelectorY[SelectorIndex];
+		const float DeltaZ = CandidateZ[Index] - SelectorZ[SelectorIndex];
+		const float Distance = FMath::Sqrt(DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ);
+
+		CandidateDistance[Index] = Distance;
+		CandidateDot[Index] = (ForwardX[SelectorIndex] * DeltaX
+			+ ForwardY[SelectorIndex] * DeltaY
+			+ ForwardZ[SelectorIndex] * DeltaZ) / Distance;
+	}
+}
+
+ACPP_CharacterBase* UCPP_TargetScoringSubsystem::PickCandidate(int32 SelectorIndex) const
+{
+	ACPP_CharacterBase* ClosestCandidate = nullptr;
+	float ClosestDistance = FLT_MAX;
+	float MaxDotProduct = -FLT_MAX;
+
+	const int32 Start = CandidateStart[SelectorIndex];
+	const int32 End = Start + CandidateCount[SelectorIndex];
+
+	// Candidates on top of the selector produce NaN and fail every comparison, like the skipped case in TrySelectPawn
+	for (int32 Index = Start; Index < End; ++Index)
+		if (CandidateDot[Index] > 0.0f
+			&& CandidateDot[Index] > MaxDotProduct
+			&& CandidateDistance[Index] < ClosestDistance)
+		{
+			MaxDotProduct = CandidateDot[Index];
+			ClosestCandidate = Candidates[Index];
+			ClosestDistance = CandidateDistance[Index];
+		}
+
+	return ClosestCandidate;
+}
+
+void UCPP_TargetScoringSubsystem::ResetBuffers()
+{
+	Selectors.Reset();
+	SelectorX.Reset();
+	SelectorY.Reset();
+	SelectorZ.Reset();
+	ForwardX.Reset();
+	ForwardY.Reset();
+	ForwardZ.Reset();
+	CandidateStart.Reset();
+	CandidateCount.Reset();
+
+	Candidates.Reset();
+	CandidateX.Reset();
+	CandidateY.Reset();
+	CandidateZ.Reset();
+	CandidateDistance.Reset();
+	CandidateDot.Reset();
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_TransitionGuard.h"
+
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_StateMachineBase.h"
+
+bool UCPP_TransitionGuard::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	return true;
+}
+
+bool UCPP_TransitionGuard_Not::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	return Guard && !Guard->CanTransition(Machine);
+}
+
+bool UCPP_TransitionGuard_All::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	for (const UCPP_TransitionGuard* Nested : Guards)
+		if (Nested && !Nested->CanTransition(Machine))
+			return false;
+
+	return true;
+}
+
+bool UCPP_TransitionGuard_TargetInRange::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	const ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(Machine->GetOwnerContext());
+	const APawn* Target = Character ? Character->GetSelectedPawn() : nullptr;
+	if (!Target) return false;
+
+	float MaxDistance = Range;
+	if (MaxDistance < 0.0f)
+	{
+		const ACPP_EnemyCharacterBase* Enemy = Cast<ACPP_EnemyCharacterBase>(Character);
+		if (!Enemy) return false;
+		MaxDistance = Enemy->AttackTargetRadius;
+	}
+
+	return FVector::DistSquared(Character->GetActorLocation(), Target->GetActorLocation()) <= FMath::Square(MaxDistance);
+}
+
+bool UCPP_TransitionGuard_TargetLost::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	const ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(Machine->GetOwnerContext());
+	if (!Character || Character->GetSelectedPawn()) return false;
+
+	float Timeout = Seconds;
+	if (Timeout < 0.0f)
+	{
+		const ACPP_EnemyCharacterBase* Enemy = Cast<ACPP_EnemyCharacterBase>(Character);
+		if (!Enemy) return false;
+		Timeout = Enemy->SecondsToLostTarget;
+	}
+
+	return Machine->GetStateContext().TimeInState >= Timeout;
+}
+
+bool UCPP_TransitionGuard_HealthBelow::CanTransition(const UCPP_StateMachineBase* Machine) const
+{
+	const ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(Machine->GetOwnerContext());
+	return Character && Character->GetHealth() < Character->GetMaxHealth() * HealthFraction;
+}
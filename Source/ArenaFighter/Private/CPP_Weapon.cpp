@@ -3,19 +3,22 @@
 
 #include "CPP_Weapon.h"
 
+#include "ArenaFighter.h"
+
 // Sets default values
 ACPP_Weapon::ACPP_Weapon()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
+ 	// Weapons have no per-frame work. Subclasses that need Tick() set this back to true; Blueprint subclasses
+	// implementing Event Tick get it enabled by the Blueprint compiler.
+	PrimaryActorTick.bCanEverTick = false;
 }
 
 // Called when the game starts or when spawned
 void ACPP_Weapon::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	bHasBlueprintTick = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(AActor, ReceiveTick));
 }
 
 // Called every frame
@@ -23,5 +26,8 @@ void ACPP_Weapon::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	INC_DWORD_STAT(STAT_ActorsTicked);
+	if (bHasBlueprintTick)
+		INC_DWORD_STAT(STAT_ActorsTickedWithWork);
 }
 
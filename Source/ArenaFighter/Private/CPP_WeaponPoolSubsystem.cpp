@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CPP_WeaponPoolSubsystem.h"
+
+#include "CPP_Weapon.h"
+
+void UCPP_WeaponPoolSubsystem::Prewarm(const TArray<TSoftClassPtr<ACPP_Weapon>>& WeaponClasses)
+{
+	if (!bPoolWeapons) return;
+
+	for (const TSoftClassPtr<ACPP_Weapon>& SoftWeaponClass : WeaponClasses)
+	{
+		const TSubclassOf<ACPP_Weapon> WeaponClass = SoftWeaponClass.Get();
+		if (!WeaponClass || GetNumFree(WeaponClass) > 0) continue;
+
+		if (ACPP_Weapon* Weapon = SpawnWeapon(WeaponClass, nullptr))
+		{
+			Deactivate(Weapon);
+			Buckets.FindOrAdd(WeaponClass).FreeWeapons.Add(Weapon);
+		}
+	}
+}
+
+ACPP_Weapon* UCPP_WeaponPoolSubsystem::Acquire(TSubclassOf<ACPP_Weapon> WeaponClass, AActor* NewOwner)
+{
+	if (!WeaponClass) return nullptr;
+
+	if (FCPP_WeaponPoolBucket* Bucket = Buckets.Find(WeaponClass))
+		while (!Bucket->FreeWeapons.IsEmpty())
+		{
+			ACPP_Weapon* Weapon = Bucket->FreeWeapons.Pop(EAllowShrinking::No);
+			if (!IsValid(Weapon)) continue;
+
+			Weapon->SetOwner(NewOwner);
+			Weapon->SetActorHiddenInGame(false);
+			Weapon->SetActorEnableCollision(true);
+			Weapon->SetActorTickEnabled(Weapon->PrimaryActorTick.bStartWithTickEnabled);
+			Weapon->OnEquipped();
+			return Weapon;
+		}
+
+	ACPP_Weapon* Weapon = SpawnWeapon(WeaponClass, NewOwner);
+	if (Weapon)
+		Weapon->OnEquipped();
+	return Weapon;
+}
+
+void UCPP_WeaponPoolSubsystem::Release(ACPP_Weapon* Weapon)
+{
+	if (!IsValid(Weapon)) return;
+
+	Weapon->OnUnequipped();
+	if (!bPoolWeapons)
+	{
+		Weapon->Destroy();
+		return;
+	}
+
+	Deactivate(Weapon);
+	Buckets.FindOrAdd(Weapon->GetClass()).FreeWeapons.Add(Weapon);
+}
+
+int32 UCPP_WeaponPoolSubsystem::GetNumFree(TSubclassOf<ACPP_Weapon> WeaponClass) const
+{
+	const FCPP_WeaponPoolBucket* Bucket = Buckets.Find(WeaponClass);
+	return Bucket ? Bucket->FreeWeapons.Num() : 0;
+}
+
+void UCPP_WeaponPoolSubsystem::Deinitialize()
+{
+	Buckets.Empty();
+
+	Super::Deinitialize();
+}
+
+bool UCPP_WeaponPoolSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+ACPP_Weapon* UCPP_WeaponPoolSubsystem::SpawnWeapon(TSubclassOf<ACPP_Weapon> WeaponClass, AActor* NewOwner) const
+{
+	FActorSpawnParameters spawnParameters;
+	spawnParameters.Owner = NewOwner;
+	spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	return GetWorld()->SpawnActor<ACPP_Weapon>(WeaponClass, spawnParameters);
+}
+
+void UCPP_WeaponPoolSubsystem::Deactivate(ACPP_Weapon* Weapon)
+{
+	Weapon->DetachFromActor(FDetachmentTransformRules::KeepWorldTransform);
+	Weapon->SetActorHiddenInGame(true);
+	Weapon->SetActorEnableCollision(false);
+	Weapon->SetActorTickEnabled(false);
+	Weapon->SetOwner(nullptr);
+}
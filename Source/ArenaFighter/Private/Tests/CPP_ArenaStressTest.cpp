@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_ArenaStressSubsystem.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_ArenaStressRunTest, "ArenaFighter.ArenaStress.Run",
+                                 EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Loads the arena map, runs UCPP_ArenaStressSubsystem over small enemy counts with short phases and checks the
+ * CSV it produces: one row per count, every step passing its budget. Needs a game world, so run it with -game.
+ */
+bool FCPP_ArenaStressRunTest::RunTest(const FString& Parameters)
+{
+	static const TCHAR* MapPath = TEXT("/Game/ThirdPerson/Maps/ThirdPersonMap");
+	static const TCHAR* EnemyClassPath = TEXT("/Game/Blueprints/Enemies/BP_Enemy1.BP_Enemy1_C");
+	static const TArray<int32> EnemyCounts = { 5, 20 };
+	static constexpr double TimeoutSeconds = 120.0;
+
+	if (!AutomationOpenMap(MapPath))
+	{
+		AddError(FString::Printf(TEXT("Could not open %s"), MapPath));
+		return false;
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this]()
+	{
+		const UWorld* World = AutomationCommon::GetAnyGameWorld();
+		UCPP_ArenaStressSubsystem* Stress = World ? World->GetSubsystem<UCPP_ArenaStressSubsystem>() : nullptr;
+		if (!TestNotNull(TEXT("Arena stress subsystem"), Stress)) return true;
+
+		Stress->EnemyClass = TSoftClassPtr<ACPP_EnemyCharacterBase>(FSoftObjectPath(EnemyClassPath));
+		Stress->WarmupSeconds = 0.5f;
+		Stress->MeasureSeconds = 1.0f;
+		TestTrue(TEXT("Stress run started"), Stress->StartRun(EnemyCounts));
+		return true;
+	}));
+
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, StartTime = FPlatformTime::Seconds()]()
+	{
+		const UWorld* World = AutomationCommon::GetAnyGameWorld();
+		const UCPP_ArenaStressSubsystem* Stress = World ? World->GetSubsystem<UCPP_ArenaStressSubsystem>() : nullptr;
+		if (!TestNotNull(TEXT("Arena stress subsystem"), Stress)) return true;
+
+		if (Stress->IsRunning())
+		{
+			if (FPlatformTime::Seconds() - StartTime < TimeoutSeconds) return false;
+
+			AddError(FString::Printf(TEXT("The stress run did not finish within %.0f seconds"), TimeoutSeconds));
+			return true;
+		}
+
+		TArray<FString> Lines;
+		Stress->GetCsv().ParseIntoArrayLines(Lines);
+		if (!TestEqual(TEXT("CSV rows, header included"), Lines.Num(), EnemyCounts.Num() + 1)) return true;
+
+		TArray<FString> Header;
+		Lines[0].ParseIntoArray(Header, TEXT(","), false);
+		const int32 ResultColumn = Header.IndexOfByKey(TEXT("Result"));
+		if (!TestNotEqual(TEXT("Result column"), ResultColumn, static_cast<int32>(INDEX_NONE))) return true;
+
+		bool bAllRowsPassed = true;
+		for (int32 Step = 0; Step < EnemyCounts.Num(); ++Step)
+		{
+			TArray<FString> Columns;
+			Lines[Step + 1].ParseIntoArray(Columns, TEXT(","), false);
+			if (!TestEqual(TEXT("CSV columns"), Columns.Num(), Header.Num())) return true;
+
+			TestEqual(TEXT("Enemy count of the step"), FCString::Atoi(*Columns[0]), EnemyCounts[Step]);
+			TestEqual(FString::Printf(TEXT("Step with %d enemies"), EnemyCounts[Step]), Columns[ResultColumn], FString(TEXT("Pass")));
+			bAllRowsPassed &= Columns[ResultColumn] == TEXT("Pass");
+
+			AddInfo(Lines[Step + 1]);
+		}
+
+		TestEqual(TEXT("Run result matches the rows"), Stress->DidAllStepsPass(), bAllRowsPassed);
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
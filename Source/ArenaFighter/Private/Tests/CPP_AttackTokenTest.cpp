@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_AttackTokenSubsystem.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_TestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_AttackTokenRankingTest, "ArenaFighter.AttackToken.Ranking",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Five unarmed enemies in a line from the target ask for its three tokens, the farthest first, so they get the
+ * free tokens right away. Checks that the holders keep them for MinTokenHoldSeconds, that the three closest
+ * hold them afterwards, and that a request no longer renewed is dropped after RequestTimeout, its token going
+ * to the next closest enemy.
+ */
+bool FCPP_AttackTokenRankingTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumEnemies = 5;
+	constexpr float DeltaTime = 0.05f;
+
+	FCPP_TestWorld World;
+	UCPP_AttackTokenSubsystem* AttackTokens = World.Get()->GetSubsystem<UCPP_AttackTokenSubsystem>();
+	if (!TestNotNull(TEXT("Attack token subsystem"), AttackTokens)) return false;
+
+	AActor* Target = World.Spawn<AActor>(AActor::StaticClass(), FVector::ZeroVector);
+	if (!TestNotNull(TEXT("Target"), Target)) return false;
+
+	// Enemy 0 is the closest
+	TArray<ACPP_EnemyCharacterBase*> Enemies;
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+	{
+		ACPP_EnemyCharacterBase* Enemy = World.Spawn<ACPP_EnemyCharacterBase>(
+			ACPP_EnemyCharacterBase::StaticClass(), FVector((Index + 1) * 200.0f, 0.0f, 100.0f));
+		if (!TestNotNull(TEXT("Enemy"), Enemy)) return false;
+		Enemies.Add(Enemy);
+	}
+
+	const int32 AttackSlots = AttackTokens->GetAttackSlots();
+	if (!TestEqual(TEXT("Attack slots"), AttackSlots, 3)) return false;
+
+	for (int32 Index = NumEnemies - 1; Index >= 0; --Index)
+		TestEqual(FString::Printf(TEXT("Enemy %d gets a free token on its first request"), Index),
+		          AttackTokens->RequestToken(Enemies[Index], Target), Index >= NumEnemies - AttackSlots);
+
+	// Renews the requests of every enemy but Skipped each frame, returns who held a token at the last renewal
+	auto RunFor = [&](float Seconds, int32 Skipped = INDEX_NONE)
+	{
+		TArray<bool> HoldsToken;
+		for (float Time = 0.0f; Time < Seconds; Time += DeltaTime)
+		{
+			HoldsToken.Reset();
+			for (int32 Index = 0; Index < NumEnemies; ++Index)
+				HoldsToken.Add(Index != Skipped && AttackTokens->RequestToken(Enemies[Index], Target));
+			World.Tick(DeltaTime);
+		}
+		return HoldsToken;
+	};
+
+	// Rankings within the hold time leave the tokens with the farthest enemies
+	TArray<bool> HoldsToken = RunFor(AttackTokens->MinTokenHoldSeconds * 0.5f);
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+		TestEqual(FString::Printf(TEXT("Enemy %d within the hold time"), Index), HoldsToken[Index], Index >= NumEnemies - AttackSlots);
+
+	// Past the hold time the closest enemies win the ranking
+	HoldsToken = RunFor(AttackTokens->MinTokenHoldSeconds + AttackTokens->RankInterval);
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+		TestEqual(FString::Printf(TEXT("Enemy %d after the hold time"), Index), HoldsToken[Index], Index < AttackSlots);
+	TestEqual(TEXT("Requests waiting after the hold time"), AttackTokens->GetQueueLength(), NumEnemies - AttackSlots);
+
+	// The closest enemy stops asking, its token goes to the next one in line
+	HoldsToken = RunFor(AttackTokens->RequestTimeout + AttackTokens->MinTokenHoldSeconds + AttackTokens->RankInterval, 0);
+	for (int32 Index = 1; Index < NumEnemies; ++Index)
+		TestEqual(FString::Printf(TEXT("Enemy %d after the timeout"), Index), HoldsToken[Index], Index <= AttackSlots);
+	TestEqual(TEXT("Requests waiting after the timeout"), AttackTokens->GetQueueLength(), NumEnemies - 1 - AttackSlots);
+	TestFalse(TEXT("Timed out enemy waits for the next ranking"), AttackTokens->RequestToken(Enemies[0], Target));
+
+	// Three free tokens, two taken by the closest enemies, one by the next after the timeout
+	TestEqual(TEXT("Token turnovers"), AttackTokens->GetTokenTurnovers(), AttackSlots + 3);
+	return true;
+}
+
+#endif
@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AIController.h"
+#include "BehaviorTree/BehaviorTree.h"
+#include "BehaviorTree/BehaviorTreeComponent.h"
+#include "BehaviorTree/BlackboardComponent.h"
+#include "BehaviorTree/BlackboardData.h"
+#include "BehaviorTree/BTCompositeNode.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyDecisionSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_EnemyDecisionNativeTreeTest, "ArenaFighter.AI.NativeTree",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Builds the native enemy tree, possesses 200 enemies opted in to it, which start it, and checks that every tree registers with
+ * the decision subsystem and resolves its blackboard keys. Logs the time of a frame of brain component ticks with
+ * BT_Enemy_Base and with the native tree, the shared decision queue apart.
+ */
+bool FCPP_EnemyDecisionNativeTreeTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumEnemies = 200;
+	constexpr int32 Frames = 60;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	FCPP_TestWorld World;
+	UCPP_EnemyDecisionSubsystem* Decisions = World.Get()->GetSubsystem<UCPP_EnemyDecisionSubsystem>();
+	if (!TestNotNull(TEXT("Decision subsystem"), Decisions)) return false;
+
+	UBehaviorTree* Tree = Decisions->GetNativeTree();
+	if (!TestNotNull(TEXT("Native tree"), Tree) || !TestNotNull(TEXT("Root node"), Tree->RootNode.Get())) return false;
+
+	TestEqual(TEXT("Native tree is built once"), Decisions->GetNativeTree(), Tree);
+	TestEqual(TEXT("Root services"), Tree->RootNode->Services.Num(), 1);
+	TestEqual(TEXT("Root children"), Tree->RootNode->Children.Num(), 2);
+	TestNotNull(TEXT("Blackboard"), Tree->BlackboardAsset.Get());
+
+	TArray<AAIController*> Controllers;
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+	{
+		ACPP_EnemyCharacterBase* Enemy = World.Spawn<ACPP_EnemyCharacterBase>(
+			ACPP_EnemyCharacterBase::StaticClass(), FVector(Index % 20 * 200.0f, Index / 20 * 200.0f, 100.0f));
+		AAIController* Controller = World.Spawn<AAIController>(AAIController::StaticClass(), Enemy->GetActorLocation());
+		Enemy->bRunNativeBehaviorTree = true;
+		Controller->Possess(Enemy);
+
+		// The enemy starts the native tree on possession
+		const UBehaviorTreeComponent* TreeComponent = Cast<UBehaviorTreeComponent>(Controller->GetBrainComponent());
+		if (!TestTrue(TEXT("Enemy runs the native tree"), TreeComponent && TreeComponent->GetRootTree() == Tree)) return false;
+		Controllers.Add(Controller);
+	}
+
+	const UBlackboardComponent* Blackboard = Controllers[0]->GetBlackboardComponent();
+	TestTrue(TEXT("Target key resolved"), Blackboard && Blackboard->GetKeyID(TEXT("TargetActor")) != FBlackboard::InvalidKey);
+
+	if (UBehaviorTree* BaselineTree = Decisions->BaselineTree.LoadSynchronous())
+	{
+		double DecisionMicroseconds = 0.0;
+		const double BrainMicroseconds = Decisions->TimeTreeTicks(Controllers, BaselineTree, Frames, DeltaTime, DecisionMicroseconds);
+		AddInfo(FString::Printf(TEXT("%s, %d enemies without target: %.1f us/frame of brain ticks, %.1f us/frame of decision queue"),
+		                        *BaselineTree->GetName(), NumEnemies, BrainMicroseconds, DecisionMicroseconds));
+	}
+	else
+	{
+		AddWarning(FString::Printf(TEXT("The baseline tree %s could not be loaded"), *Decisions->BaselineTree.ToString()));
+	}
+
+	double DecisionMicroseconds = 0.0;
+	const double BrainMicroseconds = Decisions->TimeTreeTicks(Controllers, Tree, Frames, DeltaTime, DecisionMicroseconds);
+
+	TestEqual(TEXT("Trees registered with the decision subsystem"), Decisions->GetNumRegistered(), NumEnemies);
+
+	AddInfo(FString::Printf(TEXT("Native tree, %d enemies without target: %.1f us/frame of brain ticks, %.1f us/frame of decision queue"),
+	                        NumEnemies, BrainMicroseconds, DecisionMicroseconds));
+	return true;
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_PerceptionSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_EnemyPoolWaveTest, "ArenaFighter.EnemyPool.Wave",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Spawns a wave of enemies without the pool, then the same wave twice through the pool with a release in
+ * between. Checks the hit and miss counts, that parked enemies are out of perception, and logs the cost of each wave.
+ */
+bool FCPP_EnemyPoolWaveTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 WaveSize = 100;
+
+	FCPP_TestWorld World;
+	UCPP_EnemyPoolSubsystem* EnemyPool = World.Get()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+	const UCPP_PerceptionSubsystem* Perception = World.Get()->GetSubsystem<UCPP_PerceptionSubsystem>();
+	if (!TestNotNull(TEXT("Enemy pool"), EnemyPool) || !TestNotNull(TEXT("Perception"), Perception)) return false;
+
+	const TSubclassOf<ACPP_EnemyCharacterBase> EnemyClass = ACPP_EnemyCharacterBase::StaticClass();
+	auto GetSpawnLocation = [](int32 Index) { return FVector(Index % 10 * 200.0f, Index / 10 * 200.0f, 100.0f); };
+
+	auto CountSensing = [Perception](const TArray<ACPP_EnemyCharacterBase*>& Enemies)
+	{
+		int32 Count = 0;
+		for (const ACPP_EnemyCharacterBase* Enemy : Enemies)
+			Count += Perception->IsRegistered(Enemy);
+		return Count;
+	};
+
+	// Plain spawns, the way waves were spawned before the pool
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < WaveSize; ++Index)
+	{
+		ACPP_EnemyCharacterBase* Enemy = World.Spawn<ACPP_EnemyCharacterBase>(EnemyClass, GetSpawnLocation(Index));
+		if (Enemy && !Enemy->GetController())
+			Enemy->SpawnDefaultController();
+	}
+	const double UnpooledMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	TArray<ACPP_EnemyCharacterBase*> Wave;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < WaveSize; ++Index)
+		Wave.Add(EnemyPool->SpawnEnemy(EnemyClass, FTransform(GetSpawnLocation(Index))));
+	const double MissMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	TestEqual(TEXT("Misses of the first pooled wave"), EnemyPool->GetMisses(), WaveSize);
+	TestEqual(TEXT("Enemies of the first pooled wave in perception"), CountSensing(Wave), WaveSize);
+
+	for (ACPP_EnemyCharacterBase* Enemy : Wave)
+		EnemyPool->ReleaseEnemy(Enemy);
+
+	TestEqual(TEXT("Free enemies after release"), EnemyPool->GetNumFree(EnemyClass), WaveSize);
+	TestEqual(TEXT("Parked enemies in perception"), CountSensing(Wave), 0);
+
+	TArray<ACPP_EnemyCharacterBase*> ReusedWave;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < WaveSize; ++Index)
+		ReusedWave.Add(EnemyPool->SpawnEnemy(EnemyClass, FTransform(GetSpawnLocation(Index))));
+	const double HitMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+
+	TestEqual(TEXT("Hits of the reused wave"), EnemyPool->GetHits(), WaveSize);
+	TestEqual(TEXT("Enemies of the reused wave in perception"), CountSensing(ReusedWave), WaveSize);
+	for (const ACPP_EnemyCharacterBase* Enemy : ReusedWave)
+		TestTrue(TEXT("Reused enemy is at full health"), Enemy && Enemy->GetHealth() == Enemy->GetMaxHealth());
+
+	AddInfo(FString::Printf(TEXT("Wave of %d enemies: spawned %.2f ms, pool misses %.2f ms, pool hits %.2f ms"),
+	                        WaveSize, UnpooledMilliseconds, MissMilliseconds, HitMilliseconds));
+	return true;
+}
+
+#endif
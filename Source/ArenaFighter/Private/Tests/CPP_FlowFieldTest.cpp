@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_FlowFieldSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_FlowFieldObstacleTest, "ArenaFighter.FlowField.Obstacle",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Builds a field on a 10 x 10 grid split by a wall at X = 5 with a gap in the two top rows, the target on the
+ * other side of the wall. Checks the distances, which must go around the wall, and that a sample next to the
+ * wall heads for the gap instead of into the wall.
+ */
+bool FCPP_FlowFieldObstacleTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 GridSize = 10;
+	constexpr float CellSize = 100.0f;
+	constexpr int32 WallX = 5;
+	constexpr int32 GapStartY = 8;
+
+	FCPP_TestWorld World;
+	UCPP_FlowFieldSubsystem* FlowField = World.Get()->GetSubsystem<UCPP_FlowFieldSubsystem>();
+	if (!TestNotNull(TEXT("Flow field subsystem"), FlowField)) return false;
+
+	TBitArray<> Walkable(true, GridSize * GridSize);
+	for (int32 Y = 0; Y < GapStartY; ++Y)
+		Walkable[Y * GridSize + WallX] = false;
+	FlowField->SetGrid(FVector2D::ZeroVector, CellSize, GridSize, GridSize, MoveTemp(Walkable));
+
+	auto CellCenter = [CellSize](int32 X, int32 Y)
+	{
+		return FVector((X + 0.5f) * CellSize, (Y + 0.5f) * CellSize, 0.0f);
+	};
+
+	const AActor* Target = World.Spawn<AActor>(AActor::StaticClass(), CellCenter(8, 2));
+	if (!TestNotNull(TEXT("Target"), Target)) return false;
+
+	TestEqual(TEXT("Cells expanded, every walkable cell once"), FlowField->BuildFieldNow(Target), GridSize * GridSize - GapStartY);
+	if (!TestTrue(TEXT("Field built"), FlowField->HasField(Target))) return false;
+
+	// Six cells in a straight line, fourteen around the wall through the gap
+	TestEqual(TEXT("Distance at the target"), FlowField->GetDistance(Target, CellCenter(8, 2)), 0);
+	TestEqual(TEXT("Distance on the target's side"), FlowField->GetDistance(Target, CellCenter(6, 2)), 2);
+	TestEqual(TEXT("Distance behind the wall"), FlowField->GetDistance(Target, CellCenter(2, 2)), 14);
+	TestEqual(TEXT("Distance next to the wall"), FlowField->GetDistance(Target, CellCenter(4, 2)), 14);
+	TestEqual(TEXT("Distance in the gap"), FlowField->GetDistance(Target, CellCenter(WallX, GapStartY)), 7);
+	TestEqual(TEXT("Distance in the wall"), FlowField->GetDistance(Target, CellCenter(WallX, 2)), static_cast<int32>(INDEX_NONE));
+
+	// Straight ahead is the wall, the field leads along it toward the gap
+	FVector Direction;
+	if (!TestTrue(TEXT("Sample next to the wall"), FlowField->SampleDirection(Target, CellCenter(4, 2), Direction))) return false;
+	TestTrue(TEXT("Sample next to the wall heads for the gap"), Direction.Equals(FVector(0.0f, 1.0f, 0.0f), 1e-3));
+
+	if (!TestTrue(TEXT("Sample behind the wall"), FlowField->SampleDirection(Target, CellCenter(2, 2), Direction))) return false;
+	TestTrue(TEXT("Sample behind the wall moves away from the target's row"), Direction.Y > 0.9f);
+
+	// Past the wall the field leads straight on toward the target
+	if (!TestTrue(TEXT("Sample in the gap"), FlowField->SampleDirection(Target, CellCenter(WallX, GapStartY), Direction))) return false;
+	TestTrue(TEXT("Sample in the gap moves toward the target"), Direction.X > 0.0f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_EnemyPoolSubsystem.h"
+#include "CPP_RoundSpawnSchedulerSubsystem.h"
+#include "CPP_RoundsConfigurations.h"
+#include "CPP_TestWorld.h"
+#include "EngineUtils.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_RoundSpawnSchedulerBudgetTest, "ArenaFighter.RoundSpawnScheduler.Budget",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Queues a 200-enemy wave whose configuration also lists a class that cannot be loaded. Checks that the wave
+ * completes with exactly the spawns picked for the loadable class, spread over frames, and that no frame goes
+ * past the budget by more than one spawn, measured on its own beforehand. Logs the frame times.
+ */
+bool FCPP_RoundSpawnSchedulerBudgetTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 WaveSize = 200;
+	constexpr int32 Round = 1;
+	constexpr int32 SpawnSamples = 10;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	// Cost of one spawn through the enemy pool, the same path the scheduler takes, in a world of its own
+	double SpawnMilliseconds = 0.0;
+	{
+		FCPP_TestWorld SpawnWorld;
+		UCPP_EnemyPoolSubsystem* EnemyPool = SpawnWorld.Get()->GetSubsystem<UCPP_EnemyPoolSubsystem>();
+		if (!TestNotNull(TEXT("Enemy pool"), EnemyPool)) return false;
+
+		for (int32 Sample = 0; Sample < SpawnSamples; ++Sample)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			EnemyPool->SpawnEnemy(ACPP_EnemyCharacterBase::StaticClass(), FTransform(FVector(Sample * 500.0f, 0.0f, 100.0f)));
+			SpawnMilliseconds = FMath::Max(SpawnMilliseconds, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		}
+	}
+
+	FCPP_TestWorld World;
+	UCPP_RoundSpawnSchedulerSubsystem* Scheduler = World.Get()->GetSubsystem<UCPP_RoundSpawnSchedulerSubsystem>();
+	if (!TestNotNull(TEXT("Spawn scheduler"), Scheduler)) return false;
+
+	U_CPP_RoundsConfigurations* Configurations = NewObject<U_CPP_RoundsConfigurations>();
+	FCPP_RoundsConfig& Config = Configurations->Data.Configurations.AddDefaulted_GetRef();
+	Config.LevelsSpan = FIntPoint(Round, Round);
+	Config.Enemies.Add(ACPP_EnemyCharacterBase::StaticClass());
+	Config.SyncSoftEnemies();
+	Config.SoftEnemies.Add(TSoftClassPtr<ACPP_EnemyCharacterBase>(FSoftObjectPath(TEXT("/Game/Missing/BP_MissingEnemy.BP_MissingEnemy_C"))));
+
+	// QueueWave picks every spawn's class from the configuration with a stream seeded by the round
+	int32 ExpectedSpawns = 0;
+	FRandomStream ClassStream(Round);
+	for (int32 Index = 0; Index < WaveSize; ++Index)
+		ExpectedSpawns += ClassStream.RandRange(0, Config.SoftEnemies.Num() - 1) == 0;
+
+	TArray<AActor*> SpawnPoints;
+	for (int32 Index = 0; Index < 8; ++Index)
+		SpawnPoints.Add(World.Spawn<AActor>(AActor::StaticClass(), FVector(Index * 500.0f, 0.0f, 100.0f)));
+
+	Scheduler->QueueWave(Configurations, Round, SpawnPoints, WaveSize);
+	if (!TestTrue(TEXT("Wave queued"), Scheduler->IsSpawning())) return false;
+
+	// The missing class resolves as a failed load instead of stalling the wave
+	FlushAsyncLoading();
+
+	TArray<double> FrameMilliseconds;
+	TArray<int32> FrameSpawns;
+	while (Scheduler->IsSpawning() && FrameMilliseconds.Num() < 10 * WaveSize)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Scheduler->Tick(DeltaTime);
+		FrameMilliseconds.Add((FPlatformTime::Seconds() - StartTime) * 1000.0);
+		FrameSpawns.Add(Scheduler->GetSpawnedLastFrame());
+	}
+
+	if (!TestFalse(TEXT("Wave completed"), Scheduler->IsSpawning())) return false;
+
+	int32 Spawned = 0;
+	for (TActorIterator<ACPP_EnemyCharacterBase> It(World.Get()); It; ++It)
+		Spawned += It->GetClass() == ACPP_EnemyCharacterBase::StaticClass();
+
+	int32 SpawnedByScheduler = 0;
+	for (const int32 Spawns : FrameSpawns)
+		SpawnedByScheduler += Spawns;
+
+	// Spawns of the missing class are skipped, every spawn of the loadable class is there
+	TestTrue(TEXT("The missing class had spawns to skip"), ExpectedSpawns < WaveSize);
+	TestEqual(TEXT("Enemies spawned"), Spawned, ExpectedSpawns);
+	TestEqual(TEXT("Enemies spawned by the scheduler"), SpawnedByScheduler, ExpectedSpawns);
+
+	// A frame stops after the spawn that crosses the budget, so it may go over by one spawn at most
+	const double FrameLimit = Scheduler->BudgetMilliseconds + SpawnMilliseconds;
+	double MaxMilliseconds = 0.0;
+	double TotalMilliseconds = 0.0;
+	for (int32 Frame = 0; Frame < FrameMilliseconds.Num(); ++Frame)
+	{
+		MaxMilliseconds = FMath::Max(MaxMilliseconds, FrameMilliseconds[Frame]);
+		TotalMilliseconds += FrameMilliseconds[Frame];
+
+		if (FrameMilliseconds[Frame] > FrameLimit)
+			AddError(FString::Printf(TEXT("Frame %d spawned %d enemies in %.2f ms, over the %.2f ms budget plus one spawn"),
+			                         Frame, FrameSpawns[Frame], FrameMilliseconds[Frame], FrameLimit));
+	}
+
+	TestTrue(TEXT("Wave spread over several frames"), FrameMilliseconds.Num() > 1);
+
+	AddInfo(FString::Printf(TEXT("Wave of %d: %d enemies in %d frames, budget %.2f ms, one spawn %.2f ms, max frame %.2f ms, mean frame %.2f ms"),
+	                        WaveSize, Spawned, FrameMilliseconds.Num(), Scheduler->BudgetMilliseconds, SpawnMilliseconds,
+	                        MaxMilliseconds, TotalMilliseconds / FMath::Max(FrameMilliseconds.Num(), 1)));
+	return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_CharacterBase.h"
+#include "CPP_EnemyCharacterBase.h"
+#include "CPP_RoundsConfigurations.h"
+#include "CPP_Weapon.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectArray.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_RoundStreamingLoadReportTest, "ArenaFighter.RoundStreaming.LoadReport",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Reports the level load time and peak resident memory with soft enemy and weapon references (after) and with
+ * every class loaded up front, which is what the hard references did (before). Loads the arena level package,
+ * which pulls in the rounds configuration, then loads every enemy class and weapon synchronously.
+ * Run it in a fresh process: classes already resident from an earlier load hide the difference.
+ */
+bool FCPP_RoundStreamingLoadReportTest::RunTest(const FString& Parameters)
+{
+	static const TCHAR* LevelPath = TEXT("/Game/ThirdPerson/Maps/ThirdPersonMap");
+	static const TCHAR* ConfigurationsPath = TEXT("/Game/Blueprints/RoundsSystem/Configs/_RoundsConfigurations._RoundsConfigurations");
+
+	if (FindObject<U_CPP_RoundsConfigurations>(nullptr, ConfigurationsPath))
+		AddWarning(TEXT("The rounds configuration is already loaded, the report only covers what is not resident yet"));
+
+	const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+	double StartTime = FPlatformTime::Seconds();
+
+	if (!TestNotNull(TEXT("Arena level"), LoadPackage(nullptr, LevelPath, LOAD_None))) return false;
+	U_CPP_RoundsConfigurations* Configurations = LoadObject<U_CPP_RoundsConfigurations>(nullptr, ConfigurationsPath);
+	if (!TestNotNull(TEXT("Rounds configuration"), Configurations)) return false;
+
+	const double LevelTime = FPlatformTime::Seconds() - StartTime;
+	const int32 LevelObjects = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+	const FPlatformMemoryStats LevelMemory = FPlatformMemory::GetStats();
+
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+	for (const FCPP_RoundsConfig& Config : Configurations->Data.Configurations)
+	{
+		TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> RoundEnemyClasses;
+		Config.GetEnemyClasses(RoundEnemyClasses);
+		for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : RoundEnemyClasses)
+			EnemyClasses.AddUnique(EnemyClass);
+	}
+
+	int32 ResidentEnemyClasses = 0;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+		ResidentEnemyClasses += EnemyClass.Get() ? 1 : 0;
+
+	// Classes still listed in the hard reference fields load with the level, so there is no soft-only level load yet
+	if (ResidentEnemyClasses > 0)
+		AddWarning(FString::Printf(TEXT("%d of %d enemy classes loaded with the level, move them from Enemies and Weapons to SoftEnemies and SoftWeapons"),
+		                           ResidentEnemyClasses, EnemyClasses.Num()));
+
+	AddInfo(FString::Printf(TEXT("After, soft references: level load %.1f ms, %d UObjects, %+.1f MB resident, peak %.1f MB, %d of %d enemy classes resident"),
+	                        LevelTime * 1000.0, LevelObjects,
+	                        (int64(LevelMemory.UsedPhysical) - int64(MemoryBefore)) / (1024.0 * 1024.0),
+	                        LevelMemory.PeakUsedPhysical / (1024.0 * 1024.0), ResidentEnemyClasses, EnemyClasses.Num()));
+
+	// Everything the hard references used to load together with the level
+	StartTime = FPlatformTime::Seconds();
+
+	TArray<TSoftClassPtr<ACPP_Weapon>> WeaponClasses;
+	for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& EnemyClass : EnemyClasses)
+	{
+		const UClass* LoadedClass = EnemyClass.LoadSynchronous();
+		if (!LoadedClass)
+		{
+			AddWarning(FString::Printf(TEXT("Enemy class %s could not be loaded"), *EnemyClass.ToString()));
+			continue;
+		}
+
+		for (const TSoftClassPtr<ACPP_Weapon>& WeaponClass : LoadedClass->GetDefaultObject<ACPP_CharacterBase>()->GetWeaponClasses())
+			if (!WeaponClass.IsNull())
+				WeaponClasses.AddUnique(WeaponClass);
+	}
+
+	for (const TSoftClassPtr<ACPP_Weapon>& WeaponClass : WeaponClasses)
+		WeaponClass.LoadSynchronous();
+
+	const double ClassesTime = FPlatformTime::Seconds() - StartTime;
+	const FPlatformMemoryStats MemoryAfter = FPlatformMemory::GetStats();
+
+	AddInfo(FString::Printf(TEXT("Before, hard references: level load %.1f ms, %d UObjects, %+.1f MB resident, peak %.1f MB, %d enemy and %d weapon classes"),
+	                        (LevelTime + ClassesTime) * 1000.0, GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore,
+	                        (int64(MemoryAfter.UsedPhysical) - int64(MemoryBefore)) / (1024.0 * 1024.0),
+	                        MemoryAfter.PeakUsedPhysical / (1024.0 * 1024.0), EnemyClasses.Num(), WeaponClasses.Num()));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_CharacterBase.h"
+#include "CPP_StateBase.h"
+#include "CPP_StateMachineBase.h"
+#include "CPP_StateMachineDefinition.h"
+#include "CPP_StateMachineManagerSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "CPP_TransitionGuard.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectArray.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace CPP_StateMachineTest
+{
+	static const FName Idle(TEXT("Idle"));
+	static const FName Active(TEXT("Active"));
+	static const FName ResetTrigger(TEXT("Reset"));
+
+	/** Idle goes to Active automatically on the next tick, Reset brings Active back to Idle. */
+	UCPP_StateMachineDefinition* MakeDefinition(bool bShareStates)
+	{
+		UCPP_StateMachineDefinition* Definition = NewObject<UCPP_StateMachineDefinition>();
+		Definition->bShareStates = bShareStates;
+		Definition->InitialState = Idle;
+		for (const FName StateName : { Idle, Active })
+		{
+			FCPP_StateDefinition& State = Definition->States.AddDefaulted_GetRef();
+			State.Name = StateName;
+			State.StateClass = UCPP_StateBase::StaticClass();
+		}
+
+		FCPP_StateTransition& Activate = Definition->Transitions.AddDefaulted_GetRef();
+		Activate.From = Idle;
+		Activate.To = Active;
+
+		FCPP_StateTransition& Reset = Definition->Transitions.AddDefaulted_GetRef();
+		Reset.From = Active;
+		Reset.To = Idle;
+		Reset.Trigger = ResetTrigger;
+
+		return Definition;
+	}
+
+	/**
+	 * Idle and Active both switch to the other state automatically once the owner has no target and the current
+	 * state has lasted the given time, so machines with different times change state on different frames.
+	 */
+	UCPP_StateMachineDefinition* MakeTimedDefinition(float IdleSeconds, float ActiveSeconds)
+	{
+		UCPP_StateMachineDefinition* Definition = MakeDefinition(false);
+		Definition->Transitions.Reset();
+
+		for (const TPair<FName, float>& Timeout : { TPair<FName, float>(Idle, IdleSeconds), TPair<FName, float>(Active, ActiveSeconds) })
+		{
+			FCPP_StateTransition& Transition = Definition->Transitions.AddDefaulted_GetRef();
+			Transition.From = Timeout.Key;
+			Transition.To = Timeout.Key == Idle ? Active : Idle;
+
+			UCPP_TransitionGuard_TargetLost* Guard = NewObject<UCPP_TransitionGuard_TargetLost>(Definition);
+			Guard->Seconds = Timeout.Value;
+			Transition.Guard = Guard;
+		}
+
+		return Definition;
+	}
+
+	/** Definition is only editable from the editor and Blueprints, set it through reflection before Init. */
+	UCPP_StateMachineBase* MakeMachine(UCPP_StateMachineDefinition* Definition, UObject* Context = nullptr,
+	                                   bool bTickFromManager = false)
+	{
+		UCPP_StateMachineBase* Machine = NewObject<UCPP_StateMachineBase>();
+		FindFProperty<FObjectPropertyBase>(UCPP_StateMachineBase::StaticClass(), TEXT("Definition"))
+			->SetObjectPropertyValue_InContainer(Machine, Definition);
+		FindFProperty<FBoolProperty>(UCPP_StateMachineBase::StaticClass(), TEXT("bTickFromManager"))
+			->SetPropertyValue_InContainer(Machine, bTickFromManager);
+		Machine->Init(Context);
+		return Machine;
+	}
+
+	UCPP_StateBase* GetCurrentState(const UCPP_StateMachineBase* Machine)
+	{
+		return Cast<UCPP_StateBase>(FindFProperty<FObjectPropertyBase>(UCPP_StateMachineBase::StaticClass(), TEXT("CurrentState"))
+			->GetObjectPropertyValue_InContainer(Machine));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_StateMachineTickBenchmark, "ArenaFighter.StateMachine.TickBenchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Ticks 10,000 machines that take two transitions per frame, once through the native transition table and
+ * once the way machines ran before it: without a definition, every Blueprint event dispatched, and the
+ * transitions resolved by the Blueprint graph, which reads CurrentState and calls SetState through reflection.
+ */
+bool FCPP_StateMachineTickBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace CPP_StateMachineTest;
+
+	constexpr int32 NumMachines = 10000;
+	constexpr int32 Frames = 60;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	UCPP_StateMachineDefinition* Definition = MakeDefinition(false);
+
+	TArray<UCPP_StateMachineBase*> Machines;
+	Machines.Reserve(NumMachines);
+	for (int32 Index = 0; Index < NumMachines; ++Index)
+	{
+		Machines.Add(MakeMachine(Definition));
+		Machines.Last()->AddToRoot();
+	}
+
+	// Baseline: machines without a definition whose states are set from the graph, starting in Active
+	struct FBaselineMachine
+	{
+		UCPP_StateMachineBase* Machine = nullptr;
+		UCPP_StateBase* IdleState = nullptr;
+		UCPP_StateBase* ActiveState = nullptr;
+	};
+
+	UFunction* SetStateFunction = UCPP_StateMachineBase::StaticClass()->FindFunctionByName(TEXT("SetState"));
+	if (!TestNotNull(TEXT("SetState function"), SetStateFunction)) return false;
+
+	// SetState as the graph called it, with the exit, state changed and enter events it dispatched every time
+	auto SetStateFromGraph = [SetStateFunction](UCPP_StateMachineBase* Machine, UCPP_StateBase* NewState)
+	{
+		if (UCPP_StateBase* OldState = GetCurrentState(Machine))
+			OldState->OnExitEvent();
+
+		struct
+		{
+			UCPP_StateBase* NewState;
+		} SetStateParameters{ NewState };
+		Machine->ProcessEvent(SetStateFunction, &SetStateParameters);
+
+		Machine->OnStateChangedEvent();
+		NewState->OnEnterEvent();
+	};
+
+	TArray<FBaselineMachine> BaselineMachines;
+	BaselineMachines.Reserve(NumMachines);
+	for (int32 Index = 0; Index < NumMachines; ++Index)
+	{
+		FBaselineMachine& Baseline = BaselineMachines.AddDefaulted_GetRef();
+		Baseline.Machine = MakeMachine(nullptr);
+		Baseline.Machine->AddToRoot();
+		Baseline.IdleState = NewObject<UCPP_StateBase>(Baseline.Machine);
+		Baseline.IdleState->Init(nullptr);
+		Baseline.ActiveState = NewObject<UCPP_StateBase>(Baseline.Machine);
+		Baseline.ActiveState->Init(nullptr);
+		SetStateFromGraph(Baseline.Machine, Baseline.ActiveState);
+	}
+
+	double BaselineMilliseconds = 0.0;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+			for (const FBaselineMachine& Baseline : BaselineMachines)
+			{
+				// The Reset event of the graph, then its Idle to Active check on tick
+				if (GetCurrentState(Baseline.Machine) == Baseline.ActiveState)
+					SetStateFromGraph(Baseline.Machine, Baseline.IdleState);
+
+				if (GetCurrentState(Baseline.Machine) == Baseline.IdleState)
+					SetStateFromGraph(Baseline.Machine, Baseline.ActiveState);
+
+				GetCurrentState(Baseline.Machine)->OnTickEvent(DeltaTime);
+				Baseline.Machine->OnTickEvent(DeltaTime);
+			}
+
+		BaselineMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames;
+	}
+
+	double NativeMilliseconds = 0.0;
+	{
+		const double StartTime = FPlatformTime::Seconds();
+
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+			for (UCPP_StateMachineBase* Machine : Machines)
+			{
+				Machine->FireTrigger(ResetTrigger);
+				Machine->OnTick(DeltaTime);
+			}
+
+		NativeMilliseconds = (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames;
+	}
+
+	for (const TPair<const TCHAR*, double>& Run : { TPair<const TCHAR*, double>(TEXT("Blueprint-driven"), BaselineMilliseconds),
+	                                                TPair<const TCHAR*, double>(TEXT("native table    "), NativeMilliseconds) })
+		AddInfo(FString::Printf(TEXT("%d machines, %s: %.3f ms per frame, %.1f ns per machine"),
+		                        NumMachines, Run.Key, Run.Value, Run.Value * 1e6 / NumMachines));
+
+	int32 NumActive = 0;
+	for (UCPP_StateMachineBase* Machine : Machines)
+	{
+		NumActive += Machine->GetCurrentStateName() == Active;
+		Machine->RemoveFromRoot();
+	}
+	TestEqual(TEXT("Machines in the Active state"), NumActive, NumMachines);
+
+	int32 NumBaselineActive = 0;
+	for (const FBaselineMachine& Baseline : BaselineMachines)
+	{
+		NumBaselineActive += GetCurrentState(Baseline.Machine) == Baseline.ActiveState;
+		Baseline.Machine->RemoveFromRoot();
+	}
+	TestEqual(TEXT("Baseline machines in the Active state"), NumBaselineActive, NumMachines);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_StateMachineSharedStatesTest, "ArenaFighter.StateMachine.SharedStates",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Creates the state machines of 500 enemies with per-machine states and with shared states, and reports the
+ * UObjects each mode adds and the time of a garbage collection pass while the machines are alive.
+ * Both modes must take the same transitions.
+ */
+bool FCPP_StateMachineSharedStatesTest::RunTest(const FString& Parameters)
+{
+	using namespace CPP_StateMachineTest;
+
+	constexpr int32 NumEnemies = 500;
+	constexpr int32 GarbageCollections = 10;
+
+	for (const bool bShareStates : { false, true })
+	{
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+
+		UCPP_StateMachineDefinition* Definition = MakeDefinition(bShareStates);
+		Definition->AddToRoot();
+
+		TArray<UCPP_StateMachineBase*> Machines;
+		for (int32 Index = 0; Index < NumEnemies; ++Index)
+		{
+			Machines.Add(MakeMachine(Definition));
+			Machines.Last()->AddToRoot();
+		}
+
+		const int32 ObjectsCreated = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+
+		double GarbageCollectionSeconds = 0.0;
+		for (int32 Pass = 0; Pass < GarbageCollections; ++Pass)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			GarbageCollectionSeconds += FPlatformTime::Seconds() - StartTime;
+		}
+
+		int32 NumActive = 0;
+		for (UCPP_StateMachineBase* Machine : Machines)
+		{
+			Machine->OnTick(1.0f / 60.0f);
+			NumActive += Machine->GetCurrentStateName() == Active;
+		}
+		TestEqual(TEXT("Machines in the Active state"), NumActive, NumEnemies);
+
+		// One machine per enemy, plus one instance of each state per enemy or one in total when shared
+		const int32 ExpectedObjects = 1 + NumEnemies + Definition->States.Num() * (bShareStates ? 1 : NumEnemies);
+		TestTrue(TEXT("UObjects created"), ObjectsCreated >= ExpectedObjects && ObjectsCreated < ExpectedObjects + NumEnemies);
+
+		AddInfo(FString::Printf(TEXT("%d enemies, %s states: %d UObjects, %.3f ms per garbage collection"),
+		                        NumEnemies, bShareStates ? TEXT("shared    ") : TEXT("per-machine"), ObjectsCreated,
+		                        GarbageCollectionSeconds * 1000.0 / GarbageCollections));
+
+		for (UCPP_StateMachineBase* Machine : Machines)
+			Machine->RemoveFromRoot();
+		Definition->RemoveFromRoot();
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_StateMachineParallelTest, "ArenaFighter.StateMachine.ParallelEvaluation",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Drives the same managed machines with serial and with parallel evaluation and checks that every machine goes
+ * through the same states on the same frames. Then reports the manager's frame time for 1 to N evaluation tasks.
+ */
+bool FCPP_StateMachineParallelTest::RunTest(const FString& Parameters)
+{
+	using namespace CPP_StateMachineTest;
+
+	constexpr int32 NumMachines = 10000;
+	constexpr int32 NumDefinitions = 8;
+	constexpr int32 Frames = 120;
+	constexpr float DeltaTime = 1.0f / 60.0f;
+
+	FCPP_TestWorld World;
+	UCPP_StateMachineManagerSubsystem* Manager = World.Get()->GetSubsystem<UCPP_StateMachineManagerSubsystem>();
+	if (!TestNotNull(TEXT("State machine manager"), Manager)) return false;
+
+	// Guards only read the owner, so the machines can share one character without a target
+	ACPP_CharacterBase* Owner = World.Spawn<ACPP_CharacterBase>(ACPP_CharacterBase::StaticClass(), FVector::ZeroVector);
+	if (!TestNotNull(TEXT("Owner"), Owner)) return false;
+
+	TArray<UCPP_StateMachineDefinition*> Definitions;
+	for (int32 Index = 0; Index < NumDefinitions; ++Index)
+	{
+		Definitions.Add(MakeTimedDefinition(0.05f * (Index + 1), 0.03f * (NumDefinitions - Index)));
+		Definitions.Last()->AddToRoot();
+	}
+
+	// Runs fresh machines for Frames frames and returns, per frame, whether each machine is Active
+	auto Run = [&](bool bParallel, int32 MaxTasks, double& OutFrameMilliseconds)
+	{
+		Manager->bParallelEvaluation = bParallel;
+		Manager->MinMachinesForParallel = 0;
+		Manager->MaxEvaluationTasks = MaxTasks;
+
+		TArray<UCPP_StateMachineBase*> Machines;
+		for (int32 Index = 0; Index < NumMachines; ++Index)
+		{
+			Machines.Add(MakeMachine(Definitions[Index % NumDefinitions], Owner, true));
+			Machines.Last()->AddToRoot();
+		}
+
+		TBitArray<> States;
+		double Seconds = 0.0;
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Manager->Tick(DeltaTime);
+			Seconds += FPlatformTime::Seconds() - StartTime;
+
+			for (const UCPP_StateMachineBase* Machine : Machines)
+				States.Add(Machine->GetCurrentStateName() == Active);
+		}
+		OutFrameMilliseconds = Seconds * 1000.0 / Frames;
+
+		for (UCPP_StateMachineBase* Machine : Machines)
+		{
+			Manager->Unregister(Machine);
+			Machine->RemoveFromRoot();
+		}
+		return States;
+	};
+
+	double SerialMilliseconds = 0.0;
+	double ParallelMilliseconds = 0.0;
+	const TBitArray<> SerialStates = Run(false, 0, SerialMilliseconds);
+	const TBitArray<> ParallelStates = Run(true, 0, ParallelMilliseconds);
+
+	TestTrue(TEXT("Machines changed state during the run"), SerialStates.Find(true) != INDEX_NONE && SerialStates.Find(false) != INDEX_NONE);
+	TestTrue(TEXT("Serial and parallel runs take the same transitions"), SerialStates == ParallelStates);
+
+	AddInfo(FString::Printf(TEXT("%d machines: serial %.3f ms, parallel %.3f ms per frame"),
+	                        NumMachines, SerialMilliseconds, ParallelMilliseconds));
+
+	const int32 MaxTasks = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+	for (int32 Tasks = 1; Tasks <= MaxTasks; ++Tasks)
+	{
+		double FrameMilliseconds = 0.0;
+		const TBitArray<> States = Run(true, Tasks, FrameMilliseconds);
+		TestTrue(FString::Printf(TEXT("Same transitions with %d tasks"), Tasks), States == SerialStates);
+		AddInfo(FString::Printf(TEXT("%2d evaluation tasks: %.3f ms per frame, %.2fx serial"),
+		                        Tasks, FrameMilliseconds, SerialMilliseconds / FMath::Max(FrameMilliseconds, 1e-6)));
+	}
+
+	for (UCPP_StateMachineDefinition* Definition : Definitions)
+		Definition->RemoveFromRoot();
+
+	return true;
+}
+
+#endif
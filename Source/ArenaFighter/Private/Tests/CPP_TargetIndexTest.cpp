@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_CharacterBase.h"
+#include "CPP_TargetIndexSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "Algo/Sort.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_TargetIndexSelectionTest, "ArenaFighter.TargetIndex.Selection",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+/**
+ * Compares the candidates of target selection gathered through the grid with a walk of DetectedPawns, the way
+ * TrySelectPawn found them before the index, and logs the time of both at 10, 100 and 1000 pawns. Both sides are
+ * compared after the in-front and sight radius tests that decide whether TrySelectPawn can pick a pawn.
+ */
+bool FCPP_TargetIndexSelectionTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Iterations = 200;
+
+	for (const int32 NumPawns : { 10, 100, 1000 })
+		for (const bool bSomeOutOfSight : { false, true })
+		{
+			FCPP_TestWorld World;
+			if (!TestNotNull(TEXT("Target index"), World.Get()->GetSubsystem<UCPP_TargetIndexSubsystem>()))
+				return false;
+
+			ACPP_CharacterBase* Selector = World.Spawn<ACPP_CharacterBase>(ACPP_CharacterBase::StaticClass(), FVector::ZeroVector);
+			const float SightRadius = Selector->GetSightRadius();
+
+			// Half of the pawns are detected. Pawns beyond the sight radius moved away since they were detected
+			// and can no longer be selected.
+			FRandomStream Random(NumPawns);
+			TArray<APawn*> Detected;
+			for (int32 Index = 0; Index < NumPawns; ++Index)
+			{
+				const float MaxDistance = bSomeOutOfSight ? SightRadius * 1.2f : SightRadius * 0.9f;
+				const FVector Location = FRotator(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f).Vector()
+					* Random.FRandRange(100.0f, MaxDistance);
+
+				ACPP_CharacterBase* Pawn = World.Spawn<ACPP_CharacterBase>(ACPP_CharacterBase::StaticClass(), Location);
+				if (Index % 2 == 0)
+					Detected.Add(Pawn);
+			}
+			Selector->ApplyPerception(Detected, {});
+
+			auto WalkDetectedPawns = [Selector](TArray<ACPP_CharacterBase*>& OutCandidates)
+			{
+				OutCandidates.Reset();
+				for (APawn* Pawn : Selector->GetDetectedPawns())
+				{
+					ACPP_CharacterBase* Character = Cast<ACPP_CharacterBase>(Pawn);
+					if (Character && !Character->IsDead())
+						OutCandidates.Add(Character);
+				}
+			};
+
+			// The pawns TrySelectPawn can pick among the candidates
+			auto KeepSelectable = [Selector, SightRadius](TArray<ACPP_CharacterBase*>& Candidates)
+			{
+				const FVector Location = Selector->GetActorLocation();
+				const FVector Forward = Selector->GetActorForwardVector();
+				Candidates.RemoveAll([&](const ACPP_CharacterBase* Candidate)
+				{
+					const FVector ToCandidate = Candidate->GetActorLocation() - Location;
+					return ToCandidate.SizeSquared() > FMath::Square(SightRadius) || FVector::DotProduct(Forward, ToCandidate) <= 0.0f;
+				});
+			};
+
+			TArray<ACPP_CharacterBase*> Expected;
+			TArray<ACPP_CharacterBase*> Actual;
+			WalkDetectedPawns(Expected);
+			Selector->GatherSelectionCandidates(Actual);
+			TestTrue(TEXT("Index gives no more candidates than the walk"), Actual.Num() <= Expected.Num());
+			KeepSelectable(Expected);
+			KeepSelectable(Actual);
+			Algo::Sort(Expected);
+			Algo::Sort(Actual);
+			TestTrue(FString::Printf(TEXT("Same candidates with %d pawns%s"), NumPawns,
+			                         bSomeOutOfSight ? TEXT(", some out of sight") : TEXT("")),
+			         Expected == Actual);
+
+			double StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				WalkDetectedPawns(Expected);
+			const double WalkMicroseconds = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+			StartTime = FPlatformTime::Seconds();
+			for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+				Selector->GatherSelectionCandidates(Actual);
+			const double IndexMicroseconds = (FPlatformTime::Seconds() - StartTime) * 1e6 / Iterations;
+
+			AddInfo(FString::Printf(TEXT("%4d pawns%s: walk %.2f us, index %.2f us per selection"), NumPawns,
+			                        bSomeOutOfSight ? TEXT(" (some out of sight)") : TEXT(""),
+			                        WalkMicroseconds, IndexMicroseconds));
+		}
+
+	return true;
+}
+
+#endif
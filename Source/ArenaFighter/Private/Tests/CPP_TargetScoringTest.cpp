@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_CharacterBase.h"
+#include "CPP_TargetScoringSubsystem.h"
+#include "CPP_TestWorld.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_TargetScoringBenchmarkTest, "ArenaFighter.TargetScoring.Benchmark",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Every character detects every other one and asks for a selection, as after a perception update.
+ * Compares the frame cost of the batched scoring pass with each character running TrySelectPawn,
+ * and checks both pick the same targets.
+ */
+bool FCPP_TargetScoringBenchmarkTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Frames = 20;
+
+	for (const int32 NumCharacters : { 50, 200, 500 })
+	{
+		FCPP_TestWorld World;
+		UCPP_TargetScoringSubsystem* TargetScoring = World.Get()->GetSubsystem<UCPP_TargetScoringSubsystem>();
+		if (!TestNotNull(TEXT("Target scoring"), TargetScoring)) return false;
+
+		FRandomStream Random(NumCharacters);
+		TArray<ACPP_CharacterBase*> Characters;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			const FVector Location(Random.FRandRange(-2000.0f, 2000.0f), Random.FRandRange(-2000.0f, 2000.0f), 0.0f);
+			const FRotator Rotation(0.0f, Random.FRandRange(0.0f, 360.0f), 0.0f);
+			Characters.Add(World.Spawn<ACPP_CharacterBase>(ACPP_CharacterBase::StaticClass(), Location, Rotation));
+		}
+
+		const TArray<APawn*> Pawns(Characters);
+		for (ACPP_CharacterBase* Character : Characters)
+		{
+			TArray<APawn*> Others = Pawns;
+			Others.RemoveSingleSwap(Character);
+			Character->ApplyPerception(Others, {});
+		}
+		TargetScoring->ResolvePendingSelections();
+
+		auto RunFrames = [&](bool bBatchScoring)
+		{
+			TargetScoring->bBatchScoring = bBatchScoring;
+
+			const double StartTime = FPlatformTime::Seconds();
+			for (int32 Frame = 0; Frame < Frames; ++Frame)
+			{
+				for (ACPP_CharacterBase* Character : Characters)
+					Character->ApplyPerception({}, {});
+				TargetScoring->ResolvePendingSelections();
+			}
+			return (FPlatformTime::Seconds() - StartTime) * 1000.0 / Frames;
+		};
+
+		const double PerActorMilliseconds = RunFrames(false);
+		TArray<APawn*> PerActorSelection;
+		for (ACPP_CharacterBase* Character : Characters)
+			PerActorSelection.Add(Character->GetSelectedPawn());
+
+		const double BatchedMilliseconds = RunFrames(true);
+		int32 Mismatches = 0;
+		for (int32 Index = 0; Index < Characters.Num(); ++Index)
+			Mismatches += Characters[Index]->GetSelectedPawn() != PerActorSelection[Index];
+
+		TestEqual(FString::Printf(TEXT("Selections differing between paths with %d characters"), NumCharacters), Mismatches, 0);
+		AddInfo(FString::Printf(TEXT("%3d characters: per-actor %.3f ms, batched %.3f ms per frame"),
+		                        NumCharacters, PerActorMilliseconds, BatchedMilliseconds));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+
+/**
+ * Game world owned by an automation test. The world subsystems are initialized and play has begun,
+ * so spawned actors run BeginPlay and register with the subsystems like in a match.
+ * The world is destroyed with the helper.
+ */
+class FCPP_TestWorld
+{
+public:
+	FCPP_TestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ArenaFighterTestWorld"));
+
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		// There is no game mode to start play, begin it directly
+		if (!World->HasBegunPlay())
+			World->GetWorldSettings()->NotifyBeginPlay();
+	}
+
+	~FCPP_TestWorld()
+	{
+		World->BeginTearingDown();
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+
+	UWorld* Get() const { return World; }
+
+	template <typename T>
+	T* Spawn(UClass* Class, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator) const
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		return World->SpawnActor<T>(Class, Location, Rotation, SpawnParameters);
+	}
+
+	/** Ticks the whole world, including the tickable world subsystems, for a number of frames. */
+	void Tick(float DeltaTime, int32 Frames = 1) const
+	{
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+			World->Tick(LEVELTICK_All, DeltaTime);
+	}
+
+private:
+	UWorld* World = nullptr;
+};
+
+#endif
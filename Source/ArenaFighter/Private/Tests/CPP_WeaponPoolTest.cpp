@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CPP_CharacterBase.h"
+#include "CPP_TestWorld.h"
+#include "CPP_Weapon.h"
+#include "CPP_WeaponPoolSubsystem.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/UObjectArray.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FCPP_WeaponPoolSwapTest, "ArenaFighter.WeaponPool.Swap",
+                                 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+/**
+ * Swaps between the sword and dagger Blueprints 10,000 times with the pool disabled (spawn and destroy, as before
+ * pooling) and enabled, checks that each swap equips the other class, and reports the UObjects created, the resident memory growth and the swap time percentiles of each.
+ */
+bool FCPP_WeaponPoolSwapTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 Swaps = 10000;
+
+	// Two distinct classes, so every swap releases into one bucket and acquires from the other
+	UClass* SwordClass = LoadClass<ACPP_Weapon>(nullptr, TEXT("/Game/Blueprints/Weapon/BP_Sword_Weapon.BP_Sword_Weapon_C"));
+	UClass* DaggerClass = LoadClass<ACPP_Weapon>(nullptr, TEXT("/Game/Blueprints/Weapon/BP_Dagger_Weapon.BP_Dagger_Weapon_C"));
+	if (!TestNotNull(TEXT("Sword class"), SwordClass) || !TestNotNull(TEXT("Dagger class"), DaggerClass)) return false;
+	if (!TestNotEqual(TEXT("Weapon classes differ"), SwordClass, DaggerClass)) return false;
+
+	for (const bool bPoolWeapons : { false, true })
+	{
+		FCPP_TestWorld World;
+		UCPP_WeaponPoolSubsystem* WeaponPool = World.Get()->GetSubsystem<UCPP_WeaponPoolSubsystem>();
+		if (!TestNotNull(TEXT("Weapon pool"), WeaponPool)) return false;
+		WeaponPool->bPoolWeapons = bPoolWeapons;
+
+		// Weapons is only editable from the editor and Blueprints, fill it before BeginPlay
+		ACPP_CharacterBase* Character = World.Get()->SpawnActorDeferred<ACPP_CharacterBase>(
+			ACPP_CharacterBase::StaticClass(), FTransform::Identity, nullptr, nullptr,
+			ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		const FArrayProperty* WeaponsProperty = FindFProperty<FArrayProperty>(ACPP_CharacterBase::StaticClass(), TEXT("Weapons"));
+		if (!TestNotNull(TEXT("Weapons property"), WeaponsProperty)) return false;
+
+		TArray<TSubclassOf<ACPP_Weapon>>& Weapons =
+			*WeaponsProperty->ContainerPtrToValuePtr<TArray<TSubclassOf<ACPP_Weapon>>>(Character);
+		Weapons = { SwordClass, DaggerClass };
+		Character->FinishSpawning(FTransform::Identity);
+
+		// The classes are resident, so the first swap round equips synchronously and warms the pool of each class
+		if (!TestTrue(TEXT("Sword equipped first"), Character->GetEquippedWeapon() && Character->GetEquippedWeapon()->IsA(SwordClass)))
+			return false;
+
+		const int32 ObjectsBefore = GUObjectArray.GetObjectArrayNumMinusAvailable();
+		const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+		TArray<float> SwapTimes;
+		SwapTimes.Reserve(Swaps);
+		for (int32 Swap = 0; Swap < Swaps; ++Swap)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			Character->ChangeWeapon(Swap % 2 == 0 ? 1.0f : -1.0f);
+			SwapTimes.Add((FPlatformTime::Seconds() - StartTime) * 1e6);
+
+			const ACPP_Weapon* Equipped = Character->GetEquippedWeapon();
+			if (!TestTrue(TEXT("Swap equips the other class"), Equipped && Equipped->IsA(Swap % 2 == 0 ? DaggerClass : SwordClass)))
+				return false;
+		}
+
+		const int32 ObjectsCreated = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectsBefore;
+		const int64 MemoryGrowth = static_cast<int64>(FPlatformMemory::GetStats().UsedPhysical) - static_cast<int64>(MemoryBefore);
+
+		TestNotNull(TEXT("Equipped weapon after swapping"), Character->GetEquippedWeapon());
+		if (bPoolWeapons)
+		{
+			TestTrue(TEXT("Pooled swaps create no objects"), ObjectsCreated <= 0);
+			// The last swap equips the sword again and puts the dagger back into its own bucket
+			TestTrue(TEXT("Released dagger is pooled"), WeaponPool->GetNumFree(DaggerClass) >= 1);
+		}
+
+		SwapTimes.Sort();
+		auto Percentile = [&SwapTimes](float Fraction)
+		{
+			return SwapTimes[FMath::Clamp(FMath::FloorToInt32(Fraction * SwapTimes.Num()), 0, SwapTimes.Num() - 1)];
+		};
+
+		AddInfo(FString::Printf(TEXT("%s: %d UObjects created, %+.1f MiB resident, swap P50 %.1f us, P90 %.1f us, P99 %.1f us, max %.1f us"),
+		                        bPoolWeapons ? TEXT("Pooled  ") : TEXT("Spawning"), ObjectsCreated,
+		                        MemoryGrowth / (1024.0 * 1024.0), Percentile(0.5f), Percentile(0.9f),
+		                        Percentile(0.99f), Percentile(1.0f)));
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNotifies/AnimNotify.h"
+#include "CPP_AnimNotify_MeleeHit.generated.h"
+
+/**
+ * @class UCPP_AnimNotify_MeleeHit
+ * @brief Native replacement for the AN_AttackApplyDamage notify.
+ *
+ * Starts a melee swing of the owning ACPP_CharacterBase's equipped weapon. The hits are found with
+ * UCPP_MeleeHitSubsystem and delivered on the next frame, so attack montages no longer need the
+ * Blueprint OnApplyAttackDamage event to look for targets.
+ */
+UCLASS(meta = (DisplayName = "Melee Hit"))
+class ARENAFIGHTER_API UCPP_AnimNotify_MeleeHit : public UAnimNotify
+{
+	GENERATED_BODY()
+
+public:
+	/** Also calls the Blueprint OnApplyAttackDamage event, e.g. for effects and sounds. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Notify")
+	bool bCallApplyAttackDamageEvent = false;
+
+	virtual FString GetNotifyName_Implementation() const override;
+	virtual void Notify(USkeletalMeshComponent* MeshComp, UAnimSequenceBase* Animation,
+	                    const FAnimNotifyEventReference& EventReference) override;
+};
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_ArenaStressSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+class ACPP_EnemyCharacterBase;
+
+/**
+ * Pass thresholds of a stress step. The frame time is an absolute budget, since what the player feels is the
+ * whole frame whatever the enemy count; the systems are in microseconds of game thread time per enemy per frame.
+ */
+USTRUCT()
+struct FCPP_StressBudget
+{
+	GENERATED_BODY()
+
+public:
+	/** Average frame time allowed, in milliseconds. */
+	UPROPERTY(Config)
+	float FrameMilliseconds = 16.6f;
+
+	UPROPERTY(Config)
+	float Sensing = 10.0f;
+
+	UPROPERTY(Config)
+	float Selection = 5.0f;
+
+	UPROPERTY(Config)
+	float Damage = 5.0f;
+
+	UPROPERTY(Config)
+	float WeaponEquip = 5.0f;
+
+	UPROPERTY(Config)
+	float StateMachines = 10.0f;
+};
+
+/**
+ * @class UCPP_ArenaStressSubsystem
+ * @brief Headless stress run of the arena with growing enemy counts.
+ *
+ * Started with -ArenaStress=10,100,500,1000 on the command line, usually together with
+ * -game -nullrhi -unattended and the arena map. For every count the run spawns that many enemies of
+ * EnemyClass (or -ArenaStressEnemy=ClassPath) through the enemy pool around the player, keeps the
+ * population topped up as enemies die, lets the fight warm up and then measures for MeasureSeconds.
+ *
+ * The player is scripted: it attacks the nearest enemy and cycles weapons at fixed intervals, and enemies
+ * within their AttackTargetRadius that get an attack token attack it while it has more than a quarter of its health.
+ *
+ * Each step writes one CSV row with the average frame time and the game thread time spent in sensing,
+ * target selection, damage, weapon equip and state machines (see FCPP_StressTimers), and checks them
+ * against Budget: the frame time as is, the systems per enemy. The scripted player and enemies have their own
+ * Script column, which is left out of the frame time that is checked. The CSV goes to -ArenaStressCsv=File or
+ * Saved/Stress, and a run started from the command line exits the process with status 1 when any step failed.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_ArenaStressSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Config)
+	TSoftClassPtr<ACPP_EnemyCharacterBase> EnemyClass;
+
+	UPROPERTY(Config)
+	FCPP_StressBudget Budget;
+
+	UPROPERTY(Config)
+	float WarmupSeconds = 3.0f;
+
+	UPROPERTY(Config)
+	float MeasureSeconds = 10.0f;
+
+	/** Enemies are spawned at a random distance up to SpawnRadius from the player. */
+	UPROPERTY(Config)
+	float SpawnRadius = 3000.0f;
+
+	UPROPERTY(Config)
+	int32 SpawnsPerFrame = 20;
+
+	UPROPERTY(Config)
+	float PlayerAttackInterval = 0.5f;
+
+	UPROPERTY(Config)
+	float PlayerDamage = 25.0f;
+
+	UPROPERTY(Config)
+	float WeaponChangeInterval = 2.0f;
+
+	/** Seconds between two attacks of the enemies holding a token. Requests are renewed every frame in between. */
+	UPROPERTY(Config)
+	float EnemyAttackInterval = 1.0f;
+
+	UPROPERTY(Config)
+	float EnemyDamage = 1.0f;
+
+private:
+	enum class EPhase : uint8
+	{
+		Idle,
+		Spawning,
+		Warmup,
+		Measuring,
+	};
+
+	EPhase Phase = EPhase::Idle;
+	TArray<int32> EnemyCounts;
+	int32 StepIndex = 0;
+	double PhaseEndTime = 0.0;
+
+	TArray<TWeakObjectPtr<ACPP_EnemyCharacterBase>> Enemies;
+	TSubclassOf<ACPP_EnemyCharacterBase> LoadedEnemyClass;
+	FRandomStream SpawnStream;
+
+	double NextPlayerAttackTime = 0.0;
+	double NextWeaponChangeTime = 0.0;
+	double NextEnemyAttackTime = 0.0;
+
+	// Measurement of the current step
+	int32 MeasuredFrames = 0;
+	double FrameSecondsSum = 0.0;
+	double LastFrameSeconds = 0.0;
+
+	FString CsvPath;
+	FString Csv;
+	bool bAllStepsPassed = true;
+
+	/** The run was started from the command line and ends the process when it is over. */
+	bool bExitWhenFinished = false;
+
+public:
+	/**
+	 * Starts a stress run over the given enemy counts.
+	 *
+	 * @return False when no enemy class is configured or a run is already going.
+	 */
+	bool StartRun(const TArray<int32>& InEnemyCounts);
+
+	bool IsRunning() const { return Phase != EPhase::Idle; }
+
+	/** The CSV of the current or last run: a header line, then one row per finished step. */
+	const FString& GetCsv() const { return Csv; }
+
+	bool DidAllStepsPass() const { return bAllStepsPassed; }
+
+	// USubsystem / FTickableGameObject
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void BeginStep();
+	void FinishStep();
+	void FinishRun();
+
+	/** Spawns or releases enemies towards the enemy count of the current step. Returns the number of live enemies. */
+	int32 MaintainEnemyCount(const ACPP_CharacterBase* Player);
+
+	void ScriptPlayer(ACPP_CharacterBase* Player, double Now);
+
+	ACPP_CharacterBase* GetPlayer() const;
+};
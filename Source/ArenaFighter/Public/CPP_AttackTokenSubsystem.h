@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_AttackTokenSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+struct FCPP_RoundsConfig;
+
+/**
+ * @class UCPP_AttackTokenSubsystem
+ * @brief Caps the number of enemies attacking the same ICPP_AttackTarget at once.
+ *
+ * Enemies in reach of a target call RequestToken every time they want to attack it. Every RankInterval the
+ * requests of each target are ranked by distance minus ThreatDistance times the threat of the enemy's weapon
+ * (damage per second), and the best AttackSlots requests hold the target's tokens. A token is kept for at least
+ * MinTokenHoldSeconds, so close rankings do not hand tokens back and forth every interval. Requests not renewed
+ * for RequestTimeout are dropped along with their token.
+ *
+ * Enemies without a token circle the target and only update their movement every CirclingUpdateInterval.
+ * AttackSlots and CirclingUpdateInterval come from the round configuration of the current wave.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_AttackTokenSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Seconds between two rankings of the requests. */
+	UPROPERTY(Config)
+	float RankInterval = 0.2f;
+
+	/** Distance one point of weapon damage per second is worth in the ranking. */
+	UPROPERTY(Config)
+	float ThreatDistance = 10.0f;
+
+	UPROPERTY(Config)
+	float MinTokenHoldSeconds = 1.0f;
+
+	UPROPERTY(Config)
+	float RequestTimeout = 0.5f;
+
+private:
+	struct FRequest
+	{
+		TWeakObjectPtr<ACPP_EnemyCharacterBase> Enemy;
+		double LastRequestTime = 0.0;
+		double TokenTime = 0.0;
+		float Score = 0.0f;
+		bool bHasToken = false;
+	};
+
+	struct FTargetTokens
+	{
+		TWeakObjectPtr<AActor> Target;
+		TArray<FRequest> Requests;
+		int32 NumHolders = 0;
+	};
+
+	TArray<FTargetTokens> Targets;
+
+	int32 AttackSlots = 3;
+	float CirclingUpdateInterval = 0.5f;
+
+	double NextRankTime = 0.0;
+	int32 QueueLength = 0;
+	int32 TokenTurnovers = 0;
+
+public:
+	/** Takes AttackSlots and CirclingUpdateInterval from the round configuration. */
+	void ApplyRoundConfig(const FCPP_RoundsConfig& Config);
+
+	/**
+	 * Registers or renews the enemy's request to attack Target. A request gets a free token right away;
+	 * otherwise it waits for the next ranking.
+	 *
+	 * @return True when the enemy holds one of Target's tokens and may attack.
+	 */
+	bool RequestToken(ACPP_EnemyCharacterBase* Enemy, AActor* Target);
+
+	/** Drops every request of the enemy, e.g. when it dies or goes back to the pool. */
+	void ReleaseTokens(const ACPP_EnemyCharacterBase* Enemy);
+
+	int32 GetAttackSlots() const { return AttackSlots; }
+
+	float GetCirclingUpdateInterval() const { return CirclingUpdateInterval; }
+
+	/** Number of requests waiting for a token after the last ranking, over all targets. */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	int32 GetQueueLength() const { return QueueLength; }
+
+	/** Number of tokens handed to a new holder since the start of the game. */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	int32 GetTokenTurnovers() const { return TokenTurnovers; }
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Ranks the requests of one target and moves tokens to the best ones. Returns the number of tokens handed out. */
+	int32 RankRequests(FTargetTokens& Tokens, double Now);
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTService.h"
+#include "CPP_BTService_EnemyDecisions.generated.h"
+
+/**
+ * @class UCPP_BTService_EnemyDecisions
+ * @brief Hands the chase and lost-target decisions of the tree over to UCPP_EnemyDecisionSubsystem.
+ *
+ * The service does not tick: it registers the tree with the subsystem while it is relevant, and the subsystem
+ * updates TargetKey and ShouldChaseKey for all enemies from one time-sliced queue.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTService_EnemyDecisions : public UBTService
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTService_EnemyDecisions();
+
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector TargetKey;
+
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector ShouldChaseKey;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	virtual void OnBecomeRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual void OnCeaseRelevant(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CPP_BTTask_EnemyBase.h"
+#include "CPP_BTTask_Attack.generated.h"
+
+class UAnimInstance;
+class UAnimMontage;
+
+/**
+ * @class UCPP_BTTask_Attack
+ * @brief Native replacement for BTTask_Enemy_Attack.
+ *
+ * Plays AttackMontage at the attack speed of the equipped weapon and succeeds when it stops playing.
+ * Damage is dealt by the montage notifies, as with the Blueprint task. Fails without one of the target's attack tokens,
+ * and renews the token request every tick while the montage plays.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTTask_Attack : public UCPP_BTTask_EnemyBase
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_Attack();
+
+	UPROPERTY(EditAnywhere, Category = "Node")
+	TObjectPtr<UAnimMontage> AttackMontage;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+	virtual EBTNodeResult::Type AbortTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+protected:
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	UAnimInstance* GetAnimInstance(const UBehaviorTreeComponent& OwnerComp) const;
+};
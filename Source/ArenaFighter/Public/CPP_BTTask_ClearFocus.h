@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "CPP_BTTask_ClearFocus.generated.h"
+
+/**
+ * @class UCPP_BTTask_ClearFocus
+ * @brief Native replacement for BTTask_ClearFocus: clears the gameplay focus of the AI controller.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTTask_ClearFocus : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_ClearFocus();
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+};
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BTTaskNode.h"
+#include "CPP_BTTask_EnemyBase.generated.h"
+
+class ACPP_EnemyCharacterBase;
+
+/**
+ * @class UCPP_BTTask_EnemyBase
+ * @brief Base of the native enemy behavior tree tasks.
+ *
+ * TargetKey is resolved once when the tree asset is loaded, so tasks read the target by key ID instead of
+ * looking it up by name. When TargetKey is not set, tasks use the enemy's SelectedPawn like the Blueprint tasks.
+ */
+UCLASS(Abstract)
+class ARENAFIGHTER_API UCPP_BTTask_EnemyBase : public UBTTaskNode
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_EnemyBase();
+
+	/** Blackboard key holding the attack target actor, usually written by UCPP_BTService_EnemyDecisions. */
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector TargetKey;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual FString GetStaticDescription() const override;
+
+protected:
+	static ACPP_EnemyCharacterBase* GetEnemy(const UBehaviorTreeComponent& OwnerComp);
+
+	AActor* GetTarget(const UBehaviorTreeComponent& OwnerComp, const ACPP_EnemyCharacterBase* Enemy) const;
+};
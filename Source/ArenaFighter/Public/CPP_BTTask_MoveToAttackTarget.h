@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CPP_BTTask_EnemyBase.h"
+#include "CPP_BTTask_MoveToAttackTarget.generated.h"
+
+/**
+ * @class UCPP_BTTask_MoveToAttackTarget
+ * @brief Moves the enemy toward its attack target by sampling UCPP_FlowFieldSubsystem every tick.
+ *
+ * Native replacement for the MoveTo based BTTask_MoveToAttackTarget Blueprint: no path is requested, so
+ * the per-enemy cost does not grow with the distance to the target. The enemy walks straight toward the
+ * target while its field is not built yet or when both are in the same cell.
+ * Succeeds within AttackTargetRadius of the target, fails when the target is gone.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTTask_MoveToAttackTarget : public UCPP_BTTask_EnemyBase
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_MoveToAttackTarget();
+
+	/** Distance at which the task succeeds. Negative uses the enemy's AttackTargetRadius. */
+	UPROPERTY(EditAnywhere, Category = "Node")
+	float AcceptanceRadius = -1.0f;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+protected:
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	/** Moves the pawn one tick toward the target, returns the task result once it is known. */
+	EBTNodeResult::Type Move(const UBehaviorTreeComponent& OwnerComp) const;
+};
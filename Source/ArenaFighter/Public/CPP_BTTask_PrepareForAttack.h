@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CPP_BTTask_EnemyBase.h"
+#include "CPP_BTTask_PrepareForAttack.generated.h"
+
+/**
+ * @class UCPP_BTTask_PrepareForAttack
+ * @brief Native replacement for BTTask_Enemy_PrepareForAttack.
+ *
+ * Keeps the enemy focused on its target and succeeds once it holds one of the target's attack tokens and the
+ * target is within the attack range of the equipped weapon, or AttackTargetRadius without a weapon.
+ *
+ * Until the enemy gets a token it circles the target CirclingDistance beyond AttackTargetRadius, and the task
+ * only ticks every CirclingUpdateInterval of the round. With a token it moves in to attack range. Fails when the
+ * target is gone or gets more than two CirclingDistance beyond AttackTargetRadius.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTTask_PrepareForAttack : public UCPP_BTTask_EnemyBase
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_PrepareForAttack();
+
+	UPROPERTY(EditAnywhere, Category = "Circling")
+	float CirclingDistance = 150.0f;
+
+	/** Angle around the target covered by one circling move. */
+	UPROPERTY(EditAnywhere, Category = "Circling")
+	float CirclingStepDegrees = 30.0f;
+
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+
+protected:
+	virtual void TickTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory, float DeltaSeconds) override;
+
+private:
+	EBTNodeResult::Type Prepare(const UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) const;
+
+	/** Moves the enemy to the next point of its circle around the target. */
+	void Circle(AAIController& Controller, const ACPP_EnemyCharacterBase& Enemy, const AActor& Target) const;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CPP_BTTask_EnemyBase.h"
+#include "CPP_BTTask_ShouldChase.generated.h"
+
+/**
+ * @class UCPP_BTTask_ShouldChase
+ * @brief Native replacement for BTTask_Enemy_ShouldChase.
+ *
+ * Succeeds and focuses the target when the enemy should chase it, fails otherwise. The decision is read from
+ * ShouldChaseKey when it is set, as written by UCPP_BTService_EnemyDecisions; without it the task checks
+ * that the enemy and its target are alive.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_BTTask_ShouldChase : public UCPP_BTTask_EnemyBase
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_BTTask_ShouldChase();
+
+	UPROPERTY(EditAnywhere, Category = "Blackboard")
+	FBlackboardKeySelector ShouldChaseKey;
+
+	virtual void InitializeFromAsset(UBehaviorTree& Asset) override;
+	virtual EBTNodeResult::Type ExecuteTask(UBehaviorTreeComponent& OwnerComp, uint8* NodeMemory) override;
+};
@@ -4,14 +4,29 @@
 
 #include "CoreMinimal.h"
 #include "CPP_AttackTarget.h"
+#include "CPP_CombatAttributeSubsystem.h"
 #include "CPP_Weapon.h"
 #include "GameFramework/Character.h"
-#include "Perception/PawnSensingComponent.h"
 #include "CPP_CharacterBase.generated.h"
 
+struct FStreamableHandle;
+
 // Forward declaration for the event dispatcher delegate type
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnDieEvent);
 
+/** Reasons for a character to tick. The actor tick is enabled only while at least one reason is set. */
+enum class ECPP_TickRequest : uint8
+{
+	None = 0,
+	/** Drawing the debug arrow towards SelectedPawn. */
+	DebugDraw = 1 << 0,
+	/** A state machine owned by the character needs OnTick. */
+	StateMachine = 1 << 1,
+	/** The Blueprint class implements Event Tick. */
+	Blueprint = 1 << 2,
+};
+ENUM_CLASS_FLAGS(ECPP_TickRequest);
+
 /**
  * ACPP_CharacterBase defines the base character class in the Arena Fighter game.
  * This class manages character attributes like health, weapon handling, and related events.
@@ -56,10 +71,19 @@ protected:
 	/**
 	 * Weapons is an array that holds different types of weapon classes available to the character.
 	 * Configurable in the editor and accessible within Blueprints, this array is used to manage and switch between various weapons the character can equip.
+	 * These are hard references kept for existing Blueprints; they are copied into SoftWeapons, which the character equips from.
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
 	TArray<TSubclassOf<ACPP_Weapon>> Weapons;
 
+	/**
+	 * Weapon classes the character cycles through, as soft references loaded asynchronously on BeginPlay unless the
+	 * round streaming already did. Filled from Weapons on PostLoad and BeginPlay, followed by the classes only listed here.
+	 * Moving a Blueprint's classes from Weapons to here keeps them from loading together with the character class.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
+	TArray<TSoftClassPtr<ACPP_Weapon>> SoftWeapons;
+
 	/**
 	 * CurrentWeaponIndex keeps track of the index of the weapon currently equipped by the character.
 	 * This variable is configurable in the editor and accessible within Blueprints under the "Weapon" category.
@@ -68,8 +92,24 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
 	int CurrentWeaponIndex = 0;
 
+	/**
+	 * Distance within which the character sees other pawns, see UCPP_PerceptionSubsystem.
+	 * The sensing settings are taken from a UPawnSensingComponent instead while the Blueprint still has one.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing")
-	UPawnSensingComponent* PawnSensing = nullptr;
+	float SightRadius = 5000.0f;
+
+	/** Half-angle in degrees of the view cone, measured from the eyes' forward direction. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing", meta = (ClampMin = 0, ClampMax = 180))
+	float PeripheralVisionAngle = 90.0f;
+
+	/** Only pawns controlled by players are seen, e.g. enemies do not see each other. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing")
+	bool bOnlySensePlayers = true;
+
+	/** Seconds between two perception updates of the character. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing", meta = (ClampMin = 0))
+	float SensingInterval = 0.5f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing")
 	TSet<APawn*> DetectedPawns;
@@ -82,8 +122,25 @@ protected:
 
 	UPROPERTY(EditAnywhere, Category = "Sensing")
 	FVector SelectedPawnArrowOffset = FVector::ZeroVector;
-	
-	FTimerHandle CheckSightTimerHandle;
+
+	/** Draws a debug arrow to SelectedPawn every frame, for debugging. Ticking is only enabled for it while a pawn is selected. */
+	UPROPERTY(EditAnywhere, Category = "Sensing")
+	bool bDrawSelectedPawnArrow = false;
+
+private:
+	ECPP_TickRequest TickRequests = ECPP_TickRequest::None;
+
+	/** DetectedPawns changed; OnDetectedPawnsChanged is raised once the requested selection is applied. */
+	bool bDetectedPawnsChangedPending = false;
+
+	/** Keeps the classes in SoftWeapons resident while the character is in play, so swaps never wait on a load. */
+	TSharedPtr<FStreamableHandle> WeaponClassesHandle;
+
+	/** Entry in the world's packed attribute store. Health is written there and mirrored into Health. */
+	UPROPERTY(Transient)
+	UCPP_CombatAttributeSubsystem* AttributeStore = nullptr;
+
+	FCPP_CombatAttributeHandle AttributeHandle;
 
 public:
 	// EVENTS
@@ -150,10 +207,65 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Character State")
 	bool IsDead();
 
+	float GetHealth() const { return Health; }
+
+	float GetMaxHealth() const { return MaxHealth; }
+
+	/** Sets Health, clamped to [0, MaxHealth], e.g. to carry it over from another representation of the character. */
+	void SetHealth(float NewHealth) { AddHealth(NewHealth - Health); }
+
+	/** Sets MaxHealth and clamps Health to it, keeping the attribute store in sync. */
+	UFUNCTION(BlueprintCallable, Category = "Attributes")
+	void SetMaxHealth(float NewMaxHealth);
+
+	APawn* GetSelectedPawn() const { return SelectedPawn; }
+
+	const TSet<APawn*>& GetDetectedPawns() const { return DetectedPawns; }
+
+	float GetSightRadius() const { return SightRadius; }
+
+	float GetPeripheralVisionAngle() const { return PeripheralVisionAngle; }
+
+	bool ShouldOnlySensePlayers() const { return bOnlySensePlayers; }
+
+	float GetSensingInterval() const { return SensingInterval; }
+
+	ACPP_Weapon* GetEquippedWeapon() const { return EquippedWeapon; }
+
+	const TArray<TSoftClassPtr<ACPP_Weapon>>& GetWeaponClasses() const { return SoftWeapons; }
+
+	int32 GetCurrentWeaponIndex() const { return CurrentWeaponIndex; }
+
+	FCPP_CombatAttributeHandle GetAttributeHandle() const { return AttributeHandle; }
+
+	/**
+	 * Starts a melee swing with EquippedWeapon. Hits are found by UCPP_MeleeHitSubsystem and
+	 * delivered to ICPP_AttackTarget::TakeAttack on the next frame.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Weapon")
+	void StartMeleeSwing();
+
+	/**
+	 * Sets or clears a reason to tick, enabling the actor tick while any reason is set.
+	 *
+	 * @param Request The reason to set or clear.
+	 * @param bRequested Whether the reason applies.
+	 */
+	void SetTickRequested(ECPP_TickRequest Request, bool bRequested);
+
+	/**
+	 * Enables ticking while a state machine driven from this character's Tick is active.
+	 * Call with false when the state machine stops so the character stops ticking.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Character State")
+	void SetStateMachineTickRequested(bool bRequested);
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void PostLoad() override;
+
 	/**
 	 * Tries to select the most appropriate pawn for interaction based on its proximity and position relative to the character.
 	 *
@@ -167,23 +279,48 @@ protected:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Sensing")
 	void TrySelectPawn();
+
+	/**
+	 * Asks for a new target selection.
+	 * The request is resolved in the batched pass of UCPP_TargetScoringSubsystem when available,
+	 * otherwise TrySelectPawn runs immediately. A pending OnDetectedPawnsChanged is raised when it resolves.
+	 */
+	void RequestSelectPawn();
 	
 	UFUNCTION()
 	virtual void HandleAnyDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser);
 	
-	void Die();
+	virtual void Die();
 
 	UFUNCTION(BlueprintCallable, Category = "Attributes")
 	void AddHealth(float add);
 
-private:
+	/**
+	 * Adds the character to the world-wide gameplay systems: perception, target index and attribute store.
+	 * Called on BeginPlay, and again when a pooled character is reused.
+	 */
+	virtual void RegisterWithWorldSubsystems();
+
+	/** Removes the character from every system it joined in RegisterWithWorldSubsystems. */
+	virtual void UnregisterFromWorldSubsystems();
+
+	/**
+	 * Restores Health to MaxHealth and forgets every detected and selected pawn,
+	 * so a character taken out of a pool starts like a freshly spawned one.
+	 */
+	virtual void ResetCharacterState();
+
 	/**
 	 * EquipSelectedWeapon handles the process of equipping a new weapon for the character.
-	 * It first destroys the currently equipped weapon if it exists, and then spawns and attaches
-	 * the new weapon from the character's weapon inventory based on the CurrentWeaponIndex.
+	 * It first returns the currently equipped weapon to the UCPP_WeaponPoolSubsystem if it exists, and then acquires
+	 * and attaches the new weapon from the character's weapon inventory based on the CurrentWeaponIndex.
 	 */
 	void EquipSelectedWeapon();
 
+	/** Returns EquippedWeapon to the weapon pool, or destroys it when there is no pool. */
+	void UnequipWeapon();
+
+private:
 	/**
 	 * NextWeapon is used to cycle to the next weapon in the character's weapons inventory.
 	 * When the end of the weapon list is reached, it loops back to the first weapon.
@@ -199,21 +336,72 @@ private:
 	 */
 	void PrevWeapon();
 
+	/** Puts the classes in Weapons at the front of SoftWeapons, keeping the classes only listed in SoftWeapons after them. */
+	void SyncSoftWeapons();
+
+	/** Starts the asynchronous load of the classes in SoftWeapons, then equips the selected weapon if it was not loaded yet. */
+	void LoadWeaponClasses();
+
 	/**
-	 * OnSeePawn is called when the character detects another pawn.
-	 * This function can be implemented to define custom behavior upon detecting other pawns in the game world.
+	 * Takes the sensing settings of a UPawnSensingComponent left on the Blueprint and removes the component,
+	 * so it does not run its own sensing next to UCPP_PerceptionSubsystem.
+	 */
+	void ImportPawnSensingComponent();
+
+public:
+	/**
+	 * Queues the hit with UCPP_DamageSubsystem, or applies it right away through UGameplayStatics::ApplyDamage
+	 * when batching is disabled.
+	 */
+	virtual void TakeAttack(ACharacter* attacker, float damage) override;
+
+	/**
+	 * Applies the summed damage of every hit this character took in a frame as one damage event, so
+	 * OnTakeAnyDamage and the Blueprint AnyDamage event fire once with the total, followed by a single
+	 * OnHealthChanged and at most one Die. Called by UCPP_DamageSubsystem.
 	 *
-	 * @param DetectedPawn The pawn that has been detected by the character.
+	 * @param Damage Total damage of the hits.
+	 * @param Hits Number of hits that were summed.
+	 * @param LastDamageCauser Attacker of the last hit, reported as the damage causer.
 	 */
-	UFUNCTION()
-	void OnSeePawn(APawn* DetectedPawn);
+	void ApplyBatchedDamage(float Damage, int32 Hits, AActor* LastDamageCauser);
 
 	/**
-	 * Checks for any pawns that the character has lost sight of and updates the list of detected pawns accordingly.
-	 * If any pawns are removed from the detection list, it attempts to select a new target.
+	 * Applies the changes found by UCPP_PerceptionSubsystem to DetectedPawns, then re-selects a target and
+	 * raises OnDetectedPawnsChanged once the new selection is applied.
+	 *
+	 * @param Added Pawns seen that were not detected yet.
+	 * @param Removed Detected pawns that are no longer seen.
 	 */
-	void CheckForLostSight();
+	void ApplyPerception(TConstArrayView<APawn*> Added, TConstArrayView<APawn*> Removed);
 
-public:
-	virtual void TakeAttack(ACharacter* attacker, float damage) override;
+	/**
+	 * Called by UCPP_LineOfSightSubsystem when an asynchronous trace found Target hidden from this character.
+	 * Removes the pawn from DetectedPawns and re-selects a target.
+	 *
+	 * @param Target The pawn that is no longer visible.
+	 */
+	void OnLineOfSightLost(APawn* Target);
+
+	/**
+	 * Collects the living detected pawns within SightRadius that TrySelectPawn should score.
+	 *
+	 * When the world has a UCPP_TargetIndexSubsystem, the candidates come from the grid cells within SightRadius
+	 * in front of the character, filtered by DetectedPawns; pawns behind the character may be left out, as
+	 * TrySelectPawn would skip them. Without an index the detected pawns are walked directly.
+	 *
+	 * @param OutCandidates Receives the candidates. It is emptied before collecting.
+	 */
+	void GatherSelectionCandidates(TArray<ACPP_CharacterBase*>& OutCandidates) const;
+
+	/**
+	 * Sets SelectedPawn and raises OnSelectedPawnChanged when the selection actually changed,
+	 * then OnDetectedPawnsChanged when the selection was requested after DetectedPawns changed.
+	 *
+	 * @param NewSelectedPawn The pawn to select, or nullptr to clear the selection.
+	 */
+	void ApplySelectedPawn(APawn* NewSelectedPawn);
+
+	/** Drops a selection requested from UCPP_TargetScoringSubsystem but not resolved yet, e.g. on death. */
+	void CancelPendingSelection();
 };
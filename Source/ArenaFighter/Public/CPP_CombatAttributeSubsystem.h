@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_CombatAttributeSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+
+/**
+ * Stable reference to a character's entry in UCPP_CombatAttributeSubsystem.
+ * The generation makes a handle kept past Unregister invalid instead of pointing at a reused entry.
+ */
+struct FCPP_CombatAttributeHandle
+{
+	int32 Slot = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsSet() const { return Slot != INDEX_NONE; }
+	void Reset() { *this = FCPP_CombatAttributeHandle(); }
+};
+
+/**
+ * @class UCPP_CombatAttributeSubsystem
+ * @brief Packed store of the combat attributes of every registered character.
+ *
+ * Health, max health, weapon index, weapon reach and damage, team and location of all characters live in
+ * parallel arrays, so arena-wide queries walk a few contiguous arrays instead of touching every actor.
+ * Characters register on BeginPlay and get a generational handle; removal swaps the last entry into the
+ * freed place and only the slot table is updated, so handles stay valid.
+ *
+ * Locations are refreshed lazily, at most once per frame and only when a location query runs. Health and max
+ * health are written through the store by ACPP_CharacterBase, which mirrors them into its properties for Blueprints.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_CombatAttributeSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+	struct FSlot
+	{
+		int32 DenseIndex = INDEX_NONE;
+		uint32 Generation = 0;
+	};
+
+	TArray<FSlot> Slots;
+	TArray<int32> FreeSlots;
+
+	// Dense attributes, one entry per registered character
+	TArray<ACPP_CharacterBase*> Characters;
+	TArray<int32> DenseSlots;
+	TArray<float> Health, MaxHealth;
+	TArray<int32> WeaponIndex;
+	TArray<float> WeaponReach, WeaponDamage;
+	TArray<bool> IsEnemy;
+
+	// Refreshed by the first location query of a frame
+	mutable TArray<float> LocationX, LocationY, LocationZ;
+	mutable uint64 LocationsFrame = MAX_uint64;
+
+public:
+	/** Adds the character with its current attributes. */
+	FCPP_CombatAttributeHandle Register(ACPP_CharacterBase* Character);
+
+	/** Removes the entry of Handle and resets the handle. Does nothing for stale handles. */
+	void Unregister(FCPP_CombatAttributeHandle& Handle);
+
+	bool IsRegistered(const FCPP_CombatAttributeHandle& Handle) const { return GetDenseIndex(Handle) != INDEX_NONE; }
+
+	float GetHealth(const FCPP_CombatAttributeHandle& Handle) const;
+	float GetMaxHealth(const FCPP_CombatAttributeHandle& Handle) const;
+	bool IsDead(const FCPP_CombatAttributeHandle& Handle) const;
+
+	/** Sets health, clamped to [0, MaxHealth], and returns the stored value. */
+	float SetHealth(const FCPP_CombatAttributeHandle& Handle, float NewHealth);
+
+	/** Sets max health and clamps health to it. Returns the stored health. */
+	float SetMaxHealth(const FCPP_CombatAttributeHandle& Handle, float NewMaxHealth);
+
+	/** Adds Delta to health, clamped to [0, MaxHealth], and returns the stored value. */
+	float AddHealth(const FCPP_CombatAttributeHandle& Handle, float Delta);
+
+	/** Records the equipped weapon. Reach and damage are zero when nothing is equipped. */
+	void SetWeapon(const FCPP_CombatAttributeHandle& Handle, int32 Index, float Reach, float Damage);
+
+	int32 Num() const { return Characters.Num(); }
+
+	// Batch queries
+
+	/** Collects the living characters whose health is below Fraction of their max health. */
+	void QueryHealthBelow(float Fraction, bool bEnemiesOnly, TArray<ACPP_CharacterBase*>& OutCharacters) const;
+
+	/** Counts the living characters and sums their health. */
+	int32 CountAlive(bool bEnemiesOnly, float* OutHealthSum = nullptr) const;
+
+	/** Collects the living characters within Radius of Origin, e.g. the player's weapon reach. */
+	void QueryInRange(const FVector& Origin, float Radius, bool bEnemiesOnly,
+	                  TArray<ACPP_CharacterBase*>& OutCharacters) const;
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	int32 GetDenseIndex(const FCPP_CombatAttributeHandle& Handle) const;
+	void RefreshLocations() const;
+};
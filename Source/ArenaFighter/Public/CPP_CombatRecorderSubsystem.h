@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_CombatRecorderSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+class ACPP_EnemyCharacterBase;
+class U_CPP_RoundsConfigurations;
+class FMemoryWriter;
+
+/**
+ * @class UCPP_CombatRecorderSubsystem
+ * @brief Records the inputs of a fight to a compact binary file and replays them for benchmarking.
+ *
+ * Recorded inputs are ChangeWeapon and TakeAttack calls, round starts (rounds configuration asset and
+ * round number) and enemy spawns with their transform, each stamped with the frame it happened on.
+ *
+ * While replaying, live inputs of the same kinds are ignored and the recorded ones are applied on the
+ * same frames instead, so the fight resolves identically whatever the AI or the frame rate does.
+ * Once the last event is replayed and ReplaySettleFrames have passed, the replay reports frame time
+ * percentiles and the final health of every character to the log and to File.report.csv.
+ *
+ * Recording: -ArenaRecord=File on the command line, or the ArenaFighter.Recorder.Start [File] and
+ * ArenaFighter.Recorder.Stop console commands.
+ * Replay: -ArenaReplay=File, typically with -game -nullrhi -unattended. The engine runs with a fixed
+ * timestep of ReplayDeltaTime and exits after the report; the previous timestep settings are restored
+ * when the replay ends or the world is torn down.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_CombatRecorderSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Fixed frame time used while replaying, in seconds. */
+	UPROPERTY(Config)
+	float ReplayDeltaTime = 1.0f / 60.0f;
+
+	/** Frames to keep running after the last replayed event before reporting. */
+	UPROPERTY(Config)
+	int32 ReplaySettleFrames = 300;
+
+private:
+	enum class EMode : uint8
+	{
+		Idle,
+		Recording,
+		Replaying,
+	};
+
+	enum class EEventType : uint8
+	{
+		ActorName,
+		ChangeWeapon,
+		TakeAttack,
+		RoundStart,
+		Spawn,
+	};
+
+	/** A decoded replay event. Only the fields of its type are set. */
+	struct FReplayEvent
+	{
+		uint32 Frame = 0;
+		EEventType Type = EEventType::ActorName;
+		uint32 ActorId = 0;
+		uint32 OtherActorId = 0;
+		float Value = 0.0f;
+		int32 Round = 0;
+		FString Path;
+		FTransform Transform;
+	};
+
+	EMode Mode = EMode::Idle;
+	uint32 Frame = 0;
+
+	// Recording
+	FString RecordPath;
+	TArray<uint8> RecordBuffer;
+	TUniquePtr<FMemoryWriter> RecordWriter;
+	TMap<TWeakObjectPtr<AActor>, uint32> RecordedActorIds;
+	uint32 NextActorId = 1;
+
+	// Replay
+	FString ReplayPath;
+	TArray<FReplayEvent> ReplayEvents;
+	int32 NextReplayEvent = 0;
+	TMap<uint32, TWeakObjectPtr<AActor>> ReplayActors;
+
+	/** Actors of the world by name, so recorded actor names resolve without a scan of the world per event. */
+	TMap<FString, TWeakObjectPtr<AActor>> ReplayActorsByName;
+	TArray<float> FrameTimes;
+	double LastFrameSeconds = 0.0;
+	bool bDispatchingReplay = false;
+	bool bExitAfterReplay = false;
+
+	// Engine timestep settings replaced while replaying, restored when the replay ends
+	bool bTimeStepOverridden = false;
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+public:
+	/** Starts writing inputs to FilePath. The file is written when recording stops or the world ends. */
+	void StartRecording(const FString& FilePath);
+
+	void StopRecording();
+
+	/**
+	 * Loads a recording and starts replaying it from the next frame.
+	 *
+	 * @return False when the file cannot be read or is not a combat recording.
+	 */
+	bool StartReplay(const FString& FilePath);
+
+	bool IsRecording() const { return Mode == EMode::Recording; }
+
+	bool IsReplaying() const { return Mode == EMode::Replaying; }
+
+	/** False while replaying, except for the inputs the replay applies itself. Callers drop the input when false. */
+	bool AcceptsLiveInput() const { return Mode != EMode::Replaying || bDispatchingReplay; }
+
+	void RecordChangeWeapon(ACPP_CharacterBase* Character, float ActionValue);
+
+	void RecordTakeAttack(ACPP_CharacterBase* Target, AActor* Attacker, float Damage);
+
+	void RecordRoundStart(U_CPP_RoundsConfigurations* Configurations, int32 Round);
+
+	void RecordSpawn(ACPP_EnemyCharacterBase* Enemy, UClass* EnemyClass, const FTransform& SpawnTransform);
+
+	// USubsystem / FTickableGameObject
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Returns the recording id of an actor, writing its name the first time it is referenced. 0 is no actor. */
+	uint32 GetRecordedActorId(AActor* Actor);
+
+	void BeginEvent(EEventType Type);
+
+	void DispatchReplayEvent(const FReplayEvent& Event);
+
+	AActor* FindReplayActor(uint32 ActorId) const;
+
+	/** Looks an actor up in ReplayActorsByName, rebuilding it once when the name is not there yet. */
+	AActor* FindReplayActorByName(const FString& Name);
+
+	void RebuildReplayActorsByName();
+
+	void RestoreTimeStep();
+
+	void FinishReplay();
+};
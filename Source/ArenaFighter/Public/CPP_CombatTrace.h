@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NameTypes.h"
+
+/**
+ * ARENAFIGHTER_COMBAT_TRACE compiles the combat trace in or out.
+ * It defaults to on in every configuration but Shipping; when off, CPP_COMBAT_TRACE expands to nothing
+ * and its arguments are not evaluated.
+ */
+#ifndef ARENAFIGHTER_COMBAT_TRACE
+#define ARENAFIGHTER_COMBAT_TRACE !UE_BUILD_SHIPPING
+#endif
+
+/** Kinds of events written to the combat trace. Values are stored in trace files, so only append. */
+enum class ECPP_CombatEvent : uint8
+{
+	StateEnter,
+	StateExit,
+	Damage,
+	Death,
+	TargetChanged,
+	Detected,
+	LostSight,
+};
+
+/**
+ * One fixed-size combat trace record. Objects are identified by their name, captured when the record is written,
+ * so a dump names them correctly even after they were destroyed. None means no object.
+ */
+struct FCPP_CombatTraceRecord
+{
+	uint64 Cycles = 0;
+	uint32 Frame = 0;
+	float Value = 0.0f;
+	FMinimalName Subject;
+	FMinimalName Other;
+	ECPP_CombatEvent Event = ECPP_CombatEvent::StateEnter;
+	uint8 Padding[7] = {};
+};
+static_assert(sizeof(FCPP_CombatTraceRecord) == 40, "Combat trace records are stored in files and must keep their size");
+
+/**
+ * @class FCPP_CombatTrace
+ * @brief Structured, low-overhead trace of combat events.
+ *
+ * Each thread writes fixed-size binary records into its own ring buffer without locks; only the
+ * first write of a thread takes a lock to register its buffer. When a ring is full the oldest
+ * records are overwritten.
+ *
+ * Console commands:
+ * - ArenaFighter.CombatTrace.Dump [File] writes all rings, merged by time, to a binary file
+ *   in Saved/CombatTrace unless a file is given. When the trace is compiled out it only says so.
+ * - ArenaFighter.CombatTrace.Decode File [OutFile] turns a dump into readable text.
+ *
+ * The former on-screen and Log messages of the same events are only produced when
+ * ArenaFighter.VerboseCombatLog is set, see IsVerbose.
+ */
+class ARENAFIGHTER_API FCPP_CombatTrace
+{
+public:
+	/** Number of records kept per thread. Must be a power of two. */
+	static constexpr uint32 RecordsPerThread = 8192;
+
+	/** Appends a record to the calling thread's ring. Use the CPP_COMBAT_TRACE macro so it compiles out. */
+	static void Write(ECPP_CombatEvent Event, const UObject* Subject, const UObject* Other, float Value = 0.0f);
+
+	/** Writes every ring, sorted by time, and a table of the names the records refer to. */
+	static bool Dump(const FString& FilePath);
+
+	/** Decodes a file written by Dump into one line of text per record. */
+	static bool Decode(const FString& FilePath, const FString& OutFilePath);
+
+	/** Whether the string based combat messages are enabled (ArenaFighter.VerboseCombatLog). */
+	static bool IsVerbose();
+
+	static const TCHAR* GetEventName(ECPP_CombatEvent Event);
+};
+
+#if ARENAFIGHTER_COMBAT_TRACE
+#define CPP_COMBAT_TRACE(Event, Subject, Other, Value) FCPP_CombatTrace::Write(ECPP_CombatEvent::Event, Subject, Other, Value)
+#else
+#define CPP_COMBAT_TRACE(Event, Subject, Other, Value)
+#endif
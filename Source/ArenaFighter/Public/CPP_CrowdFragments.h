@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "CPP_CrowdFragments.generated.h"
+
+/** Location and facing of a crowd enemy. */
+USTRUCT()
+struct ARENAFIGHTER_API FCPP_CrowdTransformFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.0f;
+};
+
+/** Health carried between the crowd and the promoted actor, so demoting and promoting does not heal. */
+USTRUCT()
+struct ARENAFIGHTER_API FCPP_CrowdHealthFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	/** Negative until the enemy is first demoted; the promoted actor then keeps its own full health. */
+	float Health = -1.0f;
+};
+
+/** Enemy class the crowd member is promoted to, as an index into UCPP_CrowdSubsystem's class table. */
+USTRUCT()
+struct ARENAFIGHTER_API FCPP_CrowdEnemyFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	int32 EnemyClassIndex = INDEX_NONE;
+};
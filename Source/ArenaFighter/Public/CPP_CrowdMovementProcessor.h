@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityQuery.h"
+#include "MassProcessor.h"
+#include "CPP_CrowdMovementProcessor.generated.h"
+
+/**
+ * @class UCPP_CrowdMovementProcessor
+ * @brief Moves crowd enemies toward the arena center and gathers what UCPP_CrowdSubsystem needs afterwards.
+ *
+ * The processor is not registered with the processing phases; UCPP_CrowdSubsystem sets the inputs and runs it
+ * once per frame. Besides moving, it fills the instance transforms of the crowd mesh and collects the
+ * entities that came within the promotion radius of the player.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_CrowdMovementProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	// Inputs
+	FVector Target = FVector::ZeroVector;
+	float Speed = 300.0f;
+	float StopRadius = 500.0f;
+	FVector PlayerLocation = FVector::ZeroVector;
+	float PromotionRadius = 0.0f;
+
+	// Outputs, appended to on every run
+	TArray<FTransform> InstanceTransforms;
+	TArray<FMassEntityHandle> PromotionCandidates;
+
+private:
+	FMassEntityQuery EntityQuery;
+
+public:
+	UCPP_CrowdMovementProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_CrowdSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+class UCPP_CrowdMovementProcessor;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+struct FStreamableHandle;
+
+/**
+ * @class UCPP_CrowdSubsystem
+ * @brief Lightweight MassEntity crowd for enemies far from the player.
+ *
+ * A crowd enemy is an entity with a transform, a health and an enemy class fragment. It walks toward
+ * ArenaCenter and is drawn as one instance of CrowdMesh. When it comes within PromotionRadius of the player,
+ * it is replaced by a real ACPP_EnemyCharacterBase from the enemy pool, with the entity's health. A promoted
+ * enemy that is still alive and farther than DemotionRadius goes back to the pool and becomes an entity again.
+ *
+ * Nothing is loaded synchronously. The crowd keeps the load handles of its enemy classes and mesh for as long as
+ * any entity or promoted enemy is left, so a class stays resident until its last crowd enemy is gone.
+ * The mesh is set on the instances once its load completes.
+ *
+ * The rounds system adds FCPP_RoundsConfig::CrowdCount crowd enemies per wave.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_CrowdSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Distance to the player under which a crowd enemy becomes an actor. */
+	UPROPERTY(Config)
+	float PromotionRadius = 3000.0f;
+
+	/** Distance to the player over which a promoted enemy goes back to the crowd. Keep it above PromotionRadius. */
+	UPROPERTY(Config)
+	float DemotionRadius = 3500.0f;
+
+	/** Promotions per frame; the remaining candidates are promoted on the next frames. */
+	UPROPERTY(Config)
+	int32 MaxPromotionsPerFrame = 8;
+
+	/** Point the crowd walks toward. */
+	UPROPERTY(Config)
+	FVector ArenaCenter = FVector::ZeroVector;
+
+	/** The crowd stops walking this close to ArenaCenter. */
+	UPROPERTY(Config)
+	float ArenaCenterStopRadius = 500.0f;
+
+	UPROPERTY(Config)
+	float MoveSpeed = 300.0f;
+
+	/** Mesh drawn for every crowd enemy. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UStaticMesh> CrowdMesh;
+
+private:
+	struct FPromotedEnemy
+	{
+		TWeakObjectPtr<ACPP_EnemyCharacterBase> Enemy;
+		int32 EnemyClassIndex = INDEX_NONE;
+	};
+
+	/** Enemy classes referenced by FCPP_CrowdEnemyFragment::EnemyClassIndex. */
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> EnemyClasses;
+
+	/** Keep EnemyClasses and CrowdMesh resident while the crowd has enemies. */
+	TArray<TSharedPtr<FStreamableHandle>> LoadHandles;
+
+	/** Indices into EnemyClasses whose failed load was already reported. */
+	TSet<int32> ReportedMissingClasses;
+
+	TArray<FPromotedEnemy> PromotedEnemies;
+
+	FMassArchetypeHandle CrowdArchetype;
+
+	UPROPERTY(Transient)
+	UCPP_CrowdMovementProcessor* MovementProcessor = nullptr;
+
+	UPROPERTY(Transient)
+	AActor* CrowdActor = nullptr;
+
+	UPROPERTY(Transient)
+	UInstancedStaticMeshComponent* CrowdInstances = nullptr;
+
+	TArray<FMassEntityHandle> NewEntities;
+
+	int32 NumEntities = 0;
+
+public:
+	/**
+	 * Adds crowd enemies. Classes and transforms are matched by index.
+	 * Classes do not need to be loaded; an enemy whose class is not loaded yet waits in the crowd.
+	 *
+	 * @param LoadHandle The load of the classes and of GetAssetsToLoad, e.g. the wave's. Kept while the crowd
+	 *                   has enemies. Without one, the crowd requests what it needs itself.
+	 */
+	void SpawnCrowd(TConstArrayView<TSoftClassPtr<ACPP_EnemyCharacterBase>> Classes,
+	                TConstArrayView<FTransform> Transforms, TSharedPtr<FStreamableHandle> LoadHandle = nullptr);
+
+	/** Adds the assets the crowd needs besides its enemy classes, to be loaded with them. */
+	void GetAssetsToLoad(TArray<FSoftObjectPath>& OutAssetPaths) const;
+
+	/** Removes every crowd entity. Promoted enemies are left alone. */
+	void ClearCrowd();
+
+	/** Number of enemies currently represented by entities. */
+	int32 GetCrowdCount() const { return NumEntities; }
+
+	/** Number of crowd enemies currently promoted to actors. */
+	int32 GetPromotedCount() const { return PromotedEnemies.Num(); }
+
+	// USubsystem / FTickableGameObject
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	bool EnsureCrowdSetUp();
+
+	/** Sets CrowdMesh on the instances once it is loaded. */
+	void ApplyCrowdMesh();
+	bool GetPlayerLocation(FVector& OutLocation) const;
+
+	void PromoteCandidates(const TArray<FMassEntityHandle>& Candidates);
+	void DemoteFarEnemies(const FVector& PlayerLocation);
+	void UpdateInstances(const TArray<FTransform>& Transforms);
+};
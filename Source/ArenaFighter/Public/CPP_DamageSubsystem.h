@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_DamageSubsystem.generated.h"
+
+class ACharacter;
+class ACPP_CharacterBase;
+
+/**
+ * @class UCPP_DamageSubsystem
+ * @brief Batched per-frame damage resolution for every ACPP_CharacterBase.
+ *
+ * ICPP_AttackTarget::TakeAttack queues the hit here instead of applying it right away. Once per frame the
+ * queued hits are summed per target in a native loop, and each damaged target takes the total as a single
+ * UGameplayStatics::ApplyDamage: one OnTakeAnyDamage and Blueprint AnyDamage event, one OnHealthChanged and
+ * at most one death per frame, however many hits it took.
+ *
+ * Hits queued while the batch is being resolved, e.g. from OnDie handlers, are resolved the next frame.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_DamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, attacks are applied immediately through UGameplayStatics::ApplyDamage. */
+	UPROPERTY(Config)
+	bool bBatchDamage = true;
+
+private:
+	struct FPendingAttack
+	{
+		TWeakObjectPtr<ACPP_CharacterBase> Target;
+		TWeakObjectPtr<ACharacter> Attacker;
+		float Damage = 0.0f;
+	};
+
+	/** Damage summed for one target, in the order targets were first hit. */
+	struct FTargetDamage
+	{
+		ACPP_CharacterBase* Target = nullptr;
+		ACharacter* LastAttacker = nullptr;
+		float Damage = 0.0f;
+		int32 Hits = 0;
+	};
+
+	TArray<FPendingAttack> PendingAttacks;
+	TArray<FPendingAttack> ResolvingAttacks;
+	TArray<FTargetDamage> Targets;
+	TMap<ACPP_CharacterBase*, int32> TargetIndices;
+
+public:
+	/**
+	 * Queues a hit for the batched pass of this frame.
+	 *
+	 * @return False when batching is disabled and the caller should apply the damage immediately.
+	 */
+	bool QueueAttack(ACPP_CharacterBase* Target, ACharacter* Attacker, float Damage);
+
+	/** Drops the hits queued against Target, e.g. when it is returned to a pool before they resolve. */
+	void DiscardAttacks(const ACPP_CharacterBase* Target);
+
+	/** Sums the queued hits per target and applies them. */
+	void ResolvePendingAttacks();
+
+	int32 NumPendingAttacks() const { return PendingAttacks.Num(); }
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
@@ -6,6 +6,8 @@
 #include "CPP_CharacterBase.h"
 #include "CPP_EnemyCharacterBase.generated.h"
 
+struct FCPP_SignificanceBucket;
+
 /**
  * 
  */
@@ -20,4 +22,86 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI")
 	float SecondsToLostTarget = 5.0f;
+
+	/**
+	 * Runs the native enemy tree of UCPP_EnemyDecisionSubsystem instead of the tree the AI controller starts on
+	 * possession, so the enemy takes one of its target's attack tokens before it attacks.
+	 * Off by default; turn it on in the enemy Blueprints that should leave their Blueprint tree.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "AI")
+	bool bRunNativeBehaviorTree = false;
+
+	/**
+	 * ReturnToPoolDelay is the time in seconds between death and returning to the enemy pool.
+	 * It should cover the death sequence played by Blueprints in OnDie.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Pooling")
+	float ReturnToPoolDelay = 5.0f;
+
+private:
+	/** Set when the enemy was spawned by UCPP_EnemyPoolSubsystem and must go back to it after death. */
+	bool bIsPooled = false;
+
+	/** AI controller kept across pool cycles so the enemy can be re-possessed without spawning a new one. */
+	UPROPERTY()
+	TObjectPtr<AController> PooledController;
+
+	FTimerHandle ReturnToPoolTimerHandle;
+
+public:
+	/**
+	 * OnTakenFromPool is a Blueprint event called after a pooled enemy was reset and placed for a new wave.
+	 * Use it to undo visual death state such as ragdolls or dissolve materials.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Pooling")
+	void OnTakenFromPool();
+
+	/**
+	 * Asks UCPP_AttackTokenSubsystem for one of Target's attack tokens. Call it every time the enemy wants
+	 * to attack; an enemy without a token should circle the target instead.
+	 *
+	 * @return True when the enemy may attack Target.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "AI")
+	bool RequestAttackToken(AActor* Target);
+
+	/** Marks the enemy as owned by the enemy pool. */
+	void SetPooled(bool bInIsPooled) { bIsPooled = bInIsPooled; }
+
+	bool IsPooled() const { return bIsPooled; }
+
+	/**
+	 * Brings a pooled enemy back into play at the given transform: resets attributes and sensing,
+	 * re-registers with the world systems, re-equips the weapon and re-possesses the AI controller.
+	 */
+	void ActivateFromPool(const FTransform& SpawnTransform);
+
+	/**
+	 * Takes the enemy out of play: hides it, disables collision, movement and ticking, releases its weapon
+	 * and unpossesses its AI controller while keeping it for the next activation.
+	 */
+	void DeactivateToPool();
+
+	/**
+	 * Applies the update rates of a significance bucket: actor and movement tick interval, perception
+	 * interval, and skeletal mesh update rate optimizations.
+	 */
+	void ApplySignificanceBucket(const FCPP_SignificanceBucket& Bucket);
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void PossessedBy(AController* NewController) override;
+
+protected:
+	virtual void Die() override;
+
+	virtual void RegisterWithWorldSubsystems() override;
+	virtual void UnregisterFromWorldSubsystems() override;
+
+private:
+	void ReturnToPool();
+
+	/** Replaces the controller's tree once its Blueprint has reacted to the possession. */
+	UFUNCTION()
+	void HandlePossessedPawnChanged(APawn* OldPawn, APawn* NewPawn);
 };
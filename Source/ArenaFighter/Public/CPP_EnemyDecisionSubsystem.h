@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "BehaviorTree/BehaviorTreeTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_EnemyDecisionSubsystem.generated.h"
+
+class AAIController;
+class ACPP_EnemyCharacterBase;
+class UAnimMontage;
+class UBehaviorTree;
+class UBehaviorTreeComponent;
+
+/**
+ * @class UCPP_EnemyDecisionSubsystem
+ * @brief Updates the chase and lost-target decisions of every enemy behavior tree from one queue.
+ *
+ * Trees register through UCPP_BTService_EnemyDecisions. Each frame the subsystem walks the queue round-robin
+ * from where it stopped last time and updates at most DecisionsPerFrame enemies that are due:
+ * - the enemy's SelectedPawn becomes the attack target and refreshes the time it was last seen;
+ * - without a selected pawn, the previous target is kept until SecondsToLostTarget have passed since then;
+ * - dead enemies and dead targets clear the target.
+ * The target and whether to chase it are written to the blackboard keys given at registration.
+ *
+ * GetNativeTree() builds an enemy tree from the native nodes only. Enemies whose Blueprint turns on
+ * bRunNativeBehaviorTree run it in place of BT_Enemy_Base.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_EnemyDecisionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Config)
+	int32 DecisionsPerFrame = 32;
+
+	/** Seconds between two decisions of the same enemy. */
+	UPROPERTY(Config)
+	float DecisionInterval = 0.2f;
+
+	/** Montage played by the attack task of the native tree. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UAnimMontage> NativeTreeAttackMontage{
+		FSoftObjectPath(TEXT("/Game/Mixamo/StandingMeleeAttackDownward_UE_Montage.StandingMeleeAttackDownward_UE_Montage"))
+	};
+
+	/** Blueprint enemy tree the native tree replaces, the baseline of ArenaFighter.AI.Benchmark. */
+	UPROPERTY(Config)
+	TSoftObjectPtr<UBehaviorTree> BaselineTree{ FSoftObjectPath(TEXT("/Game/Blueprints/Enemies/AI/BT_Enemy_Base.BT_Enemy_Base")) };
+
+private:
+	struct FEntry
+	{
+		TWeakObjectPtr<UBehaviorTreeComponent> Tree;
+		TWeakObjectPtr<ACPP_EnemyCharacterBase> Enemy;
+		FBlackboard::FKey TargetKey = FBlackboard::InvalidKey;
+		FBlackboard::FKey ShouldChaseKey = FBlackboard::InvalidKey;
+
+		TWeakObjectPtr<AActor> Target;
+		double LastSeenTime = 0.0;
+		double NextDecisionTime = 0.0;
+	};
+
+	TArray<FEntry> Entries;
+
+	/** Index of the entry the next frame starts from. */
+	int32 Cursor = 0;
+
+	int32 DecisionsLastFrame = 0;
+
+	UPROPERTY(Transient)
+	TObjectPtr<UBehaviorTree> NativeTree;
+
+public:
+	/**
+	 * Adds the tree to the queue with a random phase. The first decision is made right away so the blackboard
+	 * is filled before the tree's first tasks run.
+	 *
+	 * @param TargetKey Object key receiving the attack target, or FBlackboard::InvalidKey.
+	 * @param ShouldChaseKey Bool key receiving whether to chase, or FBlackboard::InvalidKey.
+	 */
+	void Register(UBehaviorTreeComponent& Tree, FBlackboard::FKey TargetKey, FBlackboard::FKey ShouldChaseKey);
+
+	void Unregister(const UBehaviorTreeComponent& Tree);
+
+	int32 GetNumRegistered() const { return Entries.Num(); }
+
+	int32 GetDecisionsLastFrame() const { return DecisionsLastFrame; }
+
+	/**
+	 * Returns the enemy tree made of the native nodes, built on first use:
+	 * a selector running the decision service, which chases, prepares and attacks while there is a target,
+	 * and otherwise clears the focus and waits.
+	 */
+	UBehaviorTree* GetNativeTree();
+
+	/**
+	 * Runs Tree on every controller, then ticks their brain components for a number of frames. Only the brain
+	 * ticks are timed; the decision queue ticks between them and is timed apart, since every tree with the
+	 * decision service shares it.
+	 *
+	 * @param OutDecisionMicroseconds Receives the decision queue's time per frame.
+	 * @return The brain components' time per frame, in microseconds.
+	 */
+	double TimeTreeTicks(TConstArrayView<AAIController*> Controllers, UBehaviorTree* Tree, int32 Frames, float DeltaTime,
+	                     double& OutDecisionMicroseconds);
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void Decide(FEntry& Entry, double Now) const;
+};
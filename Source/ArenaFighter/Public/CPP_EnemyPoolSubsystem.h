@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_EnemyPoolSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+
+/** Inactive enemies of a single class. */
+USTRUCT()
+struct FCPP_EnemyPoolBucket
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TArray<TObjectPtr<ACPP_EnemyCharacterBase>> FreeEnemies;
+};
+
+/**
+ * @class UCPP_EnemyPoolSubsystem
+ * @brief Per-world pool of enemies keyed by class, recycled across rounds.
+ *
+ * Enemies spawned through SpawnEnemy return to the pool on their own once their death sequence is over
+ * (see ACPP_EnemyCharacterBase::ReturnToPoolDelay). The next wave then reuses them instead of paying
+ * actor construction, component registration, sensing binding, weapon spawning and controller spawning again.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_EnemyPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+	UPROPERTY()
+	TMap<TSubclassOf<ACPP_EnemyCharacterBase>, FCPP_EnemyPoolBucket> Buckets;
+
+	int32 Hits = 0;
+	int32 Misses = 0;
+
+public:
+	/**
+	 * Returns a live enemy of the given class at SpawnTransform, reusing a pooled one when available.
+	 *
+	 * @param EnemyClass Class of the enemy to spawn.
+	 * @param SpawnTransform Where the enemy is placed.
+	 * @return The activated enemy, or nullptr when spawning failed or a combat replay owns the spawns.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	ACPP_EnemyCharacterBase* SpawnEnemy(TSubclassOf<ACPP_EnemyCharacterBase> EnemyClass, const FTransform& SpawnTransform);
+
+	/** Deactivates the enemy and keeps it for a later SpawnEnemy of the same class. */
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	void ReleaseEnemy(ACPP_EnemyCharacterBase* Enemy);
+
+	/** Number of SpawnEnemy calls served from the pool. */
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	int32 GetHits() const { return Hits; }
+
+	/** Number of SpawnEnemy calls that had to spawn a new actor. */
+	UFUNCTION(BlueprintCallable, Category = "Pooling")
+	int32 GetMisses() const { return Misses; }
+
+	int32 GetNumFree(TSubclassOf<ACPP_EnemyCharacterBase> EnemyClass) const;
+
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_EnemySignificanceSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+
+DECLARE_STATS_GROUP(TEXT("ArenaFighter Significance"), STATGROUP_ArenaFighterSignificance, STATCAT_Advanced);
+
+/**
+ * Update rates applied to enemies whose distance to the player falls into the bucket.
+ * Buckets are ordered from the closest to the farthest.
+ */
+USTRUCT()
+struct FCPP_SignificanceBucket
+{
+	GENERATED_BODY()
+
+public:
+	/** Enemies at most this far away (after the out-of-view scale) belong to the bucket. */
+	UPROPERTY(Config)
+	float MaxDistance = 0.0f;
+
+	/** Actor and movement component tick interval in seconds, 0 ticks every frame. */
+	UPROPERTY(Config)
+	float TickInterval = 0.0f;
+
+	/** Multiplier of the perception update interval. */
+	UPROPERTY(Config)
+	float SensingIntervalScale = 1.0f;
+
+	/** Number of animation frames skipped between updates through update rate optimizations, 0 for every frame. */
+	UPROPERTY(Config)
+	int32 AnimationFrameSkip = 0;
+};
+
+/**
+ * @class UCPP_EnemySignificanceSubsystem
+ * @brief Scales the update rates of enemies by their significance to the player.
+ *
+ * Enemies are registered with the engine's USignificanceManager. Every frame the subsystem feeds the local
+ * players' viewpoints to the manager, which scores each enemy by distance, with enemies outside the view cone
+ * treated as farther away. The score selects a bucket from Buckets, whose tick, perception and
+ * animation rates are then applied to the enemy. Enemies within FullFidelityDistance always stay in the first bucket.
+ *
+ * Bucket populations are shown by 'stat ArenaFighterSignificance'.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_EnemySignificanceSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UCPP_EnemySignificanceSubsystem();
+
+	/** Buckets ordered from the closest to the farthest. Enemies beyond the last MaxDistance use the last bucket. */
+	UPROPERTY(Config)
+	TArray<FCPP_SignificanceBucket> Buckets;
+
+	/** Enemies closer than this always use the first bucket, whether in view or not. */
+	UPROPERTY(Config)
+	float FullFidelityDistance = 1500.0f;
+
+	/** Distance multiplier for enemies outside the view cone. */
+	UPROPERTY(Config)
+	float OutOfViewDistanceScale = 2.0f;
+
+	/** Half angle of the view cone in degrees. */
+	UPROPERTY(Config)
+	float ViewHalfAngle = 60.0f;
+
+	static const FName SignificanceTag;
+
+private:
+	/** Current bucket of every registered enemy. */
+	TMap<TWeakObjectPtr<ACPP_EnemyCharacterBase>, int32> EnemyBuckets;
+
+public:
+	void Register(ACPP_EnemyCharacterBase* Enemy);
+	void Unregister(ACPP_EnemyCharacterBase* Enemy);
+
+	UFUNCTION(BlueprintCallable, Category = "Significance")
+	int32 GetNumEnemiesInBucket(int32 BucketIndex) const;
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Higher is more significant: Buckets.Num() for the first bucket down to 1 for the last. */
+	float CalculateSignificance(const AActor* Enemy, const FTransform& Viewpoint) const;
+	int32 GetBucketIndex(float Significance) const;
+	void ApplyBucket(ACPP_EnemyCharacterBase* Enemy, int32 BucketIndex);
+};
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_FlowFieldSubsystem.generated.h"
+
+class ANavigationData;
+
+/**
+ * @class UCPP_FlowFieldSubsystem
+ * @brief Shared flow-field navigation toward attack targets.
+ *
+ * The subsystem rasterizes the navigable bounds of the arena into a grid of CellSize cells, keeping the cells
+ * whose center projects onto the navmesh. For each target that chasing enemies sample, it keeps a field with
+ * the distance of every cell to the target's cell, computed with a breadth-first wave over the walkable cells.
+ *
+ * When the target enters another cell the field is rebuilt in the background, at most CellsPerFrame cells per
+ * frame, while samples keep using the previous field. A rebuild in progress is finished before the next one
+ * starts toward the target's latest cell, so a target that keeps moving still gets fresh fields. A sample only
+ * compares the distances of the eight neighbouring cells, so the cost of chasing does not depend on the path
+ * length or the number of chasers.
+ *
+ * The grid is rasterized again when the navmesh finishes generating. If only walkable cells changed, the fields
+ * are rebuilt in the background like a target move; if the grid size changed, they are dropped.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_FlowFieldSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Edge length of a grid cell in world units. Raised automatically if the grid would exceed MaxCells. */
+	UPROPERTY(Config)
+	float CellSize = 100.0f;
+
+	UPROPERTY(Config)
+	int32 MaxCells = 256 * 256;
+
+	/** Vertical distance searched when projecting a cell center onto the navmesh. */
+	UPROPERTY(Config)
+	float ProjectionHeight = 250.0f;
+
+	/** Cells expanded per frame across all field rebuilds. */
+	UPROPERTY(Config)
+	int32 CellsPerFrame = 20000;
+
+	/** Seconds a field is kept after its last sample. */
+	UPROPERTY(Config)
+	float FieldLifetime = 5.0f;
+
+	/** Seconds between attempts to build the grid while the navmesh has no walkable cell yet. */
+	UPROPERTY(Config)
+	float GridRetryInterval = 1.0f;
+
+private:
+	static constexpr uint16 Unreachable = MAX_uint16;
+
+	struct FField
+	{
+		TWeakObjectPtr<const AActor> Target;
+
+		/** Distances in cells to TargetCell; empty until the first build completes. */
+		TArray<uint16> Distances;
+		int32 TargetCell = INDEX_NONE;
+
+		/** Rebuild in progress toward PendingTargetCell. */
+		TArray<uint16> PendingDistances;
+		TArray<int32> Frontier;
+		int32 FrontierHead = 0;
+		int32 PendingTargetCell = INDEX_NONE;
+
+		double LastSampleTime = 0.0;
+
+		bool IsBuilding() const { return PendingTargetCell != INDEX_NONE; }
+	};
+
+	bool bGridBuilt = false;
+	double NextGridBuildTime = 0.0;
+	FVector2D GridOrigin = FVector2D::ZeroVector;
+	float GridCellSize = 0.0f;
+	int32 GridWidth = 0;
+	int32 GridHeight = 0;
+	TBitArray<> Walkable;
+
+	TArray<FField> Fields;
+
+public:
+	/**
+	 * Returns the direction to move from Location to get closer to Target along the navmesh.
+	 * Starts a field for Target on its first sample.
+	 *
+	 * @return False while the field is not built yet, outside the grid, or in the target's own cell;
+	 *         the caller should then move straight toward the target.
+	 */
+	bool SampleDirection(const AActor* Target, const FVector& Location, FVector& OutDirection);
+
+	/**
+	 * Builds the grid now instead of on the first sample, e.g. at the start of the match.
+	 * Fails while no cell projects onto the navmesh, and is then retried every GridRetryInterval.
+	 */
+	bool BuildGrid();
+
+	/** Builds the whole field toward Target in one go, e.g. for benchmarks. Returns the number of cells expanded. */
+	int32 BuildFieldNow(const AActor* Target);
+
+	/** True once a field toward Target has been built and can be sampled. */
+	bool HasField(const AActor* Target) const;
+
+	/** Distance in cells from Location to Target in the current field, or INDEX_NONE if there is none or it is unreachable. */
+	int32 GetDistance(const AActor* Target, const FVector& Location) const;
+
+	/**
+	 * Uses the given walkable cells as the grid instead of projecting the navmesh, e.g. for tests. Walkable holds
+	 * Width * Height cells, row by row from Origin. Fields are rebuilt or dropped like after a navmesh change.
+	 */
+	void SetGrid(const FVector2D& Origin, float InCellSize, int32 Width, int32 Height, TBitArray<> InWalkable);
+
+	int32 NumFields() const { return Fields.Num(); }
+
+	// USubsystem / FTickableGameObject
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	UFUNCTION()
+	void HandleNavigationGenerationFinished(ANavigationData* NavData);
+
+	/** Projects every cell onto the navmesh. Returns false, keeping the current grid, if no cell is walkable. */
+	bool RasterizeGrid();
+
+	FField& FindOrAddField(const AActor* Target);
+
+	int32 GetCell(const FVector& Location) const;
+	FVector GetCellCenter(int32 Cell) const;
+
+	/** Diagonal moves are only allowed when both adjacent orthogonal cells are walkable. */
+	bool CanStep(int32 X, int32 Y, int32 DeltaX, int32 DeltaY) const;
+
+	void StartBuild(FField& Field, int32 TargetCell);
+
+	/** Expands up to Budget cells of the field's wave, returns the number expanded. */
+	int32 ExpandBuild(FField& Field, int32 Budget);
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "CPP_LineOfSightSubsystem.generated.h"
+
+/** Answer of a line-of-sight query. */
+UENUM(BlueprintType)
+enum class ECPP_LineOfSight : uint8
+{
+	Visible,
+	Hidden,
+	/** No fresh cached answer yet; a trace was queued and the result arrives on a later frame. */
+	Pending
+};
+
+/**
+ * @class UCPP_LineOfSightSubsystem
+ * @brief Asynchronous, batched and cached line-of-sight traces for perception.
+ *
+ * Queries are answered from a short-lived cache keyed by (observer, target). A cached answer stays
+ * valid while it is younger than CacheLifetime and neither side moved further than MoveTolerance.
+ * On a miss the pair is queued, all queued pairs are submitted together with AsyncLineTraceByChannel
+ * at the end of the frame, and the results are consumed on the next frame. Observers that are
+ * characters are then told about pawns they lost sight of.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_LineOfSightSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, callers should fall back to synchronous traces. */
+	UPROPERTY(Config)
+	bool bAsyncTraces = true;
+
+	/** Seconds a cached answer is trusted. */
+	UPROPERTY(Config)
+	float CacheLifetime = 0.5f;
+
+	/** Distance either side may move before a cached answer is traced again. */
+	UPROPERTY(Config)
+	float MoveTolerance = 50.0f;
+
+	UPROPERTY(Config)
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+private:
+	struct FCacheEntry
+	{
+		FVector ObserverLocation;
+		FVector TargetLocation;
+		double Time = 0.0;
+		bool bVisible = false;
+	};
+
+	struct FPendingTrace
+	{
+		TWeakObjectPtr<APawn> Observer;
+		TWeakObjectPtr<APawn> Target;
+		FVector Start;
+		FVector End;
+		FTraceHandle Handle;
+		uint64 Key = 0;
+	};
+
+	TMap<uint64, FCacheEntry> Cache;
+
+	/** Pairs queued this frame, submitted together in Tick. */
+	TArray<FPendingTrace> QueuedTraces;
+
+	/** Traces submitted on an earlier frame whose results have not been consumed yet. */
+	TArray<FPendingTrace> InFlightTraces;
+
+	TSet<uint64> PendingKeys;
+
+	double LastPruneTime = 0.0;
+
+public:
+	/**
+	 * Returns the cached visibility of Target from Observer, or queues an asynchronous trace and returns Pending.
+	 */
+	ECPP_LineOfSight QueryLineOfSight(APawn* Observer, APawn* Target);
+
+	/** Stores a visible answer obtained elsewhere, e.g. from a synchronous trace. */
+	void MarkVisible(APawn* Observer, APawn* Target);
+
+	/** Drops the queued and in-flight traces that involve Pawn, e.g. when it is parked in the enemy pool. */
+	void CancelQueries(const APawn* Pawn);
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	static uint64 MakeKey(const APawn* Observer, const APawn* Target);
+	static FVector GetEyesLocation(const APawn* Pawn);
+
+	void ConsumeResults();
+	void SubmitQueuedTraces();
+	void PruneCache(double Now);
+};
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+#include "CPP_MeleeHitSubsystem.generated.h"
+
+class ACharacter;
+class ACPP_Weapon;
+
+/**
+ * @class UCPP_MeleeHitSubsystem
+ * @brief Native melee hit detection with batched asynchronous sweeps.
+ *
+ * A swing sweeps a sphere from the attacker along several directions spread over the weapon's range arc,
+ * reaching ACPP_Weapon::GetAttackReach. All swings started during a frame are submitted together with
+ * AsyncSweepByChannel at the end of the frame. The results are consumed on the next frame, and every
+ * ICPP_AttackTarget hit by a swing receives TakeAttack once, however many of its sweeps touched it.
+ * Targets are collected as overlaps, so one target does not hide the next, and a sweep stops at the first
+ * WorldStatic object that blocks it, so swings do not reach through walls.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_MeleeHitSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, swings are swept synchronously and hits are delivered immediately. */
+	UPROPERTY(Config)
+	bool bAsyncSweeps = true;
+
+	/** Half of the horizontal angle covered by a swing, in degrees. */
+	UPROPERTY(Config)
+	float ArcHalfAngle = 45.0f;
+
+	/** Number of sweeps spread evenly across the arc. A single sweep goes straight ahead. */
+	UPROPERTY(Config)
+	int32 ArcSweeps = 3;
+
+	/** Radius of the swept sphere. */
+	UPROPERTY(Config)
+	float SweepRadius = 30.0f;
+
+	UPROPERTY(Config)
+	TEnumAsByte<ECollisionChannel> SweepChannel = ECC_Pawn;
+
+	/** When false, enemies' swings ignore other enemies. */
+	UPROPERTY(Config)
+	bool bFriendlyFire = false;
+
+private:
+	struct FSwing
+	{
+		TWeakObjectPtr<ACharacter> Attacker;
+		float Damage = 0.0f;
+		float Reach = 0.0f;
+		FVector Origin = FVector::ZeroVector;
+		FVector Forward = FVector::ForwardVector;
+		TArray<FTraceHandle, TInlineAllocator<5>> Handles;
+	};
+
+	/** Swings started this frame, submitted together in Tick. */
+	TArray<FSwing> QueuedSwings;
+
+	/** Swings submitted on an earlier frame whose results have not been consumed yet. */
+	TArray<FSwing> InFlightSwings;
+
+	/** Hits of the swing being resolved, so a target touched by several sweeps is attacked once. */
+	TSet<AActor*> SwingHits;
+
+	TArray<FTraceDatum> SweepResults;
+
+public:
+	/**
+	 * Starts a swing of Weapon by Attacker. Uses the attacker's current location and facing.
+	 */
+	void QueueSwing(ACharacter* Attacker, const ACPP_Weapon* Weapon);
+
+	/** Starts a swing with explicit reach and damage, for attacks that do not come from a weapon. */
+	void QueueSwing(ACharacter* Attacker, float Reach, float Damage);
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	FVector GetSweepDirection(const FSwing& Swing, int32 SweepIndex) const;
+	FCollisionQueryParams MakeQueryParams(const ACharacter* Attacker) const;
+	static FCollisionResponseParams MakeResponseParams();
+
+	void SweepNow(FSwing& Swing);
+	void ConsumeResults();
+	void SubmitQueuedSwings();
+
+	/** Sends TakeAttack to Actor unless the swing already hit it or it is not a valid target. */
+	void DeliverHit(const FSwing& Swing, ACharacter* Attacker, AActor* Actor);
+};
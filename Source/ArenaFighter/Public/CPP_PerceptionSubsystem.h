@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_PerceptionSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+class UCPP_LineOfSightSubsystem;
+class UCPP_TargetIndexSubsystem;
+
+/**
+ * @class UCPP_PerceptionSubsystem
+ * @brief Sight of every character, updated in one batched pass per frame.
+ *
+ * Replaces a UPawnSensingComponent per character. Each frame the subsystem walks its observers round-robin
+ * from where it stopped last time and updates the ones whose SensingInterval elapsed, until BudgetMicroseconds
+ * is spent. The observers still due when the budget runs out are counted as deferred. An update takes the candidates within the sight radius from UCPP_TargetIndexSubsystem, tests them
+ * against the view cone of the observer, then, only for the candidates inside the cone, queries line of sight
+ * through UCPP_LineOfSightSubsystem. The pawns seen are compared with the observer's DetectedPawns and the
+ * differences are handed over as lists of added and removed pawns.
+ *
+ * Sight radius, cone angle and interval are read from each observer, see ACPP_CharacterBase::SightRadius.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_PerceptionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Collision channel of the synchronous traces used when UCPP_LineOfSightSubsystem::bAsyncTraces is off. */
+	UPROPERTY(Config)
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	/** Time budget per frame for observer updates, in microseconds. At least one observer is updated per frame. */
+	UPROPERTY(Config)
+	float BudgetMicroseconds = 200.0f;
+
+private:
+	/** Smallest SetIntervalScale, so an observer cannot be due every frame and take the whole budget. */
+	static constexpr float MinIntervalScale = 0.1f;
+
+	struct FObserver
+	{
+		TWeakObjectPtr<ACPP_CharacterBase> Character;
+		double NextUpdateTime = 0.0;
+		float IntervalScale = 1.0f;
+	};
+
+	TArray<FObserver> Observers;
+
+	/** Index of the observer the next frame starts from. */
+	int32 Cursor = 0;
+
+	/** Scratch buffers of UpdateObserver, kept to reuse their allocations. */
+	TArray<ACPP_CharacterBase*> Candidates;
+	TSet<APawn*> SeenPawns;
+	TArray<APawn*> AddedPawns;
+	TArray<APawn*> RemovedPawns;
+
+	bool bIsUpdating = false;
+	int32 UpdatesLastFrame = 0;
+	int32 DeferredLastFrame = 0;
+
+public:
+	/** Adds the character as observer and candidate, with a random phase so characters spawned together are not updated together. */
+	void Register(ACPP_CharacterBase* Character);
+
+	void Unregister(ACPP_CharacterBase* Character);
+
+	bool IsRegistered(const ACPP_CharacterBase* Character) const;
+
+	/**
+	 * Scales the SensingInterval of a single character, e.g. to update distant enemies less often.
+	 *
+	 * @param Character A registered character.
+	 * @param IntervalScale Multiplier applied to SensingInterval, at least MinIntervalScale; 1 restores the default rate.
+	 */
+	void SetIntervalScale(ACPP_CharacterBase* Character, float IntervalScale);
+
+	/** Number of observers updated in the last frame. */
+	UFUNCTION(BlueprintCallable, Category = "Sensing")
+	int32 GetUpdatesLastFrame() const { return UpdatesLastFrame; }
+
+	/** Number of observers that were due in the last frame but left for the next ones because the budget ran out. */
+	UFUNCTION(BlueprintCallable, Category = "Sensing")
+	int32 GetDeferredLastFrame() const { return DeferredLastFrame; }
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Tests the observer against the candidates in its sight radius and applies the differences to its DetectedPawns. */
+	void UpdateObserver(ACPP_CharacterBase& Observer, const UCPP_TargetIndexSubsystem& TargetIndex,
+	                    UCPP_LineOfSightSubsystem* LineOfSight);
+};
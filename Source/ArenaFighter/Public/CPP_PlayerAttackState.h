@@ -21,6 +21,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Attack State")
 	USkeletalMeshComponent* SkeletalMesh;
 
+	/** Trigger fired on the owning state machine when AnimMontage ends. Nothing is fired when None. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Player Attack State")
+	FName MontageEndedTrigger;
+
 private:
 	UPROPERTY()
 	UAnimInstance* AnimInstance;
@@ -30,6 +34,7 @@ private:
 public:
 	virtual void Init(UObject* Context) override;
 	virtual void OnEnter() override;
+	virtual void EnterShared(FCPP_StateContext& Context) const override;
 
 private:
 	UFUNCTION()
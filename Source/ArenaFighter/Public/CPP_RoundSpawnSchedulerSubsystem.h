@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_RoundSpawnSchedulerSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+class U_CPP_RoundsConfigurations;
+struct FStreamableHandle;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnWaveSpawned, int32, Round);
+
+/**
+ * @class UCPP_RoundSpawnSchedulerSubsystem
+ * @brief Spreads the spawning of a round's enemies across frames under a per-frame time budget.
+ *
+ * Spawning a whole round in one burst made the wave start the worst frame of the game, since every
+ * enemy runs BeginPlay, equips a weapon and registers with the world systems. QueueWave resolves the
+ * round configuration and starts loading its enemy classes; once they are in, the scheduler spawns through
+ * the enemy pool until BudgetMilliseconds is spent each frame. Classes that fail to load are logged and
+ * their spawns skipped, so a bad entry never stalls the wave.
+ *
+ * The spawn points are scored against the player's view at the start of every frame's batch. Each point is
+ * used once per batch, least visible first, and the rest of the batch only goes to points that are hidden.
+ * OnWaveSpawned fires once every enemy of the wave is live.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_RoundSpawnSchedulerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Time budget per frame for spawning, in milliseconds. At least one enemy is spawned per frame. */
+	UPROPERTY(Config)
+	float BudgetMilliseconds = 2.0f;
+
+	/** Crowd enemies of a wave are placed at random within this distance of the spawn points. */
+	UPROPERTY(Config)
+	float CrowdSpreadRadius = 1000.0f;
+
+	/**
+	 * Spawn points whose view score, the cosine between the view direction and the direction to the point,
+	 * is below this count as hidden from the player.
+	 */
+	UPROPERTY(Config)
+	float HiddenViewScore = 0.5f;
+
+	/** Raised when the last enemy of a queued wave has been spawned. */
+	UPROPERTY(BlueprintAssignable, Category = "Rounds")
+	FOnWaveSpawned OnWaveSpawned;
+
+private:
+	struct FPendingWave
+	{
+		int32 Round = 0;
+		TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> Spawns;
+		int32 NextSpawn = 0;
+		TArray<TWeakObjectPtr<AActor>> SpawnPoints;
+
+		/** Keeps the enemy classes resident until the wave is spawned. */
+		TSharedPtr<FStreamableHandle> LoadHandle;
+		bool bClassesResolved = false;
+	};
+
+	TArray<FPendingWave> Waves;
+
+	int32 SpawnedLastFrame = 0;
+
+public:
+	/**
+	 * Queues the spawns of a round. Enemy classes are picked from the round configuration with a stream seeded
+	 * by the round and start loading right away. Points outside the player's view are spawned first.
+	 *
+	 * @param Configurations The rounds configuration asset.
+	 * @param Round The round to spawn; selects the configuration through LevelsSpan.
+	 * @param SpawnPoints Actors whose transforms are used as spawn locations.
+	 * @param EnemyCount Number of enemies in the wave.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	void QueueWave(U_CPP_RoundsConfigurations* Configurations, int32 Round, const TArray<AActor*>& SpawnPoints,
+	               int32 EnemyCount);
+
+	/** True while any queued wave still has enemies to spawn. */
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	bool IsSpawning() const { return !Waves.IsEmpty(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	int32 GetSpawnedLastFrame() const { return SpawnedLastFrame; }
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/**
+	 * Sorts spawn points from the least to the most visible to the local player.
+	 *
+	 * @return The number of leading points that are hidden, see HiddenViewScore.
+	 */
+	int32 SortByVisibility(TArray<AActor*>& SpawnPoints) const;
+
+	/** Drops the spawns whose class failed to load, logging each such class once. */
+	void ResolveWaveClasses(FPendingWave& Wave) const;
+};
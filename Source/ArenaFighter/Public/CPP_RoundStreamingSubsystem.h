@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_RoundStreamingSubsystem.generated.h"
+
+class ACPP_EnemyCharacterBase;
+class U_CPP_RoundsConfigurations;
+struct FStreamableHandle;
+
+/**
+ * @class UCPP_RoundStreamingSubsystem
+ * @brief Look-ahead asynchronous loading of the enemy classes used by upcoming rounds.
+ *
+ * When a round begins, the enemy classes of the next round are requested through the asset manager's
+ * FStreamableManager, so they are resident by the time that round starts. Enemy classes only hold soft
+ * references to their weapons, so once the enemies are in, their weapons are requested in a second pass.
+ * Handles of rounds that are over are released, letting assets that no upcoming round needs be unloaded.
+ *
+ * Nothing here loads synchronously: callers check IsRoundLoaded before spawning and wait a frame otherwise.
+ */
+UCLASS()
+class ARENAFIGHTER_API UCPP_RoundStreamingSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+private:
+	UPROPERTY()
+	TObjectPtr<U_CPP_RoundsConfigurations> Configurations;
+
+	/** Streaming handles of the rounds currently kept resident, keyed by round: the enemies, then their weapons. */
+	TMap<int32, TArray<TSharedPtr<FStreamableHandle>>> RoundHandles;
+
+	int32 CurrentRound = INDEX_NONE;
+
+public:
+	/**
+	 * Notifies the subsystem that a round started. Requests the current and the next round,
+	 * and releases every older round.
+	 *
+	 * @param InConfigurations The rounds configuration asset the round comes from.
+	 * @param Round The round that just started.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	void BeginRound(U_CPP_RoundsConfigurations* InConfigurations, int32 Round);
+
+	/** Starts streaming the enemy classes of a round unless already requested. */
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	void RequestRound(int32 Round);
+
+	/** True when every enemy class of the round and their weapons are resident and can be spawned without a synchronous load. */
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	bool IsRoundLoaded(int32 Round) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	int32 GetCurrentRound() const { return CurrentRound; }
+
+	U_CPP_RoundsConfigurations* GetConfigurations() const { return Configurations; }
+
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Requests the weapon classes of the round's enemies, which must be loaded. */
+	void RequestRoundWeapons(int32 Round);
+
+	void ReleaseRoundsBefore(int32 Round);
+};
@@ -18,8 +18,51 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FIntPoint LevelsSpan = FIntPoint(1, 2);
 
+	/**
+	 * Enemy classes of this round, as hard references kept for BP_RoundSystem's graph. They are copied into
+	 * SoftEnemies when the configuration loads, but stay resident for as long as the configuration does.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<TSubclassOf<ACPP_EnemyCharacterBase>> Enemies;
+
+	/**
+	 * Enemy classes of this round, as soft references. They are not loaded together with the configuration asset;
+	 * UCPP_RoundStreamingSubsystem streams them and their weapons in while the previous round is playing.
+	 * Filled from Enemies on PostLoad; classes moved from Enemies to here no longer load with the configuration.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>> SoftEnemies;
+
+	/**
+	 * Enemies added to every wave of this round as a UCPP_CrowdSubsystem crowd, on top of the spawned actors.
+	 * Crowd enemies are cheap entities until they come close to the player, so this can be in the thousands.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	int32 CrowdCount = 0;
+
+	/** Enemies allowed to attack the same target at once, see UCPP_AttackTokenSubsystem. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+	int32 AttackSlots = 3;
+
+	/** Seconds between two movement updates of an enemy circling a target while it waits for an attack token. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float CirclingUpdateInterval = 0.5f;
+
+	/** Adds the classes in Enemies to SoftEnemies. Called from the PostLoad of the assets holding configurations. */
+	void SyncSoftEnemies()
+	{
+		for (const TSubclassOf<ACPP_EnemyCharacterBase>& Enemy : Enemies)
+			if (Enemy)
+				SoftEnemies.AddUnique(TSoftClassPtr<ACPP_EnemyCharacterBase>(Enemy.Get()));
+	}
+
+	/** Collects the distinct enemy classes set in SoftEnemies. */
+	void GetEnemyClasses(TArray<TSoftClassPtr<ACPP_EnemyCharacterBase>>& OutEnemyClasses) const
+	{
+		for (const TSoftClassPtr<ACPP_EnemyCharacterBase>& Enemy : SoftEnemies)
+			if (!Enemy.IsNull())
+				OutEnemyClasses.AddUnique(Enemy);
+	}
 };
 
 UCLASS(BlueprintType)
@@ -30,4 +73,11 @@ class ARENAFIGHTER_API U_CPP_RoundsConfig : public UDataAsset
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FCPP_RoundsConfig Data;
+
+	virtual void PostLoad() override
+	{
+		Super::PostLoad();
+
+		Data.SyncSoftEnemies();
+	}
 };
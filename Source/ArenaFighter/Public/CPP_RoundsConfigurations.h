@@ -27,4 +27,17 @@ class ARENAFIGHTER_API U_CPP_RoundsConfigurations : public UDataAsset
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FCPP_RoundsConfigurations Data;
+
+	virtual void PostLoad() override;
+
+	/**
+	 * Finds the configuration whose LevelsSpan contains the given round.
+	 *
+	 * @param Round The round number, in the same units as LevelsSpan.
+	 * @return The first matching configuration, or nullptr when no span covers the round.
+	 */
+	const FCPP_RoundsConfig* FindRoundConfig(int32 Round) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Rounds")
+	bool GetRoundConfig(int32 Round, FCPP_RoundsConfig& OutConfig) const;
 };
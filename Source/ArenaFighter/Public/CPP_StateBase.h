@@ -6,6 +6,37 @@
 #include "UObject/NoExportTypes.h"
 #include "CPP_StateBase.generated.h"
 
+class UAnimInstance;
+class UCPP_StateMachineBase;
+
+/**
+ * @brief Per-owner mutable data of a state machine whose states are shared.
+ *
+ * Shared states are immutable and used by every machine of a definition at once, so everything that
+ * differs between owners lives here instead, in the machine.
+ */
+USTRUCT(BlueprintType)
+struct FCPP_StateContext
+{
+	GENERATED_BODY()
+
+public:
+	/** The object that owns the state machine, as passed to UCPP_StateMachineBase::Init. */
+	UPROPERTY(BlueprintReadOnly, Category = "State")
+	UObject* OwnerContext = nullptr;
+
+	UPROPERTY(BlueprintReadOnly, Category = "State")
+	UCPP_StateMachineBase* Machine = nullptr;
+
+	/** Anim instance of the owner's mesh, resolved once at Init. */
+	UPROPERTY(BlueprintReadOnly, Category = "State")
+	UAnimInstance* AnimInstance = nullptr;
+
+	/** Seconds spent in the current state, maintained by the machine for shared and unshared states alike. */
+	UPROPERTY(BlueprintReadOnly, Category = "State")
+	float TimeInState = 0.0f;
+};
+
 /**
  * @class UCPP_StateBase
  * @brief State pattern. Represents the base class for all state objects in the state machine.
@@ -18,6 +49,10 @@
  * that occurs upon entering and exiting the state, respectively. Additionally,
  * the `OnTick` method should be overridden to define how the state behaviour
  * during each frame.
+ *
+ * A state can also be shared by many machines (see UCPP_StateMachineDefinition::bShareStates).
+ * Shared states are driven through the const EnterShared, TickShared and ExitShared methods and keep
+ * their per-owner data in FCPP_StateContext. Blueprint events are not dispatched for shared states.
  */
 UCLASS(Blueprintable, BlueprintType)
 class ARENAFIGHTER_API UCPP_StateBase : public UObject
@@ -28,6 +63,11 @@ protected:
 	UPROPERTY(BlueprintReadOnly, Blueprintable)
 	FText StateName;
 
+	// Which Blueprint events the class implements, refreshed at Init
+	bool bImplementsEnterEvent = true;
+	bool bImplementsTickEvent = true;
+	bool bImplementsExitEvent = true;
+
 public:
 	/**
 	 * @brief The context owner for the state instance.
@@ -109,4 +149,17 @@ public:
 
 	UFUNCTION(Blueprintable, BlueprintCallable)
 	virtual void OnExit();
+
+	/** Prepares the state to be shared by several machines. Unlike Init, it has no owner and raises no Blueprint event. */
+	virtual void InitShared();
+
+	virtual void EnterShared(FCPP_StateContext& Context) const;
+
+	virtual void TickShared(FCPP_StateContext& Context, float deltaTime) const;
+
+	virtual void ExitShared(FCPP_StateContext& Context) const;
+
+private:
+	/** Caches the display name and which Blueprint events the class implements. */
+	void CacheClassInfo();
 };
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "CPP_StateBase.h"
+#include "CPP_StateMachineDefinition.h"
 #include "UObject/NoExportTypes.h"
 #include "CPP_StateMachineBase.generated.h"
 
@@ -24,6 +25,14 @@
  * Users are expected to extend this class and override virtual methods to provide custom
  * state transitions and behaviors. The state machine maintains and transitions between
  * different states based on the logic defined in the derived classes.
+ *
+ * When a Definition is assigned, the machine creates its states from the asset at Init and
+ * evaluates the declared transitions natively: triggered transitions through FireTrigger and
+ * automatic ones on every OnTick. Blueprint events that a class does not implement are detected
+ * at Init and never dispatched.
+ *
+ * If the Definition shares its states, the machine only holds pointers to the shared instances and
+ * keeps its per-owner data in StateContext.
  */
 UCLASS(Blueprintable, BlueprintType)
 class ARENAFIGHTER_API UCPP_StateMachineBase : public UObject
@@ -63,7 +72,57 @@ class ARENAFIGHTER_API UCPP_StateMachineBase : public UObject
 	 */
 	UPROPERTY(BlueprintReadOnly, Category = "State")
 	UObject* OwnerContext;
-	
+
+	/**
+	 * @brief Optional data-driven states and transitions.
+	 *
+	 * When set, Init instantiates one state object per declared state, enters the initial state
+	 * and compiles the transitions for FireTrigger and the automatic evaluation in OnTick.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State")
+	UCPP_StateMachineDefinition* Definition;
+
+	/**
+	 * @brief Registers the machine with UCPP_StateMachineManagerSubsystem at Init.
+	 *
+	 * The manager then evaluates the automatic transitions in parallel with other machines and ticks the
+	 * machine itself, so the owner must not call OnTick.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State")
+	bool bTickFromManager = false;
+
+	/** Per-owner data passed to shared states and transition guards. */
+	UPROPERTY(BlueprintReadOnly, Category = "State")
+	FCPP_StateContext StateContext;
+
+	private:
+	/** A transition of Definition with state names resolved to indices into DefinitionStates. */
+	struct FCompiledTransition
+	{
+		int32 From = INDEX_NONE;
+		int32 To = INDEX_NONE;
+		FName Trigger;
+		const UCPP_TransitionGuard* Guard = nullptr;
+	};
+
+	/** State instances of Definition, in the order of Definition->States. Owned by the Definition when shared. */
+	UPROPERTY()
+	TArray<UCPP_StateBase*> DefinitionStates;
+
+	TArray<FCompiledTransition> CompiledTransitions;
+
+	/** Index of CurrentState in DefinitionStates, or INDEX_NONE when it is not a definition state. */
+	int32 CurrentStateIndex = INDEX_NONE;
+
+	bool bHasAutomaticTransitions = false;
+
+	/** Whether DefinitionStates are the shared instances of the Definition. */
+	bool bSharedStates = false;
+
+	// Which Blueprint events the class implements, refreshed at Init
+	bool bImplementsTickEvent = true;
+	bool bImplementsStateChangedEvent = true;
+
 	public:
 	UCPP_StateMachineBase();
 
@@ -122,6 +181,59 @@ class ARENAFIGHTER_API UCPP_StateMachineBase : public UObject
 	UFUNCTION(Blueprintable, BlueprintCallable)
 	virtual void OnTick(float deltaTime);
 
+	/**
+	 * @brief Fires a named trigger of the Definition.
+	 *
+	 * The first transition declared for the trigger whose source matches the current state and whose
+	 * guard passes is taken.
+	 *
+	 * @param Trigger The trigger name used in the definition's transitions.
+	 * @return True when a transition was taken.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "State")
+	bool FireTrigger(FName Trigger);
+
+	/**
+	 * @brief Switches to a state of the Definition by name, ignoring transitions and guards.
+	 *
+	 * @return False when the Definition declares no state with that name.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "State")
+	bool SetStateByName(FName StateName);
+
+	/** Returns the Definition name of the current state, or None when the current state is not a definition state. */
+	UFUNCTION(BlueprintPure, Category = "State")
+	FName GetCurrentStateName() const;
+
+	/**
+	 * @brief Finds the transition that would be taken for a trigger, without taking it.
+	 *
+	 * @param Trigger The trigger to evaluate. None evaluates the automatic transitions.
+	 * @return Index of the target state in the Definition, or INDEX_NONE when no transition applies.
+	 */
+	int32 EvaluateTransitions(FName Trigger) const;
+
+	/**
+	 * @brief Switches to a state of the Definition by index, as returned by EvaluateTransitions.
+	 *
+	 * @param TargetIndex Index into the Definition states. INDEX_NONE does nothing.
+	 */
+	void ApplyTransition(int32 TargetIndex);
+
+	/**
+	 * @brief Ticks the current state and the Blueprint tick event without evaluating automatic transitions.
+	 *
+	 * OnTick is EvaluateTransitions, ApplyTransition and TickActiveState in sequence;
+	 * UCPP_StateMachineManagerSubsystem calls the three stages separately.
+	 */
+	void TickActiveState(float deltaTime);
+
+	bool HasAutomaticTransitions() const { return bHasAutomaticTransitions; }
+
+	UObject* GetOwnerContext() const { return OwnerContext; }
+
+	const FCPP_StateContext& GetStateContext() const { return StateContext; }
+
 	protected:
 	/**
 	 * @brief Sets the current state of the state machine.
@@ -135,4 +247,11 @@ class ARENAFIGHTER_API UCPP_StateMachineBase : public UObject
 	 */
 	UFUNCTION(Blueprintable, BlueprintCallable)
 	void SetState(UPARAM() UCPP_StateBase* NewState);
+
+	private:
+	/** Instantiates or looks up the definition states and resolves the transitions. */
+	void BuildFromDefinition();
+
+	/** Whether CurrentState is driven through the shared state interface. */
+	bool IsCurrentStateShared() const { return bSharedStates && CurrentStateIndex != INDEX_NONE; }
 };
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CPP_StateMachineDefinition.generated.h"
+
+class UCPP_StateBase;
+class UCPP_TransitionGuard;
+
+/** A named state of a UCPP_StateMachineDefinition. */
+USTRUCT(BlueprintType)
+struct FCPP_StateDefinition
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State")
+	FName Name;
+
+	/** Class instantiated for this state when a machine is initialized from the definition. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State")
+	TSubclassOf<UCPP_StateBase> StateClass;
+};
+
+/**
+ * A transition between two states of a UCPP_StateMachineDefinition.
+ *
+ * Transitions with a Trigger are taken when the trigger is fired on the machine.
+ * Transitions without a Trigger are evaluated automatically every OnTick.
+ */
+USTRUCT(BlueprintType)
+struct FCPP_StateTransition
+{
+	GENERATED_BODY()
+
+public:
+	/** State the transition leaves. None means any state. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
+	FName From;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
+	FName To;
+
+	/** Trigger that fires the transition. None makes the transition automatic. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition")
+	FName Trigger;
+
+	/** Optional condition. The transition is always allowed when no guard is set. */
+	UPROPERTY(EditAnywhere, Instanced, BlueprintReadOnly, Category = "Transition")
+	TObjectPtr<UCPP_TransitionGuard> Guard;
+};
+
+/**
+ * @class UCPP_StateMachineDefinition
+ * @brief Data-driven states and guarded transitions of a UCPP_StateMachineBase.
+ *
+ * Transitions are checked in declaration order and the first one whose source state and guard
+ * match is taken, so more specific transitions should be listed before "any state" ones.
+ */
+UCLASS(BlueprintType)
+class ARENAFIGHTER_API UCPP_StateMachineDefinition : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State Machine")
+	TArray<FCPP_StateDefinition> States;
+
+	/** State entered at Init. Defaults to the first state when None. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State Machine")
+	FName InitialState;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State Machine")
+	TArray<FCPP_StateTransition> Transitions;
+
+	/**
+	 * When true, every machine using this definition shares one instance of each state instead of creating its own.
+	 * Shared states run through UCPP_StateBase::EnterShared, TickShared and ExitShared with the machine's
+	 * FCPP_StateContext and do not receive Blueprint events, so they suit native states used by many enemies.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "State Machine")
+	bool bShareStates = false;
+
+private:
+	/** Shared state instances, created on first use and parallel to States. */
+	UPROPERTY(Transient)
+	TArray<UCPP_StateBase*> SharedStates;
+
+public:
+	/** Returns the index of the state with the given name in States, or INDEX_NONE. */
+	int32 FindStateIndex(FName StateName) const;
+
+	/** Returns the shared state instances, creating them the first time. Entries are null for states without a class. */
+	const TArray<UCPP_StateBase*>& GetSharedStates();
+
+#if WITH_EDITOR
+	virtual EDataValidationResult IsDataValid(class FDataValidationContext& Context) const override;
+#endif
+};
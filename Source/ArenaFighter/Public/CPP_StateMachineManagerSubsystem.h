@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_StateMachineManagerSubsystem.generated.h"
+
+class UCPP_StateMachineBase;
+
+/**
+ * @class UCPP_StateMachineManagerSubsystem
+ * @brief Ticks registered state machines with their transition evaluation spread over worker threads.
+ *
+ * Each frame runs three stages:
+ * - Evaluate: the automatic transitions of every machine are evaluated with ParallelFor. This only reads
+ *   game state (see UCPP_TransitionGuard) and stores the chosen target state per machine.
+ * - Apply: on the game thread, the chosen transitions are applied in registration order, so enter and exit
+ *   side effects happen in the same order however many threads evaluated them.
+ * - Tick: the current state of every machine is ticked on the game thread, in the same order.
+ *
+ * Registered machines are ticked by the manager; their owners should stop calling OnTick.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_StateMachineManagerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, transitions are evaluated on the game thread only. Useful to compare results and timings. */
+	UPROPERTY(Config)
+	bool bParallelEvaluation = true;
+
+	/** Below this number of machines the evaluation stays on the game thread, where dispatch would cost more than it saves. */
+	UPROPERTY(Config)
+	int32 MinMachinesForParallel = 64;
+
+	/** Caps the number of tasks the evaluation is split into, and so the worker threads it uses. 0 uses every worker. */
+	UPROPERTY(Config)
+	int32 MaxEvaluationTasks = 0;
+
+private:
+	/** Registered machines in registration order. Entries are cleared while updating and compacted afterwards. */
+	TArray<TWeakObjectPtr<UCPP_StateMachineBase>> Machines;
+
+	// Per-frame buffers of the machines with automatic transitions
+	TArray<UCPP_StateMachineBase*> EvaluatedMachines;
+	TArray<int32> TargetStates;
+
+	int32 TransitionsLastFrame = 0;
+	bool bIsUpdating = false;
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "State")
+	void Register(UCPP_StateMachineBase* Machine);
+
+	UFUNCTION(BlueprintCallable, Category = "State")
+	void Unregister(UCPP_StateMachineBase* Machine);
+
+	int32 Num() const { return Machines.Num(); }
+
+	/** Number of automatic transitions applied in the last frame. */
+	UFUNCTION(BlueprintCallable, Category = "State")
+	int32 GetTransitionsLastFrame() const { return TransitionsLastFrame; }
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Gameplay systems whose game thread time is measured by UCPP_ArenaStressSubsystem. */
+enum class ECPP_StressBucket : uint8
+{
+	Sensing,
+	Selection,
+	Damage,
+	WeaponEquip,
+	StateMachines,
+	/** The stress run's own scripted player and enemies, reported apart from the game systems and not judged. */
+	Script,
+	Num
+};
+
+#if !UE_BUILD_SHIPPING
+
+/**
+ * @class FCPP_StressTimers
+ * @brief Exclusive game thread time per ECPP_StressBucket, accumulated while a stress run is measuring.
+ *
+ * Scopes nest: a scope pauses the scope it interrupts, so time is only counted once, in the innermost bucket.
+ * When no run is measuring, a scope costs a single branch.
+ */
+class ARENAFIGHTER_API FCPP_StressTimers
+{
+public:
+	static void SetEnabled(bool bInEnabled);
+
+	static bool IsEnabled() { return bEnabled; }
+
+	/** Returns the seconds accumulated in a bucket since the last Reset. */
+	static double GetSeconds(ECPP_StressBucket Bucket);
+
+	static void Reset();
+
+private:
+	friend struct FCPP_StressTimerScope;
+
+	static bool bEnabled;
+	static uint64 Cycles[static_cast<int32>(ECPP_StressBucket::Num)];
+
+	/** Innermost open scope and the cycle count its current slice started at. */
+	static ECPP_StressBucket ActiveBucket;
+	static uint64 ActiveStart;
+	static int32 Depth;
+};
+
+/** Measures the game thread time of the enclosing scope into a bucket. Use CPP_PROFILE_SCOPE_BUCKET from ArenaFighter.h. */
+struct ARENAFIGHTER_API FCPP_StressTimerScope
+{
+	explicit FCPP_StressTimerScope(ECPP_StressBucket Bucket);
+	~FCPP_StressTimerScope();
+
+private:
+	ECPP_StressBucket PreviousBucket = ECPP_StressBucket::Num;
+	bool bActive = false;
+};
+
+#endif
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_TargetIndexSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+
+/**
+ * @class UCPP_TargetIndexSubsystem
+ * @brief Uniform-grid spatial hash of every living character in the world.
+ *
+ * Characters register themselves on BeginPlay and unregister on death or EndPlay.
+ * Once per frame the index refreshes the cell of each registered character and only
+ * moves an entry when its owner crossed a cell boundary, so the hash is kept up to date
+ * incrementally from movement.
+ *
+ * Target selection queries the few cells around and in front of a character instead of
+ * scanning every detected pawn.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_TargetIndexSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * CellSize is the edge length of a grid cell in world units.
+	 * It should be in the order of the typical sight radius so a query touches only a handful of cells.
+	 */
+	UPROPERTY(Config)
+	float CellSize = 500.0f;
+
+private:
+	struct FEntry
+	{
+		ACPP_CharacterBase* Character = nullptr;
+		FIntPoint Cell = FIntPoint::ZeroValue;
+	};
+
+	TArray<FEntry> Entries;
+	TMap<ACPP_CharacterBase*, int32> EntryIndices;
+	TMap<FIntPoint, TArray<ACPP_CharacterBase*>> Cells;
+
+public:
+	/** Adds the character to the index. Registering an already indexed character does nothing. */
+	void Register(ACPP_CharacterBase* Character);
+
+	/** Removes the character from the index, e.g. when it dies or leaves play. */
+	void Unregister(ACPP_CharacterBase* Character);
+
+	bool IsRegistered(const ACPP_CharacterBase* Character) const;
+
+	/** Re-hashes a single character immediately instead of waiting for the next frame refresh. */
+	void UpdateCharacter(ACPP_CharacterBase* Character);
+
+	/**
+	 * Collects the indexed characters from cells that overlap a circle of Radius around Origin
+	 * and are not entirely behind the Forward direction.
+	 *
+	 * The result is conservative: callers still have to run their exact distance and angle tests.
+	 *
+	 * @param Origin World location the query is centered on.
+	 * @param Forward Facing direction; cells completely behind it are skipped.
+	 * @param Radius Maximum distance of interest.
+	 * @param Ignore Character excluded from the result, usually the querying character itself.
+	 * @param OutCharacters Receives the candidates. It is not emptied before appending.
+	 */
+	void QueryInFront(const FVector& Origin, const FVector& Forward, float Radius,
+	                  const ACPP_CharacterBase* Ignore, TArray<ACPP_CharacterBase*>& OutCharacters) const;
+
+	/** Same as QueryInFront without skipping the cells behind Origin. */
+	void QueryInRadius(const FVector& Origin, float Radius, const ACPP_CharacterBase* Ignore,
+	                   TArray<ACPP_CharacterBase*>& OutCharacters) const;
+
+	int32 Num() const { return Entries.Num(); }
+
+	/** Heap memory held by the entries, the lookup map and the cell buckets. */
+	SIZE_T GetAllocatedSize() const;
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+	void MoveEntry(FEntry& Entry, const FIntPoint& NewCell);
+};
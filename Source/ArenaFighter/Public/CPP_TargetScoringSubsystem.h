@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_TargetScoringSubsystem.generated.h"
+
+class ACPP_CharacterBase;
+
+/**
+ * @class UCPP_TargetScoringSubsystem
+ * @brief Batched target selection for every character that asked for it during the frame.
+ *
+ * Instead of each character scoring its candidates inside its own TrySelectPawn call, characters
+ * queue a selection request. Once per frame the subsystem gathers the positions and forward vectors
+ * of all requesting characters and their candidates into structure-of-arrays buffers, computes the
+ * distance and facing of every (selector, candidate) pair four at a time with VectorRegister math,
+ * and writes the resulting SelectedPawn back to the actors.
+ *
+ * The selection rule is the same as ACPP_CharacterBase::TrySelectPawn.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_TargetScoringSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, selection requests are resolved immediately on the requesting character. */
+	UPROPERTY(Config)
+	bool bBatchScoring = true;
+
+private:
+	/** Characters that requested a selection this frame, in request order. */
+	TArray<TWeakObjectPtr<ACPP_CharacterBase>> PendingSelectors;
+	TSet<ACPP_CharacterBase*> PendingSelectorSet;
+
+	// Per-selector buffers
+	TArray<ACPP_CharacterBase*> Selectors;
+	TArray<float> SelectorX, SelectorY, SelectorZ;
+	TArray<float> ForwardX, ForwardY, ForwardZ;
+	TArray<int32> CandidateStart, CandidateCount;
+
+	// Per-candidate buffers, one contiguous range per selector
+	TArray<ACPP_CharacterBase*> Candidates;
+	TArray<float> CandidateX, CandidateY, CandidateZ;
+	TArray<float> CandidateDistance, CandidateDot;
+
+	TArray<ACPP_CharacterBase*> GatherScratch;
+
+public:
+	/**
+	 * Queues the character for the batched selection pass of this frame.
+	 * Requesting more than once per frame is cheap; the character is scored only once.
+	 *
+	 * @return False when batching is disabled and the caller should select immediately.
+	 */
+	bool RequestSelection(ACPP_CharacterBase* Selector);
+
+	/** Removes the character's pending request, if any, e.g. when it dies or leaves play. */
+	void CancelSelection(ACPP_CharacterBase* Selector);
+
+	/** Runs the gather, score and write-back stages for all pending requests. */
+	void ResolvePendingSelections();
+
+	// USubsystem / FTickableGameObject
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void GatherBuffers();
+	void ScoreCandidates(int32 SelectorIndex);
+	ACPP_CharacterBase* PickCandidate(int32 SelectorIndex) const;
+	void ResetBuffers();
+};
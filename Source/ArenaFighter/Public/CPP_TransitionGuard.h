@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/NoExportTypes.h"
+#include "CPP_TransitionGuard.generated.h"
+
+class UCPP_StateMachineBase;
+
+/**
+ * @class UCPP_TransitionGuard
+ * @brief Native condition attached to a transition of a UCPP_StateMachineDefinition.
+ *
+ * Guards are created inline in the definition asset and shared by every machine that uses it,
+ * so they must not keep per-machine data. Derive in C++ and override CanTransition.
+ *
+ * UCPP_StateMachineManagerSubsystem evaluates guards on worker threads. CanTransition must only read
+ * game state and must not call Blueprint code or change any object.
+ */
+UCLASS(Abstract, EditInlineNew, DefaultToInstanced, CollapseCategories)
+class ARENAFIGHTER_API UCPP_TransitionGuard : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Decides whether the guarded transition may be taken.
+	 *
+	 * @param Machine The state machine evaluating the transition. Its owner context is available through GetOwnerContext.
+	 * @return True when the transition is allowed.
+	 */
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const;
+};
+
+/**
+ * @class UCPP_TransitionGuard_Not
+ * @brief Inverts another guard.
+ */
+UCLASS(meta = (DisplayName = "Not"))
+class ARENAFIGHTER_API UCPP_TransitionGuard_Not : public UCPP_TransitionGuard
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Instanced, Category = "Guard")
+	TObjectPtr<UCPP_TransitionGuard> Guard;
+
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const override;
+};
+
+/**
+ * @class UCPP_TransitionGuard_All
+ * @brief Passes when every nested guard passes.
+ */
+UCLASS(meta = (DisplayName = "All"))
+class ARENAFIGHTER_API UCPP_TransitionGuard_All : public UCPP_TransitionGuard
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Instanced, Category = "Guard")
+	TArray<TObjectPtr<UCPP_TransitionGuard>> Guards;
+
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const override;
+};
+
+/**
+ * @class UCPP_TransitionGuard_TargetInRange
+ * @brief Passes when the owning character has a selected pawn within Range.
+ */
+UCLASS(meta = (DisplayName = "Target In Range"))
+class ARENAFIGHTER_API UCPP_TransitionGuard_TargetInRange : public UCPP_TransitionGuard
+{
+	GENERATED_BODY()
+
+public:
+	/** Maximum distance to the selected pawn. A negative value uses the enemy's AttackTargetRadius. */
+	UPROPERTY(EditAnywhere, Category = "Guard")
+	float Range = -1.0f;
+
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const override;
+};
+
+/**
+ * @class UCPP_TransitionGuard_TargetLost
+ * @brief Passes when the owning character has no selected pawn and the current state has lasted at least Seconds.
+ *
+ * Meant for leaving a searching state that is entered when the target is lost.
+ */
+UCLASS(meta = (DisplayName = "Target Lost"))
+class ARENAFIGHTER_API UCPP_TransitionGuard_TargetLost : public UCPP_TransitionGuard
+{
+	GENERATED_BODY()
+
+public:
+	/** Minimum time in the current state. A negative value uses the enemy's SecondsToLostTarget. */
+	UPROPERTY(EditAnywhere, Category = "Guard")
+	float Seconds = -1.0f;
+
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const override;
+};
+
+/**
+ * @class UCPP_TransitionGuard_HealthBelow
+ * @brief Passes when the owning character's health is below a fraction of its MaxHealth.
+ */
+UCLASS(meta = (DisplayName = "Health Below"))
+class ARENAFIGHTER_API UCPP_TransitionGuard_HealthBelow : public UCPP_TransitionGuard
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Guard", meta = (ClampMin = "0", ClampMax = "1"))
+	float HealthFraction = 0.3f;
+
+	virtual bool CanTransition(const UCPP_StateMachineBase* Machine) const override;
+};
@@ -41,11 +41,38 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Attributes")
 	float AttackRangeMargin = 20.0f;
 
+private:
+	/** Set on BeginPlay when a Blueprint subclass implements Event Tick, i.e. ticking does useful work. */
+	bool bHasBlueprintTick = false;
 
 public:	
 	// Sets default values for this actor's properties
 	ACPP_Weapon();
 
+	/**
+	 * OnEquipped is a Blueprint event called when the weapon is taken out of the weapon pool for a character.
+	 * Pooled weapons run BeginPlay only once, so per-owner setup belongs here.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Weapon")
+	void OnEquipped();
+
+	/**
+	 * OnUnequipped is a Blueprint event called right before the weapon is hidden and returned to the weapon pool.
+	 */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Weapon")
+	void OnUnequipped();
+
+	float GetAttackRange() const { return AttackRange; }
+
+	float GetAttackRangeMargin() const { return AttackRangeMargin; }
+
+	/** Distance a melee swing of this weapon reaches: AttackRange plus AttackRangeMargin. */
+	float GetAttackReach() const { return AttackRange + AttackRangeMargin; }
+
+	float GetAttackSpeed() const { return AttackSpeed; }
+
+	float GetDamage() const { return Damage; }
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CPP_WeaponPoolSubsystem.generated.h"
+
+class ACPP_Weapon;
+
+/** Free instances of a single weapon class. */
+USTRUCT()
+struct FCPP_WeaponPoolBucket
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY()
+	TArray<TObjectPtr<ACPP_Weapon>> FreeWeapons;
+};
+
+/**
+ * @class UCPP_WeaponPoolSubsystem
+ * @brief Per-world pool of weapon actors shared by all characters.
+ *
+ * Changing weapons used to destroy the equipped actor and spawn the next one, paying actor construction,
+ * component registration and garbage collection on every swap. The pool keeps released weapons hidden,
+ * detached and without collision, and hands them out again on the next equip, so swapping becomes
+ * an attach/show and a detach/hide. New instances are only spawned when a class has no free instance left.
+ */
+UCLASS(Config = Game)
+class ARENAFIGHTER_API UCPP_WeaponPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** When false, Acquire spawns a new weapon and Release destroys it, like before pooling. */
+	UPROPERTY(Config)
+	bool bPoolWeapons = true;
+
+private:
+	UPROPERTY()
+	TMap<TSubclassOf<ACPP_Weapon>, FCPP_WeaponPoolBucket> Buckets;
+
+public:
+	/**
+	 * Makes sure at least one free instance of every given class exists, spawning hidden instances when needed.
+	 * Characters call this on BeginPlay with their Weapons so the first swaps do not spawn either.
+	 * Classes that are not loaded yet are skipped.
+	 */
+	void Prewarm(const TArray<TSoftClassPtr<ACPP_Weapon>>& WeaponClasses);
+
+	/**
+	 * Takes a free weapon of the given class out of the pool, or spawns one when the pool is empty.
+	 * The returned weapon is visible, has collision enabled and is owned by NewOwner, but is not attached.
+	 */
+	ACPP_Weapon* Acquire(TSubclassOf<ACPP_Weapon> WeaponClass, AActor* NewOwner);
+
+	/** Detaches and hides the weapon and puts it back into the pool of its class. */
+	void Release(ACPP_Weapon* Weapon);
+
+	int32 GetNumFree(TSubclassOf<ACPP_Weapon> WeaponClass) const;
+
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	ACPP_Weapon* SpawnWeapon(TSubclassOf<ACPP_Weapon> WeaponClass, AActor* NewOwner) const;
+	static void Deactivate(ACPP_Weapon* Weapon);
+};